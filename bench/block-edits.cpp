@@ -0,0 +1,148 @@
+/*
+ * Throughput benchmark of persisting sustained block edits, like the ones made by `ChunkManager::updateBlock`.
+ *
+ * For a given amount of time, random blocks within a small area of chunks are edited as fast as possible,
+ * after which the time needed to get all of the edits to disk is measured as well. This is done:
+ *  - by saving a snapshot of the edited chunk straight into its region file after every edit, which is the naive
+ *    approach the edit journal is meant to replace,
+ *  - by recording edits in `ChunkStore`'s journal, without syncing,
+ *  - by recording edits in `ChunkStore`'s journal, syncing after every batch.
+ *
+ * Reports the number of edits per second, counting in the time needed to write them, along with the size
+ * of the written data. Everything is written to a temporary directory, which is removed afterwards.
+ *
+ * Usage: voxel-bench-block-edits [seconds per run] [edited area width in chunks]
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/voxel/chunk/chunk.h"
+#include "src/voxel/chunk/chunk-store.h"
+#include "src/voxel/chunk/region-file.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Edit {
+    glm::ivec3 chunkPos;
+    glm::ivec3 block;
+    EBlockType type;
+};
+
+class EditGenerator {
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<int> chunkCoord;
+    std::uniform_int_distribution<int> blockCoord{0, Chunk::CHUNK_SIZE - 1};
+    std::uniform_int_distribution<int> blockType{0, BlockType_NumTypes - 1};
+
+public:
+    explicit EditGenerator(const int areaWidth) : chunkCoord(0, areaWidth - 1) {}
+
+    Edit next() {
+        return {
+            {chunkCoord(rng), chunkCoord(rng), chunkCoord(rng)},
+            {blockCoord(rng), blockCoord(rng), blockCoord(rng)},
+            static_cast<EBlockType>(blockType(rng)),
+        };
+    }
+};
+
+static size_t getDirectorySize(const std::filesystem::path &directory) {
+    size_t size = 0;
+
+    for (const auto &entry: std::filesystem::directory_iterator(directory)) {
+        size += entry.file_size();
+    }
+
+    return size;
+}
+
+static void printResult(const std::string &name, const size_t edits, const double editSeconds,
+                        const double drainSeconds, const size_t bytes) {
+    std::cout << name << ": " << edits << " edits in " << editSeconds << " s, drained in " << drainSeconds
+              << " s, " << static_cast<double>(edits) / (editSeconds + drainSeconds) << " edits/s, "
+              << static_cast<double>(bytes) / 1024.0 << " KB written\n";
+}
+
+static void runSnapshotPerEdit(const std::filesystem::path &directory, const double seconds, const int areaWidth) {
+    EditGenerator generator(areaWidth);
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    Chunk::ChunkID nextID = 0;
+
+    for (int x = 0; x < areaWidth; x++) {
+        for (int y = 0; y < areaWidth; y++) {
+            for (int z = 0; z < areaWidth; z++) {
+                // chunks start out empty, which is all we need here
+                chunks.push_back(std::make_unique<Chunk>(nextID++, glm::ivec3(x, y, z)));
+            }
+        }
+    }
+
+    // all chunks lie in the same region
+    RegionFile region(directory / "region.vxr");
+    std::vector<std::uint8_t> data;
+    size_t edits = 0;
+
+    const Clock::time_point startTime = Clock::now();
+
+    while (std::chrono::duration<double>(Clock::now() - startTime).count() < seconds) {
+        const auto [chunkPos, block, type] = generator.next();
+        Chunk &chunk = *chunks[(chunkPos.x * areaWidth + chunkPos.y) * areaWidth + chunkPos.z];
+
+        chunk.updateBlock(block, type);
+        chunk.serialize(data);
+        region.write({{chunkPos, data}}, 0, true);
+        edits++;
+    }
+
+    const double editSeconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+    printResult("snapshot per edit", edits, editSeconds, 0.0, getDirectorySize(directory));
+}
+
+static void runJournal(const std::filesystem::path &directory, const double seconds, const int areaWidth,
+                       const ESyncPolicy policy) {
+    EditGenerator generator(areaWidth);
+    auto store = std::make_unique<ChunkStore>(directory, policy);
+    size_t edits = 0;
+
+    const Clock::time_point startTime = Clock::now();
+
+    while (std::chrono::duration<double>(Clock::now() - startTime).count() < seconds) {
+        const auto [chunkPos, block, type] = generator.next();
+        store->recordEdit(chunkPos, block, type);
+        edits++;
+    }
+
+    const Clock::time_point editEndTime = Clock::now();
+
+    // destroying the store waits for everything to be written
+    store.reset();
+
+    const double editSeconds = std::chrono::duration<double>(editEndTime - startTime).count();
+    const double drainSeconds = std::chrono::duration<double>(Clock::now() - editEndTime).count();
+    printResult(policy == SyncPolicy_Batch ? "journal, synced batches" : "journal, no syncing",
+                edits, editSeconds, drainSeconds, getDirectorySize(directory));
+}
+
+int main(const int argc, char **argv) {
+    const double seconds = argc > 1 ? std::stod(argv[1]) : 3.0;
+    const int areaWidth = argc > 2 ? std::stoi(argv[2]) : 4;
+
+    const std::filesystem::path baseDirectory = std::filesystem::temp_directory_path() / "voxel-bench-block-edits";
+    std::filesystem::remove_all(baseDirectory);
+
+    const std::filesystem::path snapshotDirectory = baseDirectory / "snapshots";
+    std::filesystem::create_directories(snapshotDirectory);
+    runSnapshotPerEdit(snapshotDirectory, seconds, areaWidth);
+
+    runJournal(baseDirectory / "journal-never", seconds, areaWidth, SyncPolicy_Never);
+    runJournal(baseDirectory / "journal-batch", seconds, areaWidth, SyncPolicy_Batch);
+
+    std::filesystem::remove_all(baseDirectory);
+    return 0;
+}
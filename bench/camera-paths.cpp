@@ -0,0 +1,353 @@
+/*
+ * Benchmark of the whole frame loop, replaying scripted camera paths.
+ *
+ * Each path is replayed at a fixed simulated frame time, so that every run asks for exactly the same frames:
+ *  - fly-over:    flying in a straight line over the terrain,
+ *  - spiral:      circling outwards around the origin, looking along the way,
+ *  - teleport:    jumping to far away places, so that everything around has to be loaded again at once,
+ *  - block-edits: hovering in place, editing bursts of blocks around the camera.
+ *
+ * Before each path, the camera is placed at the path's start and the chunks around it are left to settle,
+ * which isn't measured. Then, the CPU time of every frame is recorded, broken down into `ChunkManager::tick`,
+ * meshing on the worker threads, uploads, draw submission and block edits. With a GPU, the GPU time of each
+ * render pass is recorded as well. The results are written as JSON, so that runs can be compared with each other.
+ *
+ * Frames can be run with one of two backends:
+ *  - null: a `ChunkManager` with a `RecordingRenderBackend`, doing what `VEngine::tick` does but without
+ *          drawing anything. this needs neither a window nor a GPU,
+ *  - gl:   the whole `VEngine::tick`, in a hidden window. the OpenGL context may be a software one, e.g.
+ *          with Mesa's `LIBGL_ALWAYS_SOFTWARE=1`. this has to be run from where the game is, to find its assets.
+ *
+ * Usage: voxel-bench-camera-paths [null|gl] [frames per path] [render distance] [output file]
+ *        the JSON is written to the standard output if no output file is given.
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/engine.h"
+#include "src/render/recording-render-backend.h"
+
+using Clock = std::chrono::steady_clock;
+
+// simulated time between frames, in seconds
+static constexpr float DELTA_TIME = 1.0f / 60.0f;
+
+// upper bound on the number of frames spent waiting for chunks to settle before a path
+static constexpr int MAX_SETTLE_FRAMES = 100000;
+
+static constexpr float PI = 3.14159265f;
+
+struct CameraPose {
+    glm::vec3 pos;
+
+    // yaw and pitch, in radians, like `Camera::setRotation` takes them
+    glm::vec2 rotation;
+};
+
+struct CameraPath {
+    std::string name;
+    std::function<CameraPose(float time)> getPose;
+
+    // number of blocks edited around the camera in the frame at a given time
+    std::function<int(float time)> getEditCount = [](float) { return 0; };
+};
+
+static std::vector<CameraPath> makePaths() {
+    return {
+        {
+            "fly-over", [](const float time) -> CameraPose {
+                constexpr float speed = 20.0f;
+                return {{time * speed, 60, 0}, {PI / 2, -0.3f}};
+            }
+        },
+        {
+            "spiral", [](const float time) -> CameraPose {
+                const float radius = 16.0f + 6.0f * time;
+                const float angle = 0.5f * time;
+
+                // looking along the circle, which is perpendicular to the direction from the origin
+                return {{radius * std::sin(angle), 50, radius * std::cos(angle)}, {angle + PI / 2, -0.2f}};
+            }
+        },
+        {
+            "teleport", [](const float time) -> CameraPose {
+                constexpr float jumpInterval = 2.0f;
+                const float jump = std::floor(time / jumpInterval);
+                return {{jump * 1024, 50, jump * 512}, {0.3f * time, -0.2f}};
+            }
+        },
+        {
+            "block-edits", [](const float time) -> CameraPose {
+                return {{0, 40, 0}, {0.2f * time, -0.5f}};
+            },
+            [](const float time) {
+                // half a second of editing every second
+                return std::fmod(time, 1.0f) < 0.5f ? 20 : 0;
+            }
+        },
+    };
+}
+
+/**
+ * Runs frames the way a given backend does it.
+ */
+class FrameDriver {
+public:
+    virtual ~FrameDriver() = default;
+
+    virtual void setPose(const CameraPose &pose) = 0;
+
+    virtual VEngine::FrameTimings runFrame() = 0;
+
+    [[nodiscard]]
+    virtual ChunkManager& getChunkManager() = 0;
+};
+
+class NullFrameDriver final : public FrameDriver {
+    std::shared_ptr<RecordingRenderBackend> backend = std::make_shared<RecordingRenderBackend>();
+    std::unique_ptr<ChunkManager> chunkManager;
+
+public:
+    explicit NullFrameDriver(const std::filesystem::path &saveDirectory)
+        : chunkManager(std::make_unique<ChunkManager>(backend, std::make_shared<WorldGen>(), saveDirectory)) {}
+
+    void setPose(const CameraPose &pose) override { backend->setCameraPos(pose.pos); }
+
+    VEngine::FrameTimings runFrame() override {
+        const Clock::time_point startTime = Clock::now();
+        chunkManager->tick();
+        const Clock::time_point drawStartTime = Clock::now();
+        chunkManager->renderChunks();
+        const Clock::time_point endTime = Clock::now();
+
+        const ChunkManager::FrameStats &chunkStats = chunkManager->getLastFrameStats();
+        return {
+            .frameMs = std::chrono::duration<float, std::milli>(endTime - startTime).count(),
+            .chunkTickMs = std::chrono::duration<float, std::milli>(drawStartTime - startTime).count(),
+            .meshMs = chunkStats.meshMs,
+            .uploadMs = chunkStats.uploadMs,
+            .drawMs = std::chrono::duration<float, std::milli>(endTime - drawStartTime).count(),
+            .uploads = chunkStats.uploads,
+        };
+    }
+
+    ChunkManager& getChunkManager() override { return *chunkManager; }
+};
+
+class GLFrameDriver final : public FrameDriver {
+    VEngine engine;
+
+public:
+    explicit GLFrameDriver(const std::filesystem::path &saveDirectory) {
+        engine.init({.saveDirectory = saveDirectory, .isWindowHidden = true});
+    }
+
+    void setPose(const CameraPose &pose) override {
+        Camera &camera = engine.getRenderer().getCamera();
+        camera.setPos(pose.pos);
+        camera.setRotation(pose.rotation);
+    }
+
+    VEngine::FrameTimings runFrame() override {
+        engine.tick(DELTA_TIME);
+        return engine.getLastFrameTimings();
+    }
+
+    ChunkManager& getChunkManager() override { return engine.getChunkManager(); }
+};
+
+/**
+ * Per-frame times of a single path, in milliseconds.
+ */
+struct PathResult {
+    std::string name;
+    std::vector<float> frameMs, chunkTickMs, meshMs, uploadMs, drawMs, editMs;
+    std::array<std::vector<float>, RenderPass_NumPasses> gpuPassMs;
+    size_t uploads = 0;
+    size_t edits = 0;
+    int settleFrames = 0;
+};
+
+static PathResult runPath(FrameDriver &driver, const CameraPath &path, const int frames) {
+    PathResult result;
+    result.name = path.name;
+
+    driver.setPose(path.getPose(0));
+    while (!driver.getChunkManager().isSettled() && result.settleFrames < MAX_SETTLE_FRAMES) {
+        driver.runFrame();
+        result.settleFrames++;
+    }
+
+    // edits are spread around the camera, but always the same ones in each run
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> offset(-24, 24);
+    std::uniform_int_distribution<int> blockType(0, 1);
+
+    for (int frame = 0; frame < frames; frame++) {
+        const float time = static_cast<float>(frame) * DELTA_TIME;
+        const CameraPose pose = path.getPose(time);
+        driver.setPose(pose);
+
+        // edits are made between frames, like the ones made by the player's input handled in `VEngine::tick`
+        const int editCount = path.getEditCount(time);
+        const Clock::time_point editStartTime = Clock::now();
+
+        for (int i = 0; i < editCount; i++) {
+            const glm::ivec3 block = glm::ivec3(pose.pos) + glm::ivec3(offset(rng), offset(rng), offset(rng));
+            driver.getChunkManager().updateBlock(block, blockType(rng) ? BlockType_Stone : BlockType_None);
+        }
+
+        result.editMs.push_back(std::chrono::duration<float, std::milli>(Clock::now() - editStartTime).count());
+        result.edits += editCount;
+
+        const VEngine::FrameTimings timings = driver.runFrame();
+        result.frameMs.push_back(timings.frameMs);
+        result.chunkTickMs.push_back(timings.chunkTickMs);
+        result.meshMs.push_back(timings.meshMs);
+        result.uploadMs.push_back(timings.uploadMs);
+        result.drawMs.push_back(timings.drawMs);
+        result.uploads += timings.uploads;
+
+        for (int pass = 0; pass < RenderPass_NumPasses; pass++) {
+            result.gpuPassMs[pass].push_back(timings.gpuPassMs[pass]);
+        }
+    }
+
+    return result;
+}
+
+static void writeSummary(std::ostream &out, const std::vector<float> &values) {
+    std::vector<float> sorted = values;
+    std::ranges::sort(sorted);
+
+    double sum = 0.0;
+    for (const float value: values) sum += value;
+
+    const auto percentile = [&](const double p) {
+        return sorted.empty() ? 0.f : sorted[static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size() - 1))];
+    };
+
+    out << "{\"avg\": " << (values.empty() ? 0.0 : sum / static_cast<double>(values.size()))
+        << ", \"p50\": " << percentile(50) << ", \"p99\": " << percentile(99)
+        << ", \"max\": " << (sorted.empty() ? 0.f : sorted.back()) << "}";
+}
+
+static void writeArray(std::ostream &out, const std::vector<float> &values) {
+    out << "[";
+    for (size_t i = 0; i < values.size(); i++) {
+        out << (i ? ", " : "") << values[i];
+    }
+    out << "]";
+}
+
+/**
+ * @return Named series of per-frame times of a path. GPU times are only included if there was a GPU.
+ */
+static std::vector<std::pair<std::string, const std::vector<float>*>> getSeries(const PathResult &result,
+                                                                                const bool hasGpu) {
+    std::vector<std::pair<std::string, const std::vector<float>*>> series = {
+        {"frameMs", &result.frameMs},
+        {"chunkTickMs", &result.chunkTickMs},
+        {"meshMs", &result.meshMs},
+        {"uploadMs", &result.uploadMs},
+        {"drawMs", &result.drawMs},
+        {"editMs", &result.editMs},
+    };
+
+    if (hasGpu) {
+        // GPU times arrive a few frames late, so they're attributed to the frames in which they became known
+        for (int pass = 0; pass < RenderPass_NumPasses; pass++) {
+            const std::string passName = getRenderPassName(static_cast<ERenderPass>(pass));
+            series.emplace_back("gpu." + passName + "Ms", &result.gpuPassMs[pass]);
+        }
+    }
+
+    return series;
+}
+
+static void writeJson(std::ostream &out, const std::string &backend, const int renderDistance,
+                      const std::vector<PathResult> &results) {
+    out << "{\n  \"backend\": \"" << backend << "\",\n  \"renderDistance\": " << renderDistance
+        << ",\n  \"deltaTime\": " << DELTA_TIME << ",\n  \"paths\": [";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const PathResult &result = results[i];
+        const auto series = getSeries(result, backend == "gl");
+
+        out << (i ? "," : "") << "\n    {\n      \"name\": \"" << result.name << "\",\n      \"frames\": "
+            << result.frameMs.size() << ",\n      \"settleFrames\": " << result.settleFrames
+            << ",\n      \"uploads\": " << result.uploads << ",\n      \"edits\": " << result.edits
+            << ",\n      \"summary\": {";
+
+        for (size_t j = 0; j < series.size(); j++) {
+            out << (j ? "," : "") << "\n        \"" << series[j].first << "\": ";
+            writeSummary(out, *series[j].second);
+        }
+
+        out << "\n      },\n      \"perFrame\": {";
+
+        for (size_t j = 0; j < series.size(); j++) {
+            out << (j ? "," : "") << "\n        \"" << series[j].first << "\": ";
+            writeArray(out, *series[j].second);
+        }
+
+        out << "\n      }\n    }";
+    }
+
+    out << "\n  ]\n}\n";
+}
+
+int main(const int argc, char **argv) {
+    const std::string backend = argc > 1 ? argv[1] : "null";
+    const int frames = argc > 2 ? std::stoi(argv[2]) : 600;
+    const int renderDistance = argc > 3 ? std::stoi(argv[3]) : 8;
+    const std::string outputPath = argc > 4 ? argv[4] : "";
+
+    if (backend != "null" && backend != "gl") {
+        std::cerr << "unknown backend: " << backend << ", expected null or gl\n";
+        return 1;
+    }
+
+    const std::filesystem::path saveDirectory = std::filesystem::temp_directory_path() / "voxel-bench-camera-paths";
+    std::filesystem::remove_all(saveDirectory);
+
+    std::vector<PathResult> results;
+
+    {
+        std::unique_ptr<FrameDriver> driver;
+        if (backend == "gl") {
+            driver = std::make_unique<GLFrameDriver>(saveDirectory);
+        } else {
+            driver = std::make_unique<NullFrameDriver>(saveDirectory);
+        }
+
+        driver->getChunkManager().setRenderDistance(renderDistance);
+
+        for (const CameraPath &path: makePaths()) {
+            std::cerr << "running " << path.name << "...\n";
+            results.push_back(runPath(*driver, path, frames));
+        }
+    }
+
+    std::filesystem::remove_all(saveDirectory);
+
+    if (outputPath.empty()) {
+        writeJson(std::cout, backend, renderDistance, results);
+    } else {
+        std::ofstream file(outputPath);
+        writeJson(file, backend, renderDistance, results);
+    }
+
+    return 0;
+}
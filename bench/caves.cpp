@@ -0,0 +1,98 @@
+/*
+ * Benchmark of chunk generation with caves enabled versus the height map alone.
+ *
+ * The same cube of chunks around the origin, reaching from deep below the caves up into the sky,
+ * is generated twice by fresh `WorldGen`s: once without caves and once with them. Each run reports
+ * the average generation time per chunk, how the chunks were classified before generating them,
+ * and how many of them turned out to consist of a single block type. The run with caves also reports
+ * how many chunks needed their cave density evaluated, and at how many lattice points on average,
+ * out of all points of a full lattice.
+ *
+ * Usage: voxel-bench-caves [radius in chunks] [rounds]
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "src/voxel/chunk/chunk.h"
+#include "src/voxel/world-gen.h"
+
+using Clock = std::chrono::steady_clock;
+
+// vertical range of generated chunks, spanning well below the bottom of the caves
+static constexpr int MIN_CHUNK_Y = WorldGen::CAVE_MIN_Y / Chunk::CHUNK_SIZE - 3;
+static constexpr int MAX_CHUNK_Y = 6;
+
+static void runBenchmark(const std::vector<glm::ivec3> &positions, const int rounds, const bool caves) {
+    double totalMs = 0;
+    size_t contentCounts[3] = {};
+    size_t uniformCount = 0;
+    WorldGen::CaveStats caveStats;
+
+    for (int round = 0; round < rounds; round++) {
+        // a fresh generator each round, so that height maps aren't reused between rounds
+        WorldGen worldGen(0, caves);
+        Chunk::ChunkID nextID = 0;
+        uniformCount = 0;
+
+        for (const auto &pos: positions) {
+            Chunk chunk(nextID++, pos);
+
+            const Clock::time_point startTime = Clock::now();
+            chunk.generate(worldGen);
+            totalMs += std::chrono::duration<double, std::milli>(Clock::now() - startTime).count();
+
+            uniformCount += chunk.isUniform();
+        }
+
+        if (round == 0) {
+            for (const auto &pos: positions) {
+                contentCounts[worldGen.classifyChunk(pos)]++;
+            }
+        }
+
+        caveStats = worldGen.getCaveStats();
+    }
+
+    std::cout << (caves ? "with caves" : "height map only") << ": "
+              << totalMs / static_cast<double>(rounds * positions.size()) << " ms/chunk, "
+              << uniformCount << " uniform chunks\n";
+    std::cout << "    empty chunks: " << contentCounts[ChunkContents_Empty]
+              << ", solid chunks: " << contentCounts[ChunkContents_Solid]
+              << ", mixed chunks: " << contentCounts[ChunkContents_Mixed] << "\n";
+
+    if (caves) {
+        constexpr int latticeSize = Chunk::CHUNK_SIZE / WorldGen::CAVE_LATTICE_STEP + 1;
+        const double pointsPerChunk = caveStats.chunks
+                                          ? static_cast<double>(caveStats.latticePoints)
+                                            / static_cast<double>(caveStats.chunks)
+                                          : 0.0;
+
+        std::cout << "    chunks with caves evaluated: " << caveStats.chunks << ", lattice points per chunk: "
+                  << pointsPerChunk << " of " << latticeSize * latticeSize * latticeSize << "\n";
+    }
+}
+
+int main(const int argc, char **argv) {
+    const int radius = argc > 1 ? std::stoi(argv[1]) : 6;
+    const int rounds = argc > 2 ? std::stoi(argv[2]) : 3;
+
+    std::vector<glm::ivec3> positions;
+
+    for (int x = -radius; x <= radius; x++) {
+        for (int y = MIN_CHUNK_Y; y <= MAX_CHUNK_Y; y++) {
+            for (int z = -radius; z <= radius; z++) {
+                positions.emplace_back(x, y, z);
+            }
+        }
+    }
+
+    std::cout << "corpus: " << positions.size() << " chunks, " << rounds << " rounds\n";
+
+    runBenchmark(positions, rounds, false);
+    runBenchmark(positions, rounds, true);
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * Benchmark of chunk lookups by position, as done by `ChunkManager::getOwningChunk` for every block under
+ * the crosshair and on every block update.
+ *
+ * A window of chunk slots is laid out the same way `ChunkManager` does it for a given render distance,
+ * after which random chunk positions in and around the window are looked up by:
+ *  - a linear scan over all slots, which is what `getOwningChunk` used to do,
+ *  - a `ToroidalGrid` indexed by chunk positions, which is what it does now.
+ *
+ * Reports the average time per lookup at render distances 8, 16 and 24, or the ones given on the command line.
+ *
+ * Usage: voxel-bench-chunk-lookup [render distance...]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/voxel/chunk/chunk.h"
+#include "src/utils/toroidal-grid.h"
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int GRACE_PERIOD_WIDTH = 1;
+
+struct Slot {
+    std::shared_ptr<Chunk> chunk;
+};
+
+using SlotPtr = std::shared_ptr<Slot>;
+
+static const Chunk *findLinear(const std::vector<SlotPtr> &slots, const glm::ivec3 &pos) {
+    const auto it = std::ranges::find_if(slots, [&](const SlotPtr &slot) {
+        return slot->chunk && slot->chunk->getPos() == pos;
+    });
+
+    return it == slots.end() ? nullptr : (*it)->chunk.get();
+}
+
+static const Chunk *findInGrid(const ToroidalGrid<SlotPtr> &grid, const glm::ivec3 &pos) {
+    const Slot *slot = grid[pos].get();
+    return slot && slot->chunk && slot->chunk->getPos() == pos ? slot->chunk.get() : nullptr;
+}
+
+template<typename F>
+static double timeLookups(const std::vector<glm::ivec3> &positions, size_t &found, F &&find) {
+    found = 0;
+    const Clock::time_point startTime = Clock::now();
+
+    for (const auto &pos: positions) {
+        found += find(pos) != nullptr;
+    }
+
+    const double totalNs = std::chrono::duration<double, std::nano>(Clock::now() - startTime).count();
+    return totalNs / static_cast<double>(positions.size());
+}
+
+static std::vector<glm::ivec3> makeLookups(const int renderDistance, const size_t count, std::mt19937 &rng) {
+    // also look a bit outside of the window, just like lookups of blocks far away from the camera do
+    std::uniform_int_distribution coord(-renderDistance - 2, renderDistance + 2);
+    std::vector<glm::ivec3> positions(count);
+
+    for (auto &pos: positions) {
+        pos = {coord(rng), coord(rng), coord(rng)};
+    }
+
+    return positions;
+}
+
+/**
+ * @return Whether both lookups agreed on all positions.
+ */
+static bool runBenchmark(const int renderDistance) {
+    const int slotsWidth = 2 * renderDistance + GRACE_PERIOD_WIDTH + 1;
+    std::vector<SlotPtr> slots;
+
+    for (int i = 0; i < slotsWidth * slotsWidth * slotsWidth; i++) {
+        slots.push_back(std::make_shared<Slot>());
+    }
+
+    ToroidalGrid<SlotPtr> grid(2 * (renderDistance + GRACE_PERIOD_WIDTH) + 1);
+    Chunk::ChunkID nextID = 0;
+    auto slotIt = slots.begin();
+
+    for (int x = -renderDistance; x <= renderDistance; x++) {
+        for (int y = -renderDistance; y <= renderDistance; y++) {
+            for (int z = -renderDistance; z <= renderDistance; z++) {
+                const glm::ivec3 pos = {x, y, z};
+                (*slotIt)->chunk = std::make_shared<Chunk>(nextID++, pos);
+                grid[pos] = *slotIt;
+                slotIt++;
+            }
+        }
+    }
+
+    // free slots are spread around the real slot list, so shuffle them to not favor the linear scan
+    std::mt19937 rng(renderDistance);
+    std::ranges::shuffle(slots, rng);
+
+    // the linear scan is slow enough that it gets much fewer lookups
+    const std::vector<glm::ivec3> linearLookups = makeLookups(renderDistance, 2'000, rng);
+    const std::vector<glm::ivec3> gridLookups = makeLookups(renderDistance, 2'000'000, rng);
+
+    size_t linearFound, gridFound, gridFoundSameLookups;
+    const double linearNs = timeLookups(linearLookups, linearFound, [&](const glm::ivec3 &pos) {
+        return findLinear(slots, pos);
+    });
+    const double gridNs = timeLookups(gridLookups, gridFound, [&](const glm::ivec3 &pos) {
+        return findInGrid(grid, pos);
+    });
+    timeLookups(linearLookups, gridFoundSameLookups, [&](const glm::ivec3 &pos) {
+        return findInGrid(grid, pos);
+    });
+
+    std::cout << "render distance " << renderDistance << " (" << slots.size() << " slots, grid width "
+              << grid.getWidth() << "): linear " << linearNs << " ns/lookup, grid " << gridNs
+              << " ns/lookup, speedup " << linearNs / gridNs << "x, "
+              << 100.0 * static_cast<double>(gridFound) / static_cast<double>(gridLookups.size()) << "% found\n";
+
+    return linearFound == gridFoundSameLookups;
+}
+
+int main(const int argc, char **argv) {
+    std::vector<int> renderDistances = {8, 16, 24};
+
+    if (argc > 1) {
+        renderDistances.clear();
+
+        for (int i = 1; i < argc; i++) {
+            renderDistances.push_back(std::stoi(argv[i]));
+        }
+    }
+
+    for (const int renderDistance: renderDistances) {
+        if (!runBenchmark(renderDistance)) {
+            std::cout << "lookups disagree on which chunks are loaded\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,246 @@
+/*
+ * Microbenchmark of `ChunkMeshContext::makeIndexed` over a corpus of generated chunks.
+ *
+ * Merged quads of every chunk are extracted once up front, after which three indexing strategies are timed:
+ *  - the legacy indexer, deduplicating triangle vertices through a `std::map` (kept here as the baseline),
+ *  - `makeIndexed` fed with the same triangles, going through its open-addressing hash table,
+ *  - `makeIndexed` fed with the quads themselves, emitting them directly with a shared index pattern.
+ *
+ * Reports the average time and the number of heap allocations per chunk, along with the output sizes.
+ *
+ * Usage: voxel-bench-indexing [corpus radius in chunks] [rounds]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "src/voxel/chunk/chunk.h"
+#include "src/voxel/world-gen.h"
+#include "src/render/mesh-context.h"
+
+static std::atomic<size_t> allocationCount = 0;
+
+void *operator new(const size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+using Clock = std::chrono::steady_clock;
+using Quad = std::pair<Vertex, Vertex>;
+using Triangle = std::tuple<Vertex, Vertex, Vertex>;
+
+struct ChunkGeometry {
+    glm::ivec3 origin;
+    std::vector<Quad> quads;
+    std::vector<Triangle> triangles;
+};
+
+struct IndexingResult {
+    double msPerChunk = 0;
+    double allocationsPerChunk = 0;
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+};
+
+static Vertex unpackVertex(const IndexedMeshData &data, const size_t index) {
+    const glm::uint32 packed = data.vertices[index].y;
+
+    return {
+        .position = data.origin + IndexedMeshData::unpackPosition(data.vertices[index].x),
+        .uv = {static_cast<int>((packed >> 24) & 0x1F), static_cast<int>((packed >> 19) & 0x1F)},
+        .normal = getNormalFromFace(blockFaces[packed >> 29]),
+        .texSamplerID = static_cast<int>(packed & 0xFF),
+    };
+}
+
+/**
+ * Recovers the merged quads and their triangles from a mesh made by the bitmask mesher,
+ * which writes every quad as 4 consecutive vertices in the order `[min, _, max, _]`.
+ */
+static ChunkGeometry extractGeometry(const IndexedMeshData &data) {
+    ChunkGeometry geometry;
+    geometry.origin = data.origin;
+
+    for (size_t i = 0; i < data.indices.size(); i += 6) {
+        const size_t base = data.indices[i];
+        geometry.quads.emplace_back(unpackVertex(data, base), unpackVertex(data, base + 2));
+
+        for (size_t j = 0; j < 6; j += 3) {
+            geometry.triangles.emplace_back(
+                unpackVertex(data, data.indices[i + j]),
+                unpackVertex(data, data.indices[i + j + 1]),
+                unpackVertex(data, data.indices[i + j + 2])
+            );
+        }
+    }
+
+    return geometry;
+}
+
+struct LegacyVertexLess {
+    bool operator()(const Vertex &a, const Vertex &b) const {
+        return memcmp(&a, &b, sizeof(Vertex)) > 0;
+    }
+};
+
+/**
+ * The indexer `makeIndexed` used before, building a fresh tree of vertices for every mesh.
+ */
+static void legacyMakeIndexed(const ChunkGeometry &geometry, IndexedMeshData &data) {
+    data.clear();
+    data.origin = geometry.origin;
+    std::map<Vertex, GLElementBuffer::ElemType, LegacyVertexLess> vertexToOutIndex;
+
+    const auto indexVertex = [&](const Vertex &vertex) {
+        const auto it = vertexToOutIndex.find(vertex);
+
+        if (it != vertexToOutIndex.end()) {
+            data.indices.push_back(it->second);
+            return;
+        }
+
+        data.vertices.emplace_back(
+            IndexedMeshData::packPosition(vertex.position - data.origin),
+            IndexedMeshData::packNormalUvTex(getFaceFromNormal(vertex.normal), vertex.uv, vertex.texSamplerID)
+        );
+
+        const auto newIndex = static_cast<GLElementBuffer::ElemType>(data.vertices.size() - 1);
+        data.indices.push_back(newIndex);
+        vertexToOutIndex.emplace(vertex, newIndex);
+    };
+
+    for (const auto &[v1, v2, v3]: geometry.triangles) {
+        indexVertex(v1);
+        indexVertex(v2);
+        indexVertex(v3);
+    }
+}
+
+template<typename F>
+static IndexingResult runIndexer(const std::vector<ChunkGeometry> &corpus, const int rounds, F &&index) {
+    IndexingResult result;
+
+    const size_t startAllocations = allocationCount.load();
+    const Clock::time_point startTime = Clock::now();
+
+    for (int round = 0; round < rounds; round++) {
+        result.vertexCount = 0;
+        result.indexCount = 0;
+
+        for (const auto &geometry: corpus) {
+            const IndexedMeshData &data = index(geometry);
+            result.vertexCount += data.vertices.size();
+            result.indexCount += data.indices.size();
+        }
+    }
+
+    const double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - startTime).count();
+    const auto chunkCount = static_cast<double>(rounds * corpus.size());
+
+    result.msPerChunk = totalMs / chunkCount;
+    result.allocationsPerChunk = static_cast<double>(allocationCount.load() - startAllocations) / chunkCount;
+    return result;
+}
+
+static void printResult(const std::string &name, const IndexingResult &result) {
+    std::cout << name << result.msPerChunk << " ms/chunk, " << result.allocationsPerChunk << " allocs/chunk, "
+              << result.vertexCount << " vertices, " << result.indexCount << " indices\n";
+}
+
+int main(const int argc, char **argv) {
+    const int radius = argc > 1 ? std::stoi(argv[1]) : 4;
+    const int rounds = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    BlockSamplerTable samplers{};
+    for (int type = 0; type < BlockType_NumTypes; type++) {
+        samplers[type].fill(type);
+    }
+
+    WorldGen worldGen;
+    ChunkMeshContext meshContext;
+    std::vector<ChunkGeometry> corpus;
+    Chunk::ChunkID nextID = 0;
+
+    for (int x = -radius; x <= radius; x++) {
+        for (int y = -3; y <= 3; y++) {
+            for (int z = -radius; z <= radius; z++) {
+                Chunk chunk(nextID++, glm::ivec3(x, y, z));
+                chunk.generate(worldGen);
+                chunk.createMesh(meshContext, samplers);
+
+                ChunkGeometry geometry = extractGeometry(meshContext.getIndexedData());
+                if (!geometry.quads.empty()) {
+                    corpus.push_back(std::move(geometry));
+                }
+
+                meshContext.clear();
+            }
+        }
+    }
+
+    std::cout << "corpus: " << corpus.size() << " non-empty chunks, " << rounds << " rounds\n";
+
+    IndexedMeshData legacyData;
+    const IndexingResult legacy = runIndexer(corpus, rounds, [&](const ChunkGeometry &geometry) -> auto& {
+        legacyMakeIndexed(geometry, legacyData);
+        return legacyData;
+    });
+
+    const IndexingResult hashed = runIndexer(corpus, rounds, [&](const ChunkGeometry &geometry) -> auto& {
+        meshContext.clear();
+        meshContext.modelTranslate = geometry.origin;
+        for (const auto &[v1, v2, v3]: geometry.triangles) {
+            meshContext.addTriangle(v1, v2, v3);
+        }
+        meshContext.makeIndexed();
+        return meshContext.getIndexedData();
+    });
+
+    const IndexingResult direct = runIndexer(corpus, rounds, [&](const ChunkGeometry &geometry) -> auto& {
+        meshContext.clear();
+        meshContext.modelTranslate = geometry.origin;
+        for (const auto &[min, max]: geometry.quads) {
+            meshContext.addQuad(min, max);
+        }
+        meshContext.makeIndexed();
+        return meshContext.getIndexedData();
+    });
+
+    printResult("legacy std::map:      ", legacy);
+    printResult("hashed triangles:     ", hashed);
+    printResult("direct quads:         ", direct);
+    std::cout << "speedup (hashed): " << legacy.msPerChunk / hashed.msPerChunk << "x\n";
+    std::cout << "speedup (direct): " << legacy.msPerChunk / direct.msPerChunk << "x\n";
+
+    // both deduplicating indexers must agree exactly, while direct emission may only forgo the rare vertex
+    // which happens to be shared by two merged quads
+    if (hashed.vertexCount != legacy.vertexCount || direct.vertexCount < legacy.vertexCount
+        || hashed.indexCount != legacy.indexCount || direct.indexCount != legacy.indexCount) {
+        std::cout << "indexers disagree on the size of the indexed mesh\n";
+        return 1;
+    }
+
+    return 0;
+}
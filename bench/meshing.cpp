@@ -0,0 +1,97 @@
+/*
+ * Benchmark comparing the bitmask mesher (`Chunk::createMesh`) against the reference per-face mesher
+ * (`Chunk::createReferenceMesh`) over a corpus of generated chunks.
+ *
+ * Reports the average meshing time per chunk and the total number of output triangles of both meshers.
+ *
+ * Usage: voxel-bench-meshing [corpus radius in chunks] [rounds]
+ */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/voxel/chunk/chunk.h"
+#include "src/voxel/world-gen.h"
+#include "src/render/mesh-context.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct MesherResult {
+    double msPerChunk = 0;
+    size_t triangleCount = 0;
+};
+
+template<typename F>
+static MesherResult runMesher(const std::vector<std::unique_ptr<Chunk>> &corpus, const int rounds, F &&meshChunk) {
+    ChunkMeshContext meshContext;
+    MesherResult result;
+
+    const Clock::time_point startTime = Clock::now();
+
+    for (int round = 0; round < rounds; round++) {
+        result.triangleCount = 0;
+
+        for (const auto &chunk: corpus) {
+            chunk->markDirty();
+            meshChunk(*chunk, meshContext);
+            result.triangleCount += meshContext.getIndexedData().indices.size() / 3;
+            meshContext.clear();
+        }
+    }
+
+    const double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - startTime).count();
+    result.msPerChunk = totalMs / static_cast<double>(rounds * corpus.size());
+    return result;
+}
+
+int main(const int argc, char **argv) {
+    const int radius = argc > 1 ? std::stoi(argv[1]) : 4;
+    const int rounds = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    // the block samplers don't matter for performance, as long as different block types use different textures
+    BlockSamplerTable samplers{};
+    for (int type = 0; type < BlockType_NumTypes; type++) {
+        samplers[type].fill(type);
+    }
+
+    WorldGen worldGen;
+    std::vector<std::unique_ptr<Chunk>> corpus;
+    Chunk::ChunkID nextID = 0;
+
+    for (int x = -radius; x <= radius; x++) {
+        for (int y = -3; y <= 3; y++) {
+            for (int z = -radius; z <= radius; z++) {
+                auto chunk = std::make_unique<Chunk>(nextID++, glm::ivec3(x, y, z));
+                chunk->generate(worldGen);
+                corpus.push_back(std::move(chunk));
+            }
+        }
+    }
+
+    std::cout << "corpus: " << corpus.size() << " chunks, " << rounds << " rounds\n";
+
+    const MesherResult reference = runMesher(corpus, rounds, [&](Chunk &chunk, ChunkMeshContext &meshContext) {
+        chunk.createReferenceMesh(meshContext, samplers);
+    });
+
+    const MesherResult binary = runMesher(corpus, rounds, [&](Chunk &chunk, ChunkMeshContext &meshContext) {
+        chunk.createMesh(meshContext, samplers);
+    });
+
+    std::cout << "reference mesher: " << reference.msPerChunk << " ms/chunk, "
+              << reference.triangleCount << " triangles\n";
+    std::cout << "binary mesher:    " << binary.msPerChunk << " ms/chunk, "
+              << binary.triangleCount << " triangles\n";
+    std::cout << "speedup: " << reference.msPerChunk / binary.msPerChunk << "x\n";
+
+    // both meshers cover exactly the same faces, so the greedy merging should never do worse by a wide margin
+    if (binary.triangleCount > reference.triangleCount * 11 / 10) {
+        std::cout << "binary mesher produced noticeably more triangles than the reference mesher\n";
+        return 1;
+    }
+
+    return 0;
+}
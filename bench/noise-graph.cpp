@@ -0,0 +1,243 @@
+/*
+ * Throughput benchmark and accuracy check of noise graphs composed at compile time.
+ *
+ * The same terrain-like expression, using every kind of node, is built twice:
+ *  - out of libnoise's modules, connected through `SetSourceModule`,
+ *  - out of `NoiseGraph` nodes, fused into a single type.
+ *
+ * Both are evaluated at the same random points, reporting the number of points evaluated per second.
+ * Afterwards, every kind of node is also compared with its libnoise counterpart on its own.
+ *
+ * Exits with a non-zero status if any result differs from libnoise's by more than a small tolerance.
+ *
+ * Usage: voxel-bench-noise-graph [point count] [repetitions]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "libnoise/noise.h"
+#include "src/voxel/noise-graph.h"
+
+using Clock = std::chrono::steady_clock;
+
+// results are expected to be identical, this only leaves room for a compiler contracting operations differently
+static constexpr double TOLERANCE = 1e-9;
+
+struct Points {
+    std::vector<double> xs, ys, zs;
+};
+
+static Points makePoints(const size_t count, const double range) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> coord(-range, range);
+    Points points;
+
+    for (size_t i = 0; i < count; i++) {
+        points.xs.push_back(coord(rng));
+        points.ys.push_back(coord(rng));
+        points.zs.push_back(coord(rng));
+    }
+
+    return points;
+}
+
+static void printResult(const std::string &name, const size_t points, const double seconds) {
+    std::cout << name << ": " << static_cast<double>(points) / seconds / 1e6 << " M points/s\n";
+}
+
+/**
+ * libnoise counterpart of `makeGraph`. Modules only refer to their sources, so all of them are kept here.
+ */
+struct ModuleGraph {
+    noise::module::Perlin control;
+    noise::module::Billow hills;
+    noise::module::ScaleBias flatHills;
+    noise::module::RidgedMulti ridges;
+    noise::module::Turbulence turbulentRidges;
+    noise::module::ScalePoint stretchedRidges;
+    noise::module::Const floor;
+    noise::module::Max flooredRidges;
+    noise::module::Select terrain;
+    noise::module::Perlin detail;
+    noise::module::Multiply scaledDetail;
+    noise::module::Min cappedDetail;
+    noise::module::Add detailedTerrain;
+    noise::module::Clamp root;
+
+    ModuleGraph() {
+        control.SetFrequency(0.2);
+        control.SetOctaveCount(3);
+        control.SetSeed(1);
+
+        hills.SetFrequency(2.0);
+        hills.SetSeed(2);
+        flatHills.SetSourceModule(0, hills);
+        flatHills.SetScale(0.25);
+        flatHills.SetBias(-0.5);
+
+        ridges.SetOctaveCount(5);
+        ridges.SetSeed(3);
+        turbulentRidges.SetSourceModule(0, ridges);
+        turbulentRidges.SetFrequency(2.0);
+        turbulentRidges.SetPower(0.1);
+        turbulentRidges.SetRoughness(2);
+        turbulentRidges.SetSeed(4);
+        stretchedRidges.SetSourceModule(0, turbulentRidges);
+        stretchedRidges.SetScale(1.5, 1.0, 1.5);
+        floor.SetConstValue(-0.25);
+        flooredRidges.SetSourceModule(0, stretchedRidges);
+        flooredRidges.SetSourceModule(1, floor);
+
+        terrain.SetSourceModule(0, flatHills);
+        terrain.SetSourceModule(1, flooredRidges);
+        terrain.SetControlModule(control);
+        terrain.SetBounds(0.0, 1000.0);
+        terrain.SetEdgeFalloff(0.25);
+
+        detail.SetFrequency(8.0);
+        detail.SetOctaveCount(2);
+        detail.SetSeed(5);
+        scaledDetail.SetSourceModule(0, detail);
+        scaledDetail.SetSourceModule(1, control);
+        cappedDetail.SetSourceModule(0, scaledDetail);
+        cappedDetail.SetSourceModule(1, floor);
+
+        detailedTerrain.SetSourceModule(0, terrain);
+        detailedTerrain.SetSourceModule(1, cappedDetail);
+        root.SetSourceModule(0, detailedTerrain);
+        root.SetBounds(-1.0, 1.5);
+    }
+};
+
+static auto makeGraph() {
+    using namespace NoiseGraph;
+
+    const Perlin control{.frequency = 0.2, .octaveCount = 3, .seed = 1};
+    const Constant floor{-0.25};
+
+    const auto flatHills = scaleBias(Billow{.frequency = 2.0, .seed = 2}, 0.25, -0.5);
+    const auto ridges = max(
+        scalePoint(turbulence(RidgedMulti{.octaveCount = 5, .seed = 3},
+                              {.frequency = 2.0, .power = 0.1, .roughness = 2, .seed = 4}),
+                   1.5, 1.0, 1.5),
+        floor
+    );
+    const auto terrain = select(control, flatHills, ridges,
+                                {.lowerBound = 0.0, .upperBound = 1000.0, .edgeFalloff = 0.25});
+    const auto detail = min(multiply(Perlin{.frequency = 8.0, .octaveCount = 2, .seed = 5}, control), floor);
+
+    return clamp(add(terrain, detail), -1.0, 1.5);
+}
+
+template<typename F>
+static std::vector<double> run(const std::string &name, const Points &points, const int repetitions, F evaluate) {
+    std::vector<double> result(points.xs.size());
+
+    const Clock::time_point startTime = Clock::now();
+
+    for (int i = 0; i < repetitions; i++) {
+        evaluate(result);
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+    printResult(name, result.size() * repetitions, seconds);
+
+    return result;
+}
+
+/**
+ * @return Largest difference between a libnoise module and a node at the given points.
+ */
+template<NoiseGraph::Node N>
+static double compare(const noise::module::Module &module, const N &node, const Points &points) {
+    double maxDifference = 0.0;
+
+    for (size_t i = 0; i < points.xs.size(); i++) {
+        const double expected = module.GetValue(points.xs[i], points.ys[i], points.zs[i]);
+        const double actual = node.getValue(points.xs[i], points.ys[i], points.zs[i]);
+        maxDifference = std::max(maxDifference, std::abs(expected - actual));
+    }
+
+    return maxDifference;
+}
+
+/**
+ * @return Largest difference between single libnoise modules and their counterparts.
+ */
+static double checkSingleNodes() {
+    double maxDifference = 0.0;
+
+    // the last range reaches far enough for coordinates to get wrapped by `noise::MakeInt32Range`
+    for (const double range: {1.0, 100.0, 1e9}) {
+        const Points points = makePoints(1000, range);
+
+        for (const noise::NoiseQuality quality: {noise::QUALITY_FAST, noise::QUALITY_STD, noise::QUALITY_BEST}) {
+            noise::module::Perlin perlin;
+            perlin.SetNoiseQuality(quality);
+            perlin.SetSeed(-7);
+            maxDifference = std::max(maxDifference, compare(perlin, NoiseGraph::Perlin{
+                                                                .seed = -7, .quality = quality
+                                                            }, points));
+
+            noise::module::Billow billow;
+            billow.SetNoiseQuality(quality);
+            billow.SetLacunarity(2.5);
+            maxDifference = std::max(maxDifference, compare(billow, NoiseGraph::Billow{
+                                                                .lacunarity = 2.5, .quality = quality
+                                                            }, points));
+
+            noise::module::RidgedMulti ridged;
+            ridged.SetNoiseQuality(quality);
+            ridged.SetLacunarity(1.9);
+            ridged.SetSeed(-3);
+            maxDifference = std::max(maxDifference, compare(ridged, NoiseGraph::RidgedMulti{
+                                                                .lacunarity = 1.9, .seed = -3, .quality = quality
+                                                            }, points));
+        }
+    }
+
+    return maxDifference;
+}
+
+int main(const int argc, char **argv) {
+    const size_t pointCount = argc > 1 ? std::stoul(argv[1]) : 65536;
+    const int repetitions = argc > 2 ? std::stoi(argv[2]) : 10;
+
+    const Points points = makePoints(pointCount, 100.0);
+
+    const ModuleGraph moduleGraph;
+    const auto graph = makeGraph();
+
+    const std::vector<double> expected = run("libnoise modules", points, repetitions, [&](std::vector<double> &out) {
+        for (size_t i = 0; i < out.size(); i++) {
+            out[i] = moduleGraph.root.GetValue(points.xs[i], points.ys[i], points.zs[i]);
+        }
+    });
+
+    const std::vector<double> actual = run("NoiseGraph", points, repetitions, [&](std::vector<double> &out) {
+        NoiseGraph::evaluate(graph, points.xs, points.ys, points.zs, out);
+    });
+
+    double maxDifference = 0.0;
+
+    for (size_t i = 0; i < expected.size(); i++) {
+        maxDifference = std::max(maxDifference, std::abs(expected[i] - actual[i]));
+    }
+
+    maxDifference = std::max(maxDifference, checkSingleNodes());
+
+    std::cout << "max difference from libnoise: " << maxDifference << "\n";
+
+    if (maxDifference > TOLERANCE) {
+        std::cout << "results differ from libnoise by more than " << TOLERANCE << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * Throughput benchmark and accuracy check of evaluating the terrain's Perlin noise in batches.
+ *
+ * A square grid of points, like the ones height maps are built from, is evaluated over and over:
+ *  - by libnoise's `NoiseMapBuilderPlane`, which `WorldGen` used before,
+ *  - by `BatchPerlin` restricted to its scalar implementation,
+ *  - by `BatchPerlin` using AVX2, if the CPU supports it.
+ *
+ * Reports the number of points evaluated per second. Afterwards, both `BatchPerlin` implementations are compared
+ * with `Perlin::GetValue` at random points (also far away from the origin) for all noise qualities.
+ *
+ * Exits with a non-zero status if any result differs from libnoise's by more than a small tolerance.
+ *
+ * Usage: voxel-bench-noise [grid width] [repetitions]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "deps/noiseutils/noiseutils.h"
+#include "src/voxel/batch-perlin.h"
+
+using Clock = std::chrono::steady_clock;
+
+// results are expected to be identical, this only leaves room for a compiler contracting operations differently
+static constexpr double TOLERANCE = 1e-9;
+
+// bounds of the grid's area, spanning as many columns of chunks as the height maps of a full grid would
+static constexpr double LOWER_BOUND = -12.3;
+static constexpr double COLUMN_STRETCH = 0.1 / 16.0;
+
+static void printResult(const std::string &name, const size_t points, const double seconds) {
+    std::cout << name << ": " << static_cast<double>(points) / seconds / 1e6 << " M points/s\n";
+}
+
+static std::vector<float> runNoiseMapBuilder(const noise::module::Perlin &module, const int width,
+                                             const int repetitions) {
+    noiseutils::NoiseMap noiseMap;
+    noiseutils::NoiseMapBuilderPlane builder;
+
+    builder.SetSourceModule(module);
+    builder.SetDestNoiseMap(noiseMap);
+    builder.SetDestSize(width, width);
+
+    const double upperBound = LOWER_BOUND + COLUMN_STRETCH * width;
+    builder.SetBounds(LOWER_BOUND, upperBound, LOWER_BOUND, upperBound);
+
+    const Clock::time_point startTime = Clock::now();
+
+    for (int i = 0; i < repetitions; i++) {
+        builder.Build();
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+    printResult("NoiseMapBuilderPlane", static_cast<size_t>(width) * width * repetitions, seconds);
+
+    std::vector<float> result(static_cast<size_t>(width) * width);
+
+    for (int z = 0; z < width; z++) {
+        std::copy_n(noiseMap.GetConstSlabPtr(z), width, &result[static_cast<size_t>(z) * width]);
+    }
+
+    return result;
+}
+
+static std::vector<float> runBatchPerlin(const BatchPerlin &batchPerlin, const std::string &name, const int width,
+                                         const int repetitions) {
+    std::vector<float> result(static_cast<size_t>(width) * width);
+    const double upperBound = LOWER_BOUND + COLUMN_STRETCH * width;
+
+    const Clock::time_point startTime = Clock::now();
+
+    for (int i = 0; i < repetitions; i++) {
+        batchPerlin.evaluatePlane(LOWER_BOUND, LOWER_BOUND, upperBound, upperBound, width, width, result);
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+    printResult(name, result.size() * repetitions, seconds);
+
+    return result;
+}
+
+static double getMaxDifference(const std::vector<float> &expected, const std::vector<float> &actual) {
+    double maxDifference = 0.0;
+
+    for (size_t i = 0; i < expected.size(); i++) {
+        maxDifference = std::max(maxDifference, std::abs(static_cast<double>(expected[i]) - actual[i]));
+    }
+
+    return maxDifference;
+}
+
+/**
+ * @return Largest difference between `Perlin::GetValue` and `BatchPerlin` at random points.
+ */
+static double checkRandomPoints(const noise::NoiseQuality quality, const bool allowSimd) {
+    noise::module::Perlin module;
+    module.SetNoiseQuality(quality);
+    module.SetSeed(1234);
+
+    const BatchPerlin batchPerlin(module, allowSimd);
+
+    std::mt19937 rng(42);
+    std::vector<double> xs, ys, zs;
+
+    // the last range reaches far enough for coordinates to get wrapped by `noise::MakeInt32Range`
+    for (const double range: {1.0, 100.0, 1e7, 1e9}) {
+        std::uniform_real_distribution<double> coord(-range, range);
+
+        for (int i = 0; i < 1001; i++) {
+            xs.push_back(coord(rng));
+            ys.push_back(coord(rng));
+            zs.push_back(coord(rng));
+        }
+    }
+
+    // lattice coordinates, where libnoise's rounding towards the lower lattice point is the least obvious
+    for (int i = -2; i <= 2; i++) {
+        xs.push_back(i);
+        ys.push_back(0.0);
+        zs.push_back(-i);
+    }
+
+    std::vector<double> values(xs.size());
+    batchPerlin.evaluate(xs, ys, zs, values);
+
+    double maxDifference = 0.0;
+
+    for (size_t i = 0; i < values.size(); i++) {
+        maxDifference = std::max(maxDifference, std::abs(module.GetValue(xs[i], ys[i], zs[i]) - values[i]));
+    }
+
+    return maxDifference;
+}
+
+int main(const int argc, char **argv) {
+    const int width = argc > 1 ? std::stoi(argv[1]) : 256;
+    const int repetitions = argc > 2 ? std::stoi(argv[2]) : 20;
+
+    const noise::module::Perlin module;
+    const BatchPerlin scalarPerlin(module, false);
+    const BatchPerlin simdPerlin(module, true);
+
+    const std::vector<float> expected = runNoiseMapBuilder(module, width, repetitions);
+    double maxDifference = getMaxDifference(expected, runBatchPerlin(scalarPerlin, "BatchPerlin, scalar", width,
+                                                                     repetitions));
+
+    if (simdPerlin.isUsingSimd()) {
+        maxDifference = std::max(maxDifference, getMaxDifference(
+            expected, runBatchPerlin(simdPerlin, "BatchPerlin, AVX2", width, repetitions)));
+    } else {
+        std::cout << "BatchPerlin, AVX2: not supported by this CPU\n";
+    }
+
+    for (const noise::NoiseQuality quality: {noise::QUALITY_FAST, noise::QUALITY_STD, noise::QUALITY_BEST}) {
+        for (const bool allowSimd: {false, true}) {
+            maxDifference = std::max(maxDifference, checkRandomPoints(quality, allowSimd));
+        }
+    }
+
+    std::cout << "max difference from libnoise: " << maxDifference << "\n";
+
+    if (maxDifference > TOLERANCE) {
+        std::cout << "results differ from libnoise by more than " << TOLERANCE << "\n";
+        return 1;
+    }
+
+    return 0;
+}
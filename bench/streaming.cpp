@@ -0,0 +1,146 @@
+/*
+ * Headless benchmark of streaming chunks in around a moving camera.
+ *
+ * A `ChunkManager` is driven exactly like the game does it, but with a `RecordingRenderBackend` instead
+ * of the OpenGL renderer, so neither a window nor a GPU is needed. First, the chunks around the origin are
+ * loaded until everything is settled. Then, the camera flies in a straight line at a fixed speed, one tick
+ * per simulated frame, after which the chunk manager is again left to settle.
+ *
+ * Reports the average and 99th percentile time of `ChunkManager::tick` during the flight, how long each
+ * phase took, and the counts of operations the renderer would have been asked to do. Edited chunks would be
+ * saved to a temporary directory, which is removed afterwards.
+ *
+ * Usage: voxel-bench-streaming [render distance] [flight frames] [camera speed, in blocks per frame]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/render/recording-render-backend.h"
+#include "src/voxel/chunk/chunk-manager.h"
+#include "src/voxel/world-gen.h"
+
+using Clock = std::chrono::steady_clock;
+
+// camera height, a bit above the terrain so that the loaded area contains both ground and sky
+static constexpr float CAMERA_HEIGHT = 40.0f;
+
+// upper bound on the number of frames spent waiting for the chunk manager to settle
+static constexpr int MAX_SETTLE_FRAMES = 100000;
+
+struct FrameTimes {
+    std::vector<double> tickMs;
+
+    [[nodiscard]]
+    double getAverage() const {
+        double sum = 0.0;
+        for (const double ms: tickMs) sum += ms;
+        return tickMs.empty() ? 0.0 : sum / static_cast<double>(tickMs.size());
+    }
+
+    [[nodiscard]]
+    double getPercentile(const double percentile) const {
+        if (tickMs.empty()) return 0.0;
+
+        std::vector<double> sorted = tickMs;
+        std::ranges::sort(sorted);
+        return sorted[static_cast<size_t>(percentile / 100.0 * static_cast<double>(sorted.size() - 1))];
+    }
+};
+
+/**
+ * Runs a single frame, the same way the game does it.
+ */
+static double runFrame(ChunkManager &chunkManager, FrameTimes &times) {
+    const Clock::time_point startTime = Clock::now();
+    chunkManager.tick();
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - startTime).count();
+
+    chunkManager.renderChunks();
+    times.tickMs.push_back(ms);
+
+    return ms;
+}
+
+/**
+ * Runs frames until all chunks around the camera are loaded and meshed.
+ *
+ * @return Number of frames it took.
+ */
+static int settle(ChunkManager &chunkManager, FrameTimes &times) {
+    int frames = 0;
+
+    while (!chunkManager.isSettled() && frames < MAX_SETTLE_FRAMES) {
+        runFrame(chunkManager, times);
+        frames++;
+    }
+
+    return frames;
+}
+
+static void printStats(const std::string &name, const FrameTimes &times, const int frames, const double seconds,
+                       const RecordingRenderBackend &backend) {
+    const auto &stats = backend.getStats();
+
+    std::cout << name << ": " << frames << " frames in " << seconds << " s, tick avg " << times.getAverage()
+              << " ms, p99 " << times.getPercentile(99) << " ms\n";
+    std::cout << "    mesh writes: " << stats.meshWrites << ", frees: " << stats.meshFrees
+              << ", quads written: " << stats.quadsWritten
+              << ", " << static_cast<double>(stats.bytesWritten) / (1024.0 * 1024.0) << " MB uploaded\n";
+    std::cout << "    render passes: " << stats.renderPasses << ", chunks rendered per pass: "
+              << (stats.renderPasses ? stats.chunksRendered / stats.renderPasses : 0)
+              << ", stored meshes: " << backend.getStoredMeshCount()
+              << " (" << backend.getStoredQuadCount() << " quads)\n";
+}
+
+int main(const int argc, char **argv) {
+    const int renderDistance = argc > 1 ? std::stoi(argv[1]) : 8;
+    const int flightFrames = argc > 2 ? std::stoi(argv[2]) : 600;
+    const float cameraSpeed = argc > 3 ? std::stof(argv[3]) : 1.0f;
+
+    const std::filesystem::path saveDirectory = std::filesystem::temp_directory_path() / "voxel-bench-streaming";
+    std::filesystem::remove_all(saveDirectory);
+
+    const auto backend = std::make_shared<RecordingRenderBackend>();
+    backend->setCameraPos({0, CAMERA_HEIGHT, 0});
+
+    {
+        ChunkManager chunkManager(backend, std::make_shared<WorldGen>(), saveDirectory);
+        chunkManager.setRenderDistance(renderDistance);
+
+        FrameTimes loadTimes;
+        Clock::time_point startTime = Clock::now();
+        int frames = settle(chunkManager, loadTimes);
+        printStats("initial load", loadTimes, frames, std::chrono::duration<double>(Clock::now() - startTime).count(),
+                   *backend);
+
+        backend->resetStats();
+
+        FrameTimes flightTimes;
+        startTime = Clock::now();
+
+        for (int frame = 1; frame <= flightFrames; frame++) {
+            backend->setCameraPos({static_cast<float>(frame) * cameraSpeed, CAMERA_HEIGHT, 0});
+            runFrame(chunkManager, flightTimes);
+        }
+
+        printStats("flight", flightTimes, flightFrames,
+                   std::chrono::duration<double>(Clock::now() - startTime).count(), *backend);
+
+        backend->resetStats();
+
+        FrameTimes settleTimes;
+        startTime = Clock::now();
+        frames = settle(chunkManager, settleTimes);
+        printStats("catching up", settleTimes, frames,
+                   std::chrono::duration<double>(Clock::now() - startTime).count(), *backend);
+    }
+
+    std::filesystem::remove_all(saveDirectory);
+    return 0;
+}
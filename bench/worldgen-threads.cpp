@@ -0,0 +1,123 @@
+/*
+ * Benchmark and determinism check of generating chunks concurrently with a single shared `WorldGen`.
+ *
+ * The same cube of chunks around the origin is generated by pools of 1, 2, 4, ... worker threads (up to the
+ * number of hardware threads, but at least 8 so that races show up on small machines as well), each run using
+ * a fresh `WorldGen`. Each run reports its throughput, along with
+ * a hash of the contents of all generated chunks, combined in a fixed order so that it doesn't depend
+ * on which thread finished first.
+ *
+ * Exits with a non-zero status if any run produced different chunks than the single-threaded one.
+ *
+ * Usage: voxel-bench-worldgen-threads [radius in chunks]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/voxel/chunk/chunk.h"
+#include "src/voxel/world-gen.h"
+#include "src/utils/thread-pool.h"
+
+using Clock = std::chrono::steady_clock;
+
+static std::uint64_t hashChunk(const Chunk &chunk) {
+    // FNV-1a over all blocks in storage order
+    std::uint64_t hash = 0xcbf29ce484222325;
+
+    for (int x = 0; x < Chunk::CHUNK_SIZE; x++) {
+        for (int y = 0; y < Chunk::CHUNK_SIZE; y++) {
+            for (int z = 0; z < Chunk::CHUNK_SIZE; z++) {
+                hash ^= chunk.getBlock(x, y, z);
+                hash *= 0x100000001b3;
+            }
+        }
+    }
+
+    return hash;
+}
+
+/**
+ * @return Hash of the contents of all generated chunks.
+ */
+static std::uint64_t runBenchmark(const std::vector<glm::ivec3> &positions, const size_t threadCount) {
+    WorldGen worldGen;
+    std::vector<std::uint64_t> chunkHashes(positions.size());
+
+    const Clock::time_point startTime = Clock::now();
+
+    {
+        // destroying the pool discards queued tasks, so the tasks themselves split up the work
+        ThreadPool threadPool(threadCount);
+        std::atomic<size_t> nextChunk = 0;
+        std::atomic<size_t> finishedThreads = 0;
+
+        for (size_t i = 0; i < threadCount; i++) {
+            threadPool.enqueue([&] {
+                for (size_t chunk = nextChunk++; chunk < positions.size(); chunk = nextChunk++) {
+                    Chunk c(static_cast<Chunk::ChunkID>(chunk), positions[chunk]);
+                    c.generate(worldGen);
+                    chunkHashes[chunk] = hashChunk(c);
+                }
+
+                finishedThreads++;
+            });
+        }
+
+        while (finishedThreads < threadCount) {
+            std::this_thread::yield();
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    std::uint64_t hash = 0xcbf29ce484222325;
+    for (const std::uint64_t chunkHash: chunkHashes) {
+        hash = (hash ^ chunkHash) * 0x100000001b3;
+    }
+
+    std::cout << threadCount << " threads: " << static_cast<double>(positions.size()) / seconds
+              << " chunks/s, hash " << std::hex << hash << std::dec << "\n";
+
+    return hash;
+}
+
+int main(const int argc, char **argv) {
+    const int radius = argc > 1 ? std::stoi(argv[1]) : 8;
+
+    std::vector<glm::ivec3> positions;
+
+    for (int x = -radius; x <= radius; x++) {
+        for (int y = -radius; y <= radius; y++) {
+            for (int z = -radius; z <= radius; z++) {
+                positions.emplace_back(x, y, z);
+            }
+        }
+    }
+
+    // chunks are loaded closest first, which interleaves columns just like here
+    std::ranges::sort(positions, [](const glm::ivec3 &a, const glm::ivec3 &b) {
+        return a.x * a.x + a.y * a.y + a.z * a.z < b.x * b.x + b.y * b.y + b.z * b.z;
+    });
+
+    const size_t maxThreadCount = std::max(std::thread::hardware_concurrency(), 8u);
+    const std::uint64_t expectedHash = runBenchmark(positions, 1);
+    bool isDeterministic = true;
+
+    for (size_t threadCount = 2; threadCount <= maxThreadCount; threadCount *= 2) {
+        isDeterministic &= runBenchmark(positions, threadCount) == expectedHash;
+    }
+
+    if (!isDeterministic) {
+        std::cout << "generated chunks differ between thread counts\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * Headless benchmark and regression check of world generation.
+ *
+ * Generates a cube of chunks around the origin with a single `WorldGen` on a single thread, in a fixed order,
+ * timing the generation of each chunk on its own. Reports the throughput in chunks per second, the median and
+ * 99th percentile of per-chunk latencies, and a hash of the contents of all generated chunks.
+ *
+ * The hash only depends on the seed and the size of the cube, so it can be compared between builds to detect
+ * unintended changes of the generated world. If an expected hash is given, exits with a non-zero status
+ * if the actual hash differs from it.
+ *
+ * Usage: voxel-bench-worldgen [radius in chunks] [seed] [expected hash, in hex]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "src/voxel/chunk/chunk.h"
+#include "src/voxel/world-gen.h"
+
+using Clock = std::chrono::steady_clock;
+
+static std::uint64_t hashChunk(const Chunk &chunk, std::uint64_t hash) {
+    // FNV-1a over all blocks in storage order
+    for (int x = 0; x < Chunk::CHUNK_SIZE; x++) {
+        for (int y = 0; y < Chunk::CHUNK_SIZE; y++) {
+            for (int z = 0; z < Chunk::CHUNK_SIZE; z++) {
+                hash ^= chunk.getBlock(x, y, z);
+                hash *= 0x100000001b3;
+            }
+        }
+    }
+
+    return hash;
+}
+
+/**
+ * @return Latency at a given percentile, out of latencies sorted in ascending order.
+ */
+static double getPercentile(const std::vector<double> &sortedLatencies, const double percentile) {
+    const auto index = static_cast<size_t>(percentile / 100.0 * static_cast<double>(sortedLatencies.size() - 1));
+    return sortedLatencies[index];
+}
+
+int main(const int argc, char **argv) {
+    const int radius = argc > 1 ? std::stoi(argv[1]) : 6;
+    const int seed = argc > 2 ? std::stoi(argv[2]) : 0;
+    const bool hasExpectedHash = argc > 3;
+    const std::uint64_t expectedHash = hasExpectedHash ? std::stoull(argv[3], nullptr, 16) : 0;
+
+    WorldGen worldGen(seed);
+    std::vector<double> latencies;
+    std::uint64_t hash = 0xcbf29ce484222325;
+    Chunk::ChunkID nextID = 0;
+
+    const Clock::time_point startTime = Clock::now();
+
+    for (int x = -radius; x <= radius; x++) {
+        for (int y = -radius; y <= radius; y++) {
+            for (int z = -radius; z <= radius; z++) {
+                Chunk chunk(nextID++, {x, y, z});
+
+                const Clock::time_point chunkStartTime = Clock::now();
+                chunk.generate(worldGen);
+                latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - chunkStartTime).count());
+
+                hash = hashChunk(chunk, hash);
+            }
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    std::ranges::sort(latencies);
+
+    std::cout << "seed " << seed << ", " << latencies.size() << " chunks\n";
+    std::cout << "throughput: " << static_cast<double>(latencies.size()) / seconds << " chunks/s\n";
+    std::cout << "latency: p50 " << getPercentile(latencies, 50) << " us, p99 " << getPercentile(latencies, 99)
+              << " us, max " << latencies.back() << " us\n";
+    std::cout << "hash: " << std::hex << std::setw(16) << std::setfill('0') << hash << std::dec << "\n";
+
+    if (hasExpectedHash && hash != expectedHash) {
+        std::cout << "hash differs from the expected " << std::hex << std::setw(16) << std::setfill('0')
+                  << expectedHash << std::dec << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#version 430 core
+
+// chunk meshes stored as one packed record per quad, see `IndexedMeshData::packQuad`
+layout(std430, binding = 0) readonly buffer QuadBuffer {
+    uint packedQuads[];
+};
+
+layout(location = 1) in ivec3 chunkOrigin; // per-draw, supplied through the base instance
+
+out vec3 vertexPosition_worldspace;
+out float viewDepth;
+out vec3 Normal_modelspace;
+out vec2 UV;
+flat out uint texID;
+
+uniform mat4 MVP;
+uniform vec3 LightDirection_worldspace;
+
+// splits a quad into triangles, same as `IndexedMeshData::QUAD_INDEX_PATTERN`
+const uint QUAD_INDEX_PATTERN[6] = uint[](0u, 1u, 2u, 0u, 2u, 3u);
+
+// `[face * 4 + corner]` tells whether a corner lies at the far end of the quad along its `u` and `v` axes.
+// this mirrors the corner order of quads written by the indexed layout, so that both wind triangles the same way
+const ivec2 CORNER_STEPS[24] = ivec2[](
+    ivec2(0, 0), ivec2(1, 0), ivec2(1, 1), ivec2(0, 1), // front
+    ivec2(1, 0), ivec2(0, 0), ivec2(0, 1), ivec2(1, 1), // back
+    ivec2(0, 1), ivec2(0, 0), ivec2(1, 0), ivec2(1, 1), // right
+    ivec2(0, 0), ivec2(0, 1), ivec2(1, 1), ivec2(1, 0), // left
+    ivec2(0, 1), ivec2(1, 1), ivec2(1, 0), ivec2(0, 0), // top
+    ivec2(0, 0), ivec2(1, 0), ivec2(1, 1), ivec2(0, 1)  // bottom
+);
+
+// `[corner]` tells which components of the corner's UV span the whole quad
+const ivec2 CORNER_UV_STEPS[4] = ivec2[](ivec2(0, 1), ivec2(1, 1), ivec2(1, 0), ivec2(0, 0));
+
+// axis along which the normal of a face points
+const int FACE_AXES[6] = int[](2, 2, 0, 0, 1, 1);
+
+const vec3 FACE_NORMALS[6] = vec3[](
+    vec3(0, 0, 1),
+    vec3(0, 0, -1),
+    vec3(1, 0, 0),
+    vec3(-1, 0, 0),
+    vec3(0, 1, 0),
+    vec3(0, -1, 0)
+);
+
+void main() {
+    uint packedQuad = packedQuads[gl_VertexID / 6];
+    uint corner = QUAD_INDEX_PATTERN[gl_VertexID % 6];
+
+    vec3 start = vec3(packedQuad & 0xFu, (packedQuad >> 4) & 0xFu, (packedQuad >> 8) & 0xFu);
+    uint face = (packedQuad >> 12) & 0x7u;
+    int width = int((packedQuad >> 15) & 0xFu) + 1;
+    int height = int((packedQuad >> 19) & 0xFu) + 1;
+
+    // `u` and `v` are the two axes perpendicular to the normal, in increasing order
+    int axis = FACE_AXES[face];
+    int uAxis = axis == 0 ? 1 : 0;
+    int vAxis = axis == 2 ? 1 : 2;
+
+    ivec2 steps = CORNER_STEPS[face * 4u + corner];
+
+    vec3 offset = vec3(0);
+    offset[uAxis] = float(steps.x * width);
+    offset[vAxis] = float(steps.y * height);
+    offset[axis] = face % 2u == 0u ? 1.0 : 0.0; // positive faces lie on the far side of their blocks
+
+    vec3 vertexPosition_modelspace = vec3(chunkOrigin) + start + offset;
+
+    // side faces have their textures rotated, so the quad's extents are swapped for them
+    bool isSideways = face == 2u || face == 3u;
+    vec2 uvExtent = isSideways ? vec2(height, width) : vec2(width, height);
+
+    Normal_modelspace = FACE_NORMALS[face];
+    UV = vec2(CORNER_UV_STEPS[corner]) * uvExtent;
+    texID = (packedQuad >> 23) & 0xFFu;
+
+    gl_Position = MVP * vec4(vertexPosition_modelspace, 1);
+
+    // the model matrix is the identity matrix, and the projection's w is the distance along the view direction
+    vertexPosition_worldspace = vertexPosition_modelspace;
+    viewDepth = gl_Position.w;
+}
@@ -3,14 +3,21 @@
 in vec2 UV;
 flat in uint texID;
 in vec3 Normal_modelspace;
-in vec4 vertexPosition_lightSpace;
+in vec3 vertexPosition_worldspace;
+in float viewDepth;
 
 out vec4 color;
 
 uniform vec3 LightDirection_worldspace;
 uniform sampler2D texSampler[4];
 uniform bool doDrawShadows;
-uniform sampler2D shadowMap;
+
+// has to match `OpenGLRenderer::SHADOW_CASCADE_COUNT`
+#define SHADOW_CASCADE_COUNT 4
+
+uniform sampler2D shadowMaps[SHADOW_CASCADE_COUNT];
+uniform mat4 lightVPs[SHADOW_CASCADE_COUNT];
+uniform float cascadeEnds[SHADOW_CASCADE_COUNT];
 
 #define DEF_TEX_SAMPLER_ID(n) \
     if (texID == (n)) return texture(texSampler[(n)], UV).rgb;
@@ -24,7 +31,7 @@ vec3 getTexSample(uint id) {
     return vec3(0);
 }
 
-float calcShadow(vec4 fragPos_lightSpace) {
+float calcShadow(sampler2D shadowMap, vec4 fragPos_lightSpace) {
     vec3 projCoords = fragPos_lightSpace.xyz / fragPos_lightSpace.w; // perspective division
     projCoords = projCoords * 0.5 + 0.5; // [-1, 1] -> [0, 1]
     float currentDepth = projCoords.z;
@@ -49,6 +56,20 @@ float calcShadow(vec4 fragPos_lightSpace) {
     return shadow / samplesCount;
 }
 
+// sampler arrays can only be indexed with constants
+#define DEF_SHADOW_CASCADE(n) \
+    if (viewDepth < cascadeEnds[(n)]) \
+        return calcShadow(shadowMaps[(n)], lightVPs[(n)] * vec4(vertexPosition_worldspace, 1.0));
+
+float getShadow() {
+    // cascades go from the nearest one, which is also the sharpest
+    DEF_SHADOW_CASCADE(0)
+    DEF_SHADOW_CASCADE(1)
+    DEF_SHADOW_CASCADE(2)
+    DEF_SHADOW_CASCADE(3)
+    return 0.0;
+}
+
 void main() {
     vec3 LightColor = vec3(1.0, 1.0, 0.9);
     float LightPower = 0.6f;
@@ -62,7 +83,7 @@ void main() {
     float cosTheta = clamp(dot(n, l), 0, 1);
     vec3 diffuse = texColor * LightColor * LightPower * cosTheta;
 
-    float shadow = doDrawShadows ? calcShadow(vertexPosition_lightSpace) : 0.0;
+    float shadow = doDrawShadows ? getShadow() : 0.0;
 
     vec3 opaqueColor = ambient + (1.0 - shadow) * diffuse;
 
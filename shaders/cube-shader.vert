@@ -1,17 +1,25 @@
 #version 330 core
 
-layout(location = 0) in ivec3 vertexPosition;
-layout(location = 1) in uint packedNormalUvTex;
+layout(location = 0) in uvec2 packedVertex;
+layout(location = 1) in ivec3 chunkOrigin; // per-draw, supplied through the base instance
 
-out vec4 vertexPosition_lightSpace;
+out vec3 vertexPosition_worldspace;
+out float viewDepth;
 out vec3 Normal_modelspace;
 out vec2 UV;
 flat out uint texID;
 
 uniform mat4 MVP;
-uniform mat4 lightMVP;
 uniform vec3 LightDirection_worldspace;
 
+vec3 unpackVertexPosition(uint packedPosition) {
+    return vec3(
+        float(packedPosition & 0x1Fu),
+        float((packedPosition >> 5) & 0x1Fu),
+        float((packedPosition >> 10) & 0x1Fu)
+    );
+}
+
 vec3 unpackVertexNormal(uint packedVertex) {
     uint normalIndex = packedVertex >> 29;
 
@@ -36,12 +44,14 @@ uint unpackVertexTexID(uint packedVertex) {
 }
 
 void main() {
-    vec3 vertexPosition_modelspace = vertexPosition;
-    Normal_modelspace = unpackVertexNormal(packedNormalUvTex);
-    UV = unpackVertexUV(packedNormalUvTex);
-    texID = unpackVertexTexID(packedNormalUvTex);
+    vec3 vertexPosition_modelspace = vec3(chunkOrigin) + unpackVertexPosition(packedVertex.x);
+    Normal_modelspace = unpackVertexNormal(packedVertex.y);
+    UV = unpackVertexUV(packedVertex.y);
+    texID = unpackVertexTexID(packedVertex.y);
 
     gl_Position = MVP * vec4(vertexPosition_modelspace, 1);
 
-    vertexPosition_lightSpace = lightMVP * vec4(vertexPosition_modelspace, 1.0);
+    // the model matrix is the identity matrix, and the projection's w is the distance along the view direction
+    vertexPosition_worldspace = vertexPosition_modelspace;
+    viewDepth = gl_Position.w;
 }
@@ -0,0 +1,48 @@
+#version 430 core
+
+// chunk meshes stored as one packed record per quad, see `IndexedMeshData::packQuad`
+layout(std430, binding = 0) readonly buffer QuadBuffer {
+    uint packedQuads[];
+};
+
+layout(location = 1) in ivec3 chunkOrigin;
+
+uniform mat4 MVP;
+
+// see cube-shader-pulled.vert for a description of these
+const uint QUAD_INDEX_PATTERN[6] = uint[](0u, 1u, 2u, 0u, 2u, 3u);
+
+const ivec2 CORNER_STEPS[24] = ivec2[](
+    ivec2(0, 0), ivec2(1, 0), ivec2(1, 1), ivec2(0, 1),
+    ivec2(1, 0), ivec2(0, 0), ivec2(0, 1), ivec2(1, 1),
+    ivec2(0, 1), ivec2(0, 0), ivec2(1, 0), ivec2(1, 1),
+    ivec2(0, 0), ivec2(0, 1), ivec2(1, 1), ivec2(1, 0),
+    ivec2(0, 1), ivec2(1, 1), ivec2(1, 0), ivec2(0, 0),
+    ivec2(0, 0), ivec2(1, 0), ivec2(1, 1), ivec2(0, 1)
+);
+
+const int FACE_AXES[6] = int[](2, 2, 0, 0, 1, 1);
+
+void main() {
+    uint packedQuad = packedQuads[gl_VertexID / 6];
+    uint corner = QUAD_INDEX_PATTERN[gl_VertexID % 6];
+
+    vec3 start = vec3(packedQuad & 0xFu, (packedQuad >> 4) & 0xFu, (packedQuad >> 8) & 0xFu);
+    uint face = (packedQuad >> 12) & 0x7u;
+    int width = int((packedQuad >> 15) & 0xFu) + 1;
+    int height = int((packedQuad >> 19) & 0xFu) + 1;
+
+    int axis = FACE_AXES[face];
+    int uAxis = axis == 0 ? 1 : 0;
+    int vAxis = axis == 2 ? 1 : 2;
+
+    ivec2 steps = CORNER_STEPS[face * 4u + corner];
+
+    vec3 offset = vec3(0);
+    offset[uAxis] = float(steps.x * width);
+    offset[vAxis] = float(steps.y * height);
+    offset[axis] = face % 2u == 0u ? 1.0 : 0.0;
+
+    vec3 vertexPosition_modelspace = vec3(chunkOrigin) + start + offset;
+    gl_Position = MVP * vec4(vertexPosition_modelspace, 1);
+}
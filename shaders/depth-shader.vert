@@ -1,9 +1,15 @@
 #version 330 core
-layout(location = 0) in ivec3 vertexPosition;
+layout(location = 0) in uvec2 packedVertex;
+layout(location = 1) in ivec3 chunkOrigin;
 
 uniform mat4 MVP;
 
 void main() {
-    vec3 vertexPosition_modelspace = vertexPosition;
+    uint packedPosition = packedVertex.x;
+    vec3 vertexPosition_modelspace = vec3(chunkOrigin) + vec3(
+        float(packedPosition & 0x1Fu),
+        float((packedPosition >> 5) & 0x1Fu),
+        float((packedPosition >> 10) & 0x1Fu)
+    );
     gl_Position = MVP * vec4(vertexPosition_modelspace, 1);
 }
@@ -0,0 +1,201 @@
+#include "engine.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "GL/glew.h"
+#include <GLFW/glfw3.h>
+#include <glm/gtx/quaternion.hpp>
+
+#include "utils/profiler.h"
+
+using Clock = std::chrono::steady_clock;
+
+static float millisecondsBetween(const Clock::time_point start, const Clock::time_point end) {
+    return std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+void VEngine::init(const Config &config) {
+    if (!glfwInit()) {
+        throw std::runtime_error("Failed to initialize GLFW");
+    }
+
+    Profiler::setThreadName("render");
+
+    if (config.isWindowHidden) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        doLockCursor = false;
+    }
+
+    renderer = std::make_shared<OpenGLRenderer>(1024, 768);
+    renderer->setIsCursorLocked(doLockCursor);
+
+    window = renderer->getWindow();
+    guiRenderer = std::make_shared<GuiRenderer>(window);
+    worldGen = std::make_shared<WorldGen>(config.seed);
+    chunkManager = std::make_unique<ChunkManager>(renderer, worldGen, config.saveDirectory);
+    bindKeyActions();
+}
+
+void VEngine::startTicking() {
+    while (!glfwWindowShouldClose(window)) {
+        // calculate this tick's delta time
+        const auto currentTime = static_cast<float>(glfwGetTime());
+        const float deltaTime = currentTime - lastTime;
+        lastTime = currentTime;
+
+        tick(deltaTime);
+    }
+}
+
+void VEngine::tick(const float deltaTime) {
+    VOXEL_PROFILE_FRAME();
+    VOXEL_PROFILE_SCOPE("VEngine::tick");
+
+    const Clock::time_point frameStartTime = Clock::now();
+
+    keyManager.tick(deltaTime);
+    renderer->tick(deltaTime);
+
+    const Clock::time_point chunkTickStartTime = Clock::now();
+    chunkManager->tick();
+    const Clock::time_point drawStartTime = Clock::now();
+
+    // rendering
+    {
+        VOXEL_PROFILE_SCOPE("VEngine::tick draw");
+
+        renderer->startRendering();
+
+        chunkManager->renderChunks();
+
+        if (doRenderChunkOutlines) {
+            chunkManager->renderChunkOutlines();
+        }
+
+        processTargetedBlocks();
+
+        renderer->renderOutlines();
+
+        renderer->renderSkybox();
+
+        // following functions HAVE TO be called as the last thing, because while rendering overlays we clear
+        // the z-buffer so that the gui is on top of everything.
+        // this is, of course, not desired in regard to other non-ui rendered things.
+        renderer->renderHud();
+    }
+
+    const Clock::time_point drawEndTime = Clock::now();
+
+    if (doShowGui) {
+        VOXEL_PROFILE_SCOPE("VEngine::tick gui");
+
+        guiRenderer->startRendering();
+        renderGuiSection(deltaTime);
+        chunkManager->renderGuiSection();
+        renderer->renderGuiSection();
+        profilerPanel.renderGuiSection();
+        guiRenderer->finishRendering();
+    }
+
+    {
+        VOXEL_PROFILE_SCOPE("VEngine::tick swap");
+        renderer->finishRendering();
+    }
+
+    const ChunkManager::FrameStats &chunkStats = chunkManager->getLastFrameStats();
+    lastFrameTimings = {
+        .frameMs = millisecondsBetween(frameStartTime, Clock::now()),
+        .chunkTickMs = millisecondsBetween(chunkTickStartTime, drawStartTime),
+        .meshMs = chunkStats.meshMs,
+        .uploadMs = chunkStats.uploadMs,
+        .drawMs = millisecondsBetween(drawStartTime, drawEndTime),
+        .uploads = chunkStats.uploads,
+        .gpuPassMs = renderer->getPassGpuTimes(),
+    };
+}
+
+void VEngine::processTargetedBlocks() {
+    const std::vector<glm::ivec3> lookedAtBlocks = renderer->getLookedAtBlocks();
+
+    nextBlockPos = {};
+    targetedBlockPos = chunkManager->getTargetedBlock(lookedAtBlocks);
+    if (!targetedBlockPos) {
+        return;
+    }
+
+    renderer->addTargetedBlockOutline(*targetedBlockPos);
+
+    const glm::vec3 cameraPos = renderer->getCameraPos();
+
+    for (const auto face: blockFaces) {
+        const glm::ivec3 normal = getNormalFromFace(face);
+        const glm::ivec3 candidatePos = *targetedBlockPos + normal;
+
+        if (std::ranges::any_of(lookedAtBlocks, [&](const glm::ivec3& pos) { return pos == candidatePos; })) {
+            if (nextBlockPos) {
+                const float candidateDistSq = glm::length2(cameraPos - glm::vec3(candidatePos));
+                const float currDistSq = glm::length2(cameraPos - glm::vec3(*nextBlockPos));
+                if (candidateDistSq < currDistSq) {
+                    nextBlockPos = candidatePos;
+                }
+
+            } else {
+                nextBlockPos = candidatePos;
+            }
+        }
+    }
+}
+
+void VEngine::bindKeyActions() {
+    keyManager.bindWindow(window);
+
+    keyManager.bindCallback(GLFW_MOUSE_BUTTON_LEFT, EActivationType::PRESS_ONCE, [&](const float deltaTime) {
+        (void) deltaTime;
+        if (targetedBlockPos && doLockCursor) {
+            chunkManager->updateBlock(*targetedBlockPos, BlockType_None);
+        }
+    });
+
+    keyManager.bindCallback(GLFW_MOUSE_BUTTON_RIGHT, EActivationType::PRESS_ONCE, [&](const float deltaTime) {
+        (void) deltaTime;
+        if (nextBlockPos && doLockCursor) {
+            chunkManager->updateBlock(*nextBlockPos, chosenBlockType);
+        }
+    });
+
+    keyManager.bindCallback(GLFW_KEY_GRAVE_ACCENT, EActivationType::PRESS_ONCE, [&](const float deltaTime) {
+        (void) deltaTime;
+        doShowGui = !doShowGui;
+    });
+
+    keyManager.bindCallback(GLFW_KEY_F1, EActivationType::PRESS_ONCE, [&](const float deltaTime) {
+        (void) deltaTime;
+        doRenderChunkOutlines = !doRenderChunkOutlines;
+    });
+
+    keyManager.bindCallback(GLFW_KEY_F2, EActivationType::PRESS_ONCE, [&](const float deltaTime) {
+        (void) deltaTime;
+        doLockCursor = !doLockCursor;
+        renderer->setIsCursorLocked(doLockCursor);
+    });
+
+    keyManager.bindCallback(GLFW_KEY_ESCAPE, EActivationType::PRESS_ONCE, [&](const float deltaTime) {
+        (void) deltaTime;
+        glfwSetWindowShouldClose(window, true);
+    });
+}
+
+void VEngine::renderGuiSection(const float deltaTime) const {
+    static float fps = 1 / deltaTime;
+
+    constexpr float smoothing = 0.95f;
+    fps = fps * smoothing + (1 / deltaTime) * (1.0f - smoothing);
+
+    constexpr auto sectionFlags = ImGuiTreeNodeFlags_DefaultOpen;
+
+    if (ImGui::CollapsingHeader("Engine ", sectionFlags)) {
+        ImGui::Text("FPS: %.2f (%.2f ms)", fps, 1000.f / fps);
+        ImGui::Text("World seed: %d", worldGen->getSeed());
+    }
+}
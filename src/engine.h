@@ -0,0 +1,111 @@
+#ifndef VOXEL_ENGINE_H
+#define VOXEL_ENGINE_H
+
+#include <array>
+#include <filesystem>
+#include <memory>
+#include <optional>
+
+#include "render/gui.h"
+#include "render/profiler-panel.h"
+#include "render/renderer.h"
+#include "voxel/chunk/chunk-manager.h"
+#include "utils/key-manager.h"
+#include "src/voxel/world-gen.h"
+
+/**
+ * Ties together the renderer, the chunk manager and the player's input, running them once per frame.
+ */
+class VEngine {
+public:
+    struct Config {
+        int seed = 0;
+
+        // directory in which the world's edited chunks are saved
+        std::filesystem::path saveDirectory;
+
+        // a hidden window still gets a working OpenGL context, which lets benchmarks run the whole frame
+        // without showing anything. the cursor isn't locked then, so that it doesn't rotate the camera
+        bool isWindowHidden = false;
+    };
+
+    /**
+     * CPU time spent in the parts of the last frame, in milliseconds.
+     * Meshing is done by the worker threads, so its time doesn't add up with the rest.
+     */
+    struct FrameTimings {
+        // whole `tick`, including waiting for the buffers to be swapped
+        float frameMs = 0.f;
+
+        // `ChunkManager::tick`, which includes the uploads
+        float chunkTickMs = 0.f;
+
+        // worker time spent meshing the chunks uploaded in this frame
+        float meshMs = 0.f;
+        float uploadMs = 0.f;
+
+        // everything from starting to render until the HUD is done, not counting the GUI
+        float drawMs = 0.f;
+
+        size_t uploads = 0;
+
+        // GPU time of each render pass, which is a few frames behind. these are zero without a GPU
+        std::array<float, RenderPass_NumPasses> gpuPassMs{};
+    };
+
+private:
+    std::shared_ptr<OpenGLRenderer> renderer;
+    GLFWwindow *window = nullptr;
+
+    std::shared_ptr<GuiRenderer> guiRenderer;
+
+    ProfilerPanel profilerPanel;
+
+    std::unique_ptr<ChunkManager> chunkManager;
+
+    std::shared_ptr<WorldGen> worldGen;
+
+    KeyManager keyManager;
+
+    std::optional<glm::ivec3> targetedBlockPos, nextBlockPos;
+    EBlockType chosenBlockType = BlockType_Stone;
+
+    float lastTime = 0.f;
+
+    FrameTimings lastFrameTimings;
+
+    bool doRenderChunkOutlines = false;
+    bool doShowGui = false;
+    bool doLockCursor = true;
+
+public:
+    void init(const Config &config);
+
+    /**
+     * Ticks until the window gets closed, measuring the time between frames.
+     */
+    void startTicking();
+
+    /**
+     * Runs a single frame, taking a given amount of time since the previous one.
+     */
+    void tick(float deltaTime);
+
+    [[nodiscard]]
+    const FrameTimings& getLastFrameTimings() const { return lastFrameTimings; }
+
+    [[nodiscard]]
+    OpenGLRenderer& getRenderer() const { return *renderer; }
+
+    [[nodiscard]]
+    ChunkManager& getChunkManager() const { return *chunkManager; }
+
+private:
+    void processTargetedBlocks();
+
+    void bindKeyActions();
+
+    void renderGuiSection(float deltaTime) const;
+};
+
+#endif //VOXEL_ENGINE_H
@@ -0,0 +1,201 @@
+#include "binary-mesher.h"
+
+#include <bit>
+
+#include "mesh-context.h"
+
+static constexpr int CHUNK_SIZE = Chunk::CHUNK_SIZE;
+
+// mask of bits representing blocks of the meshed chunk itself, after the padding bit was shifted out
+static constexpr BinaryMesher::ColumnMask INTERIOR_MASK = (1u << CHUNK_SIZE) - 1;
+
+enum EAxis { Axis_X = 0, Axis_Y = 1, Axis_Z = 2 };
+
+static EAxis getFaceAxis(const EBlockFace face) {
+    switch (face) {
+        case Right:
+        case Left:
+            return Axis_X;
+        case Top:
+        case Bottom:
+            return Axis_Y;
+        case Front:
+        case Back:
+            return Axis_Z;
+        default:
+            throw std::runtime_error("invalid face value in getFaceAxis()");
+    }
+}
+
+/**
+ * Inverse of the column layout: maps a depth along `axis` and the remaining two coordinates back to a block.
+ */
+static glm::ivec3 getBlockPos(const EAxis axis, const int depth, const int u, const int v) {
+    switch (axis) {
+        case Axis_X:
+            return {depth, u, v};
+        case Axis_Y:
+            return {u, depth, v};
+        default:
+            return {u, v, depth};
+    }
+}
+
+/**
+ * @return Unit vectors along which the `u` and `v` coordinates of a plane facing a given direction grow.
+ */
+static std::pair<glm::ivec3, glm::ivec3> getPlaneAxes(const EAxis axis) {
+    switch (axis) {
+        case Axis_X:
+            return {{0, 1, 0}, {0, 0, 1}};
+        case Axis_Y:
+            return {{1, 0, 0}, {0, 0, 1}};
+        default:
+            return {{1, 0, 0}, {0, 1, 0}};
+    }
+}
+
+void BinaryMesher::createMesh(const Chunk::PaddedBlockArray &blocks, const glm::ivec3 &origin,
+                              const BlockSamplerTable &samplers, IndexedMeshData &out) {
+    ColumnGrid columns{};
+
+    // coordinates in the padded array are already shifted by one, just like bits in the columns.
+    // padding blocks lying on the edges of the padded cube end up in columns which are never read
+    for (int x = 0; x < PADDED_SIZE; x++) {
+        for (int y = 0; y < PADDED_SIZE; y++) {
+            for (int z = 0; z < PADDED_SIZE; z++) {
+                if (blocks[x][y][z].isNone()) continue;
+
+                columns[Axis_X][y][z] |= 1u << x;
+                columns[Axis_Y][x][z] |= 1u << y;
+                columns[Axis_Z][x][y] |= 1u << z;
+            }
+        }
+    }
+
+    // merging clears all bits it consumes, so the planes are empty again after each face and can be reused
+    PlaneGrid planes{};
+
+    out.origin = origin;
+
+    for (const EBlockFace face: blockFaces) {
+        meshFace(face, columns, planes, blocks, samplers, out);
+    }
+}
+
+void BinaryMesher::meshFace(const EBlockFace face, const ColumnGrid &columns, PlaneGrid &planes,
+                            const Chunk::PaddedBlockArray &blocks, const BlockSamplerTable &samplers,
+                            IndexedMeshData &out) {
+    const EAxis axis = getFaceAxis(face);
+    const bool isPositive = face == Right || face == Top || face == Front;
+    const glm::uint32 faceIndex = getFaceIndex(face);
+
+    glm::uint32 usedSamplers = 0;
+
+    // find visible faces and sort them into planes
+    for (int u = 0; u < CHUNK_SIZE; u++) {
+        for (int v = 0; v < CHUNK_SIZE; v++) {
+            const ColumnMask column = columns[axis][u + 1][v + 1];
+            const ColumnMask neighbours = isPositive ? column >> 1 : column << 1;
+            ColumnMask visible = ((column & ~neighbours) >> 1) & INTERIOR_MASK;
+
+            while (visible) {
+                const int depth = std::countr_zero(visible);
+                visible &= visible - 1;
+
+                const glm::ivec3 blockPos = getBlockPos(axis, depth, u, v);
+                const int sampler = samplers[blocks[blockPos + 1].blockType][faceIndex];
+
+                if (sampler < 0 || sampler >= MAX_SAMPLER_COUNT) {
+                    throw std::runtime_error("sampler ID out of range in BinaryMesher::meshFace()");
+                }
+
+                planes[sampler][depth][v] |= 1u << u;
+                usedSamplers |= 1u << sampler;
+            }
+        }
+    }
+
+    const auto [uAxis, vAxis] = getPlaneAxes(axis);
+
+    // greedily merge faces in each plane into rectangles
+    while (usedSamplers) {
+        const int sampler = std::countr_zero(usedSamplers);
+        usedSamplers &= usedSamplers - 1;
+
+        for (int depth = 0; depth < CHUNK_SIZE; depth++) {
+            auto &rows = planes[sampler][depth];
+
+            for (int v = 0; v < CHUNK_SIZE; v++) {
+                while (rows[v]) {
+                    // stride along the row to determine the width of the merged rectangle...
+                    const int u = std::countr_zero(rows[v]);
+                    const int width = std::countr_one(rows[v] >> u);
+                    const ColumnMask runMask = ((1u << width) - 1) << u;
+
+                    // ...then extend it over the following rows for as long as they contain the whole run
+                    int height = 1;
+                    while (v + height < CHUNK_SIZE && (rows[v + height] & runMask) == runMask) {
+                        rows[v + height] &= ~runMask;
+                        height++;
+                    }
+
+                    rows[v] &= ~runMask;
+
+                    const glm::ivec3 start = getBlockPos(axis, depth, 0, 0) + uAxis * u + vAxis * v;
+                    emitQuad(face, start, width, height, sampler, out);
+                }
+            }
+        }
+    }
+}
+
+void BinaryMesher::emitQuad(const EBlockFace face, const glm::ivec3 &start, const int width, const int height,
+                            const int sampler, IndexedMeshData &out) {
+    if (out.layout == ChunkMeshLayout_PulledQuads) {
+        out.quads.push_back(IndexedMeshData::packQuad(face, start, width, height, sampler));
+        return;
+    }
+
+    const auto [uAxis, vAxis] = getPlaneAxes(getFaceAxis(face));
+    const auto [bottomLeft, topRight] = Block::getFaceCorners(face);
+
+    // this follows the same vertex ordering as ChunkMeshContext::mergeQuads and getQuadCorners,
+    // so that both meshers produce identically oriented quads and UVs
+    glm::ivec3 v1 = start;
+    glm::ivec3 v2 = start + uAxis * (width - 1) + vAxis * (height - 1);
+
+    if (face == Top || face == Right) {
+        std::swap(v1.z, v2.z);
+    } else if (face == Back) {
+        std::swap(v1.x, v2.x);
+    }
+
+    const glm::ivec3 pos1 = v1 + bottomLeft;
+    const glm::ivec3 pos2 = v2 + topRight;
+    glm::ivec3 pos3, pos4;
+
+    if (pos1.x == pos2.x) {
+        pos3 = {pos1.x, pos1.y, pos2.z};
+        pos4 = {pos1.x, pos2.y, pos1.z};
+    } else if (pos1.y == pos2.y) {
+        pos3 = {pos2.x, pos1.y, pos1.z};
+        pos4 = {pos1.x, pos1.y, pos2.z};
+    } else {
+        pos3 = {pos2.x, pos1.y, pos1.z};
+        pos4 = {pos1.x, pos2.y, pos1.z};
+    }
+
+    const bool isSideways = face == Left || face == Right;
+    const glm::ivec2 uv1 = glm::ivec2(0, 1) * (isSideways ? width : height);
+    const glm::ivec2 uv2 = glm::ivec2(1, 0) * (isSideways ? height : width);
+    const glm::ivec2 uv3 = {uv2.x, uv1.y};
+    const glm::ivec2 uv4 = {uv1.x, uv2.y};
+
+    out.addQuad({pos1, pos3, pos2, pos4}, {
+        IndexedMeshData::packNormalUvTex(face, uv1, sampler),
+        IndexedMeshData::packNormalUvTex(face, uv3, sampler),
+        IndexedMeshData::packNormalUvTex(face, uv2, sampler),
+        IndexedMeshData::packNormalUvTex(face, uv4, sampler),
+    });
+}
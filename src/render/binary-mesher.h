@@ -0,0 +1,83 @@
+#ifndef VOXEL_BINARY_MESHER_H
+#define VOXEL_BINARY_MESHER_H
+
+#include <array>
+
+#include "glm/glm.hpp"
+#include "src/voxel/block/block.h"
+#include "src/voxel/chunk/chunk.h"
+#include "src/utils/cube-array.h"
+
+/**
+ * Greedy mesher operating on bitmasks instead of individual faces.
+ *
+ * Solid blocks of a chunk are first gathered into bitmasks along each axis (called columns),
+ * from which visible faces are obtained using a couple of bitwise operations per column.
+ * Visible faces are then sorted into 2D bitmask planes (one per face direction, depth and texture)
+ * and greedily merged into rectangles directly on these planes. Merged quads are written straight
+ * into the output mesh data as packed vertices, without any intermediate per-face representation.
+ */
+class BinaryMesher {
+public:
+    using ColumnMask = glm::uint32;
+
+    // columns are padded with one bit on each end, which represent blocks of neighbouring chunks
+    static constexpr int PADDED_SIZE = Chunk::PADDED_SIZE;
+    static_assert(PADDED_SIZE <= 8 * sizeof(ColumnMask));
+
+    // max number of distinct textures the mesher can handle, limited by the size of `usedSamplers` bitmasks
+    static constexpr int MAX_SAMPLER_COUNT = 16;
+
+private:
+    /*
+     * `[axis][u][v]` holds the column of blocks along `axis`, positioned at the remaining two coordinates
+     * `u` and `v` (in this order, e.g. `[Y][x][z]`). bit `i + 1` is set iff the block at coordinate `i`
+     * along the axis is solid.
+     */
+    using ColumnGrid = std::array<std::array<std::array<ColumnMask, PADDED_SIZE>, PADDED_SIZE>, 3>;
+
+    /*
+     * `[sampler][depth][v]` holds a row of visible faces using a given texture, with bit `u` set iff
+     * the face at the given coordinates is visible. all faces in a plane face the same direction.
+     */
+    using PlaneGrid = std::array<
+        std::array<std::array<ColumnMask, Chunk::CHUNK_SIZE>, Chunk::CHUNK_SIZE>,
+        MAX_SAMPLER_COUNT
+    >;
+
+public:
+    /**
+     * Creates a mesh of the given blocks, writing it to the given mesh data.
+     *
+     * @param blocks Blocks of the meshed chunk, surrounded by blocks of its neighbours. Faces of the chunk's blocks
+     *               are culled against the neighbouring blocks, but no faces are made for the latter.
+     * @param origin Absolute coordinates of the block with the lowest coordinates. Vertex positions
+     *               in the resulting mesh are relative to it.
+     * @param samplers Table of samplers used by each face of each block type.
+     * @param out Mesh data to which the mesh should be appended.
+     */
+    static void createMesh(const Chunk::PaddedBlockArray &blocks, const glm::ivec3 &origin,
+                           const BlockSamplerTable &samplers, struct IndexedMeshData &out);
+
+private:
+    /**
+     * Finds all visible faces facing a given direction, merges them and writes the resulting quads to `out`.
+     */
+    static void meshFace(EBlockFace face, const ColumnGrid &columns, PlaneGrid &planes,
+                         const Chunk::PaddedBlockArray &blocks, const BlockSamplerTable &samplers,
+                         IndexedMeshData &out);
+
+    /**
+     * Writes a merged quad in the layout of `out`, either as 4 vertices and 6 indices, or as a single
+     * packed quad record.
+     *
+     * @param face Direction the quad is facing.
+     * @param start Chunk-relative coordinates of the block with the lowest coordinates covered by the quad.
+     * @param width Size of the quad along its first axis (`u`).
+     * @param height Size of the quad along its second axis (`v`).
+     */
+    static void emitQuad(EBlockFace face, const glm::ivec3 &start, int width, int height, int sampler,
+                         IndexedMeshData &out);
+};
+
+#endif //VOXEL_BINARY_MESHER_H
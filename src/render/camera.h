@@ -88,6 +88,17 @@ public:
     [[nodiscard]]
     glm::vec3 getPos() const { return pos; }
 
+    void setPos(const glm::vec3 &p) { pos = p; }
+
+    [[nodiscard]]
+    glm::vec2 getRotation() const { return rot; }
+
+    /**
+     * Sets the camera's yaw and pitch, in radians. Like when rotating with the mouse, the pitch is clamped
+     * so that the camera can't look further than straight up or down.
+     */
+    void setRotation(const glm::vec2 &r) { rot = {0, 0}; updateRotation(r.x, r.y); }
+
     [[nodiscard]]
     glm::mat4 getViewMatrix() const;
 
@@ -97,6 +108,12 @@ public:
     [[nodiscard]]
     glm::mat4 getProjectionMatrix() const;
 
+    [[nodiscard]]
+    float getNearPlane() const { return zNear; }
+
+    [[nodiscard]]
+    float getFarPlane() const { return zFar; }
+
     /**
      * Locks or unlocks the cursor. When the cursor is locked, it's confined to the center
      * of the screen and camera rotates according to its movement. When it's unlocked, it's
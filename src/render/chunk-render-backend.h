@@ -0,0 +1,67 @@
+#ifndef VOXEL_CHUNK_RENDER_BACKEND_H
+#define VOXEL_CHUNK_RENDER_BACKEND_H
+
+#include <vector>
+#include "glm/vec3.hpp"
+
+#include "mesh-context.h"
+#include "gl/gl-vao.h"
+#include "src/voxel/block/block.h"
+#include "src/voxel/chunk/chunk.h"
+
+/**
+ * Everything `ChunkManager` needs from a renderer: the camera's position and view frustum, and a place
+ * to which meshes of chunks are uploaded and from which they're drawn.
+ *
+ * `OpenGLRenderer` is the one actually drawing anything. Other implementations let chunks be streamed,
+ * generated and meshed without a window or a GPU, like `RecordingRenderBackend` does.
+ */
+class ChunkRenderBackend {
+public:
+    virtual ~ChunkRenderBackend() = default;
+
+    [[nodiscard]]
+    virtual glm::vec3 getCameraPos() const = 0;
+
+    [[nodiscard]]
+    virtual bool isChunkInFrustum(const Chunk &chunk) const = 0;
+
+    [[nodiscard]]
+    virtual bool shouldDrawShadows() const = 0;
+
+    /**
+     * Tells how many chunks away from the camera chunks are loaded, which bounds how far the renderer
+     * has to draw things like shadows.
+     */
+    virtual void setRenderDistance(int renderDistance) = 0;
+
+    /**
+     * @return Layout in which chunk meshes are currently stored. Whenever this changes, all chunk meshes
+     * are dropped and have to be written again.
+     */
+    [[nodiscard]]
+    virtual EChunkMeshLayout getChunkMeshLayout() const = 0;
+
+    /**
+     * @return Table of samplers used for each face of each block type, which ends up in chunk meshes.
+     */
+    [[nodiscard]]
+    virtual const BlockSamplerTable& getBlockSamplerTable() const = 0;
+
+    virtual void writeChunkMesh(Chunk::ChunkID id, const IndexedMeshData &mesh) = 0;
+
+    virtual void freeChunkMesh(Chunk::ChunkID id) = 0;
+
+    virtual void makeChunksShadowMap(const std::vector<Chunk::ChunkID> &targets) = 0;
+
+    virtual void renderChunks(const std::vector<Chunk::ChunkID> &targets) = 0;
+
+    /**
+     * Adds the outline of a loaded chunk to the lines rendered later.
+     *
+     * @param chunkPos The chunk's position, given by its vertex with the lowest coordinates.
+     */
+    virtual void addChunkOutline(const glm::ivec3 &chunkPos) = 0;
+};
+
+#endif //VOXEL_CHUNK_RENDER_BACKEND_H
@@ -38,12 +38,20 @@ void GLBuffer<T>::updateBufferCapacity(const size_t desiredCapacity) {
 }
 
 template<typename T>
-GLArrayBuffer<T>::GLArrayBuffer(const GLuint index, const GLint count) : bufferIndex(index), compCount(count) {
+GLArrayBuffer<T>::GLArrayBuffer(const GLuint index, const GLint count, const GLenum compType, const GLuint divisor)
+    : bufferIndex(index), compCount(count) {
     glGenBuffers(1, &this->bufferID);
     glBindBuffer(this->getGlTarget(), this->bufferID);
-    glVertexAttribPointer(bufferIndex, compCount, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+    if (compType == GL_FLOAT) {
+        glVertexAttribPointer(bufferIndex, compCount, compType, GL_FALSE, 0, nullptr);
+    } else {
+        glVertexAttribIPointer(bufferIndex, compCount, compType, 0, nullptr);
+    }
+
     glBufferData(this->getGlTarget(), this->BASE_CAPACITY * sizeof(T), nullptr, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(bufferIndex);
+    glVertexAttribDivisor(bufferIndex, divisor);
 }
 
 template<typename T>
@@ -93,6 +101,58 @@ void GLElementBuffer::enable() {
     glBindBuffer(getGlTarget(), bufferID);
 }
 
+template<typename T>
+GLShaderStorageBuffer<T>::GLShaderStorageBuffer(const GLuint binding) : bindingIndex(binding) {
+    glGenBuffers(1, &this->bufferID);
+    glBindBuffer(this->getGlTarget(), this->bufferID);
+    glBufferData(this->getGlTarget(), this->BASE_CAPACITY * sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+}
+
+template<typename T>
+void GLShaderStorageBuffer<T>::write(const T* data, const size_t count, const size_t offset) {
+    this->updateBufferCapacity(offset + count);
+    this->size = std::max(this->size, offset + count);
+
+    glBindBuffer(this->getGlTarget(), this->bufferID);
+    glBufferSubData(
+        this->getGlTarget(),
+        static_cast<GLsizeiptr>(offset * sizeof(T)),
+        static_cast<GLsizeiptr>(count * sizeof(T)),
+        data
+    );
+}
+
+template<typename T>
+void GLShaderStorageBuffer<T>::enable() {
+    glBindBufferBase(this->getGlTarget(), bindingIndex, this->bufferID);
+}
+
+template<typename T>
+GLDrawIndirectBuffer<T>::GLDrawIndirectBuffer() {
+    glGenBuffers(1, &this->bufferID);
+    glBindBuffer(this->getGlTarget(), this->bufferID);
+    glBufferData(this->getGlTarget(), this->BASE_CAPACITY * sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+}
+
+template<typename T>
+void GLDrawIndirectBuffer<T>::write(const T* data, const size_t count, const size_t offset) {
+    this->updateBufferCapacity(offset + count);
+    this->size = std::max(this->size, offset + count);
+
+    glBindBuffer(this->getGlTarget(), this->bufferID);
+    glBufferSubData(
+        this->getGlTarget(),
+        static_cast<GLsizeiptr>(offset * sizeof(T)),
+        static_cast<GLsizeiptr>(count * sizeof(T)),
+        data
+    );
+}
+
+template<typename T>
+void GLDrawIndirectBuffer<T>::enable() {
+    glBindBuffer(this->getGlTarget(), this->bufferID);
+}
+
 GLFrameBuffer::GLFrameBuffer() {
     glGenFramebuffers(1, &bufferID);
 }
@@ -167,8 +227,11 @@ template class GLBuffer<glm::vec3>;
 template class GLBuffer<glm::vec2>;
 template class GLBuffer<glm::ivec2>;
 template class GLBuffer<glm::uint32>;
+template class GLBuffer<glm::uvec2>;
 template class GLBuffer<unsigned short>;
 template class GLBuffer<int>;
+template class GLBuffer<GLDrawElementsCommand>;
+template class GLBuffer<GLDrawArraysCommand>;
 
 template class GLArrayBuffer<glm::uvec3>;
 template class GLArrayBuffer<glm::ivec3>;
@@ -176,4 +239,10 @@ template class GLArrayBuffer<glm::vec3>;
 template class GLArrayBuffer<glm::vec2>;
 template class GLArrayBuffer<glm::ivec2>;
 template class GLArrayBuffer<glm::uint32>;
+template class GLArrayBuffer<glm::uvec2>;
 template class GLArrayBuffer<int>;
+
+template class GLShaderStorageBuffer<glm::uint32>;
+
+template class GLDrawIndirectBuffer<GLDrawElementsCommand>;
+template class GLDrawIndirectBuffer<GLDrawArraysCommand>;
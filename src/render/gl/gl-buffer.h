@@ -30,6 +30,9 @@ public:
     [[nodiscard]]
     decltype(size) getSize() const { return size; }
 
+    [[nodiscard]]
+    decltype(capacity) getCapacity() const { return capacity; }
+
     /**
      * Writes the given data to the buffer, possibly reallocating it to contain all the data.
      *
@@ -68,7 +71,14 @@ class GLArrayBuffer final : public GLBuffer<T> {
     GLint compCount{};
 
 public:
-    GLArrayBuffer(GLuint index, GLint count);
+    /**
+     * @param index Index of the vertex attribute this buffer feeds.
+     * @param count Number of components per element.
+     * @param compType Type of a single component. Integer types are passed to the shader as integers.
+     * @param divisor Attribute divisor; a non-zero value makes the attribute advance per instance instead
+     *                of per vertex, which together with a draw's base instance gives a per-draw attribute.
+     */
+    GLArrayBuffer(GLuint index, GLint count, GLenum compType = GL_FLOAT, GLuint divisor = 0);
 
     void write(const T* data, size_t count, size_t offset) override;
 
@@ -105,6 +115,73 @@ protected:
     GLenum getGlTarget() const override { return GL_ELEMENT_ARRAY_BUFFER; }
 };
 
+/**
+ * A specialization over the GLBuffer class, using OpenGL's GL_SHADER_STORAGE_BUFFER type.
+ * Used for data which shaders fetch on their own instead of receiving it through vertex attributes.
+ *
+ * @tparam T Type of elements stored in the buffer.
+ */
+template<typename T>
+class GLShaderStorageBuffer final : public GLBuffer<T> {
+    GLuint bindingIndex{};
+
+public:
+    explicit GLShaderStorageBuffer(GLuint binding);
+
+    void write(const T* data, size_t count, size_t offset) override;
+
+    /**
+     * Binds the buffer to its binding point, making it visible to shaders as `layout(binding = ...)`.
+     */
+    void enable() override;
+
+protected:
+    [[nodiscard]]
+    GLenum getGlTarget() const override { return GL_SHADER_STORAGE_BUFFER; }
+};
+
+/**
+ * Layout of a single draw command read by `glMultiDrawElementsIndirect`.
+ */
+struct GLDrawElementsCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+/**
+ * Layout of a single draw command read by `glMultiDrawArraysIndirect`.
+ */
+struct GLDrawArraysCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint first;
+    GLuint baseInstance;
+};
+
+/**
+ * A specialization over the GLBuffer class, using OpenGL's GL_DRAW_INDIRECT_BUFFER type.
+ * Used for submitting many draw commands at once, with parameters which can't be passed
+ * through the regular multi-draw calls, like the base instance.
+ *
+ * @tparam T Type of the stored draw commands.
+ */
+template<typename T>
+class GLDrawIndirectBuffer final : public GLBuffer<T> {
+public:
+    GLDrawIndirectBuffer();
+
+    void write(const T* data, size_t count, size_t offset) override;
+
+    void enable() override;
+
+protected:
+    [[nodiscard]]
+    GLenum getGlTarget() const override { return GL_DRAW_INDIRECT_BUFFER; }
+};
+
 /**
  * This doesn't derive from GLBuffer mostly because we don't really expect a framebuffer
  * to use the same interface as the buffers above, since these expect to be directly written to,
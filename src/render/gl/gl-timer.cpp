@@ -0,0 +1,54 @@
+#include "gl-timer.h"
+
+GLTimer::GLTimer() {
+    glGenQueries(QUERY_COUNT, queryIDs.data());
+}
+
+GLTimer::~GLTimer() {
+    glDeleteQueries(QUERY_COUNT, queryIDs.data());
+}
+
+void GLTimer::begin() {
+    collectResults();
+
+    // every query is still waiting for the GPU, and reading any of them would stall
+    if (isPending[nextQuery]) {
+        skippedCount++;
+        runningQuery = std::nullopt;
+        return;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, queryIDs[nextQuery]);
+    runningQuery = nextQuery;
+}
+
+void GLTimer::end() {
+    if (!runningQuery) return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    isPending[*runningQuery] = true;
+    nextQuery = (*runningQuery + 1) % QUERY_COUNT;
+    runningQuery = std::nullopt;
+}
+
+void GLTimer::collectResults() {
+    // going from the oldest query, so that the last result read is the most recent one
+    for (size_t i = 0; i < QUERY_COUNT; i++) {
+        const size_t query = (nextQuery + i) % QUERY_COUNT;
+        if (!isPending[query]) continue;
+
+        GLint isAvailable = GL_FALSE;
+        glGetQueryObjectiv(queryIDs[query], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+
+        // queries finish in order, so none of the later ones can be available either
+        if (!isAvailable) break;
+
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(queryIDs[query], GL_QUERY_RESULT, &elapsedNs);
+        isPending[query] = false;
+
+        constexpr float smoothing = 0.95f;
+        lastMs = static_cast<float>(static_cast<double>(elapsedNs) / 1e6);
+        smoothedMs = smoothedMs * smoothing + lastMs * (1.0f - smoothing);
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef VOXEL_GL_TIMER_H
+#define VOXEL_GL_TIMER_H
+
+#include <array>
+#include <optional>
+#include "GL/glew.h"
+
+/**
+ * Measures how much time the GPU spends executing the commands issued between `begin` and `end`,
+ * using `GL_TIME_ELAPSED` queries.
+ *
+ * The GPU runs a few frames behind, so each measurement gets its own query out of a small ring,
+ * and its result is only read once it's available. This never makes the CPU wait for the GPU: if all
+ * queries are still in flight when a new measurement is started, that measurement is skipped instead.
+ * As only one `GL_TIME_ELAPSED` query may be active at once, measurements mustn't overlap.
+ */
+class GLTimer {
+    static constexpr size_t QUERY_COUNT = 3;
+
+    std::array<GLuint, QUERY_COUNT> queryIDs{};
+
+    // set for queries which were ended, but whose results weren't read yet
+    std::array<bool, QUERY_COUNT> isPending{};
+
+    // query used by the next measurement, which is also the oldest one if all of them are pending
+    size_t nextQuery = 0;
+
+    // query of the measurement between `begin` and `end`, if it wasn't skipped
+    std::optional<size_t> runningQuery;
+
+    float lastMs = 0.f;
+    float smoothedMs = 0.f;
+    size_t skippedCount = 0;
+
+public:
+    GLTimer();
+
+    ~GLTimer();
+
+    GLTimer(const GLTimer&) = delete;
+
+    GLTimer& operator=(const GLTimer&) = delete;
+
+    void begin();
+
+    void end();
+
+    /**
+     * Reads results of all finished measurements, without waiting for unfinished ones.
+     */
+    void collectResults();
+
+    /**
+     * @return GPU time of the latest measurement whose result is known, in milliseconds.
+     */
+    [[nodiscard]]
+    float getLastMs() const { return lastMs; }
+
+    /**
+     * @return Exponentially smoothed GPU time of past measurements, in milliseconds.
+     */
+    [[nodiscard]]
+    float getSmoothedMs() const { return smoothedMs; }
+
+    /**
+     * @return Number of measurements which were skipped, because the GPU was too far behind.
+     */
+    [[nodiscard]]
+    size_t getSkippedCount() const { return skippedCount; }
+
+    /**
+     * Measures the GPU time of everything issued during its lifetime.
+     */
+    class Scope {
+        GLTimer &timer;
+
+    public:
+        explicit Scope(GLTimer &t) : timer(t) { timer.begin(); }
+
+        ~Scope() { timer.end(); }
+
+        Scope(const Scope&) = delete;
+
+        Scope& operator=(const Scope&) = delete;
+    };
+};
+
+#endif //VOXEL_GL_TIMER_H
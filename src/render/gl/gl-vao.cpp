@@ -1,6 +1,7 @@
 #include "gl-vao.h"
 
 #include "../mesh-context.h"
+#include "src/utils/profiler.h"
 
 GLVertexArray::GLVertexArray() {
     glGenVertexArrays(1, &objectID);
@@ -15,65 +16,120 @@ void GLVertexArray::enable() {
     glBindVertexArray(objectID);
 }
 
-ChunksVertexArray::ChunksVertexArray() : posBuffer(std::make_unique<GLArrayBuffer<glm::ivec3> >(0, 3)),
-                                         normalUvTexBuffer(std::make_unique<GLArrayBuffer<glm::uint32> >(1, 1)),
-                                         indicesBuffer(std::make_unique<GLElementBuffer>()) {
+ChunksVertexArray::ChunksVertexArray()
+    : chunkOriginBuffer(std::make_unique<GLArrayBuffer<glm::ivec3> >(1, 3, GL_INT, 1)),
+      elementsCommandBuffer(std::make_unique<GLDrawIndirectBuffer<GLDrawElementsCommand> >()),
+      arraysCommandBuffer(std::make_unique<GLDrawIndirectBuffer<GLDrawArraysCommand> >()) {
     static_assert(MIN_SECTOR_SIZE % 3 == 0);
     static_assert(MIN_SECTOR_SIZE <= MAX_SECTOR_SIZE);
+    static_assert(sizeof(PackedVertex) == sizeof(glm::uvec2));
+    static_assert(sizeof(PackedQuad) == sizeof(glm::uint32));
+
+    createBuffers();
     glBindVertexArray(0);
 }
 
-void ChunksVertexArray::writeChunk(const Chunk::ChunkID chunkID, const IndexedMeshData &mesh) {
-    if (mesh.indices.empty()) return;
-
+void ChunksVertexArray::createBuffers() {
     glBindVertexArray(objectID);
 
-    const std::vector<glm::uint32> packedNormalUvTexData = mesh.packNormalUvTex();
+    vertexBuffer = std::make_unique<GLArrayBuffer<glm::uvec2> >(0, 2, GL_UNSIGNED_INT);
+    indicesBuffer = std::make_unique<GLElementBuffer>();
+    quadBuffer = std::make_unique<GLShaderStorageBuffer<glm::uint32> >(QUAD_BUFFER_BINDING);
 
-    const SectorLevel vertexSectorLevel = calcSectorLevel(mesh.vertices.size());
-    const SectorLevel indexSectorLevel = calcSectorLevel(mesh.indices.size());
+    if (meshLayout == ChunkMeshLayout_PulledQuads) {
+        // vertices are fetched by the shader itself, so there's no vertex attribute to be fed
+        vertexBuffer->disable();
+    }
+}
 
-    if (chunkSectorMapping.contains(chunkID)) {
-        auto& [vertexSector, indexSector] = chunkSectorMapping.at(chunkID);
+void ChunksVertexArray::setMeshLayout(const EChunkMeshLayout layout) {
+    if (layout == meshLayout) return;
 
-        if (vertexSectorLevel == vertexSector.level && indexSectorLevel == indexSector.level) {
-            vertexSector.size = mesh.vertices.size();
-            indexSector.size = mesh.indices.size();
+    meshLayout = layout;
 
-            const size_t vertexAbsOffset = vertexSector.slabID * SLAB_SIZE + vertexSector.offset;
-            const size_t indexAbsOffset = indexSector.slabID * SLAB_SIZE + indexSector.offset;
+    vertexSlabsState = {};
+    indexSlabsState = {};
+    chunkSectorMapping.clear();
 
-            posBuffer->write(mesh.vertices.data(), vertexSector.size, vertexAbsOffset);
-            normalUvTexBuffer->write(packedNormalUvTexData.data(), vertexSector.size, vertexAbsOffset);
-            indicesBuffer->write(mesh.indices.data(), indexSector.size, indexAbsOffset);
+    // recreating the buffers also releases the memory used by the previous layout
+    createBuffers();
+}
 
-            return;
-        }
+size_t ChunksVertexArray::getAllocatedBytes() const {
+    return vertexBuffer->getCapacity() * sizeof(glm::uvec2)
+           + indicesBuffer->getCapacity() * sizeof(GLElementBuffer::ElemType)
+           + quadBuffer->getCapacity() * sizeof(glm::uint32);
+}
+
+void ChunksVertexArray::writeChunk(const Chunk::ChunkID chunkID, const IndexedMeshData &mesh) {
+    VOXEL_PROFILE_SCOPE("ChunksVertexArray::writeChunk");
+
+    const bool isPulled = meshLayout == ChunkMeshLayout_PulledQuads;
+    const size_t vertexCount = isPulled ? mesh.quads.size() : mesh.vertices.size();
+
+    // an empty mesh doesn't need any space, but whatever was written for the chunk before has to be dropped
+    if (vertexCount == 0) {
+        eraseChunk(chunkID);
+        return;
+    }
+
+    glBindVertexArray(objectID);
 
-        // todo - don't reclaim both if only one doesn't match
-        vertexSlabsState.reclaimSector(vertexSector);
-        indexSlabsState.reclaimSector(indexSector);
-        chunkSectorMapping.erase(chunkID);
+    const SectorLevel vertexSectorLevel = calcSectorLevel(vertexCount);
+    const std::optional<SectorLevel> indexSectorLevel = isPulled
+                                                            ? std::nullopt
+                                                            : std::optional(calcSectorLevel(mesh.indices.size()));
+
+    if (chunkSectorMapping.contains(chunkID)) {
+        const auto& [vertexSector, indexSector, _] = chunkSectorMapping.at(chunkID);
+
+        const std::optional<SectorLevel> currIndexSectorLevel = indexSector
+                                                                    ? std::optional(indexSector->level)
+                                                                    : std::nullopt;
+        const bool doSectorsFit = vertexSectorLevel == vertexSector.level && indexSectorLevel == currIndexSectorLevel;
+
+        if (!doSectorsFit) {
+            // todo - don't reclaim both if only one doesn't match
+            vertexSlabsState.reclaimSector(vertexSector);
+            if (indexSector) indexSlabsState.reclaimSector(*indexSector);
+            chunkSectorMapping.erase(chunkID);
+        }
     }
 
-    SectorData vertexSector = vertexSlabsState.requestNewSector(vertexSectorLevel);
-    SectorData indexSector = indexSlabsState.requestNewSector(indexSectorLevel);
+    if (!chunkSectorMapping.contains(chunkID)) {
+        const ChunkSectorsData newSectorsData{
+            .vertexSector = vertexSlabsState.requestNewSector(vertexSectorLevel),
+            .indexSector = indexSectorLevel
+                               ? std::optional(indexSlabsState.requestNewSector(*indexSectorLevel))
+                               : std::nullopt,
+            .origin = mesh.origin
+        };
+        chunkSectorMapping.emplace(chunkID, newSectorsData);
+    }
 
-    vertexSector.size = mesh.vertices.size();
-    indexSector.size = mesh.indices.size();
+    auto& [vertexSector, indexSector, origin] = chunkSectorMapping.at(chunkID);
 
+    origin = mesh.origin;
+    vertexSector.size = vertexCount;
     const size_t vertexAbsOffset = vertexSector.slabID * SLAB_SIZE + vertexSector.offset;
-    const size_t indexAbsOffset = indexSector.slabID * SLAB_SIZE + indexSector.offset;
 
-    posBuffer->write(mesh.vertices.data(), vertexSector.size, vertexAbsOffset);
-    normalUvTexBuffer->write(packedNormalUvTexData.data(), vertexSector.size, vertexAbsOffset);
-    indicesBuffer->write(mesh.indices.data(), indexSector.size, indexAbsOffset);
+    if (isPulled) {
+        quadBuffer->write(mesh.quads.data(), vertexSector.size, vertexAbsOffset);
+        return;
+    }
+
+    indexSector->size = mesh.indices.size();
+    const size_t indexAbsOffset = indexSector->slabID * SLAB_SIZE + indexSector->offset;
 
-    const ChunkSectorsData newSectorsData{
-        .vertexSector = vertexSector,
-        .indexSector = indexSector
-    };
-    chunkSectorMapping.emplace(chunkID, newSectorsData);
+    vertexBuffer->write(mesh.vertices.data(), vertexSector.size, vertexAbsOffset);
+    indicesBuffer->write(mesh.indices.data(), indexSector->size, indexAbsOffset);
+}
+
+std::optional<glm::ivec3> ChunksVertexArray::getChunkOrigin(const Chunk::ChunkID chunkID) const {
+    const auto it = chunkSectorMapping.find(chunkID);
+    if (it == chunkSectorMapping.end()) return std::nullopt;
+
+    return it->second.origin;
 }
 
 void ChunksVertexArray::eraseChunk(const Chunk::ChunkID chunkID) {
@@ -81,46 +137,100 @@ void ChunksVertexArray::eraseChunk(const Chunk::ChunkID chunkID) {
         return;
     }
 
-    const auto &[vertexSector, indexSector] = chunkSectorMapping.at(chunkID);
+    const auto &[vertexSector, indexSector, _] = chunkSectorMapping.at(chunkID);
 
     vertexSlabsState.reclaimSector(vertexSector);
-    indexSlabsState.reclaimSector(indexSector);
+    if (indexSector) indexSlabsState.reclaimSector(*indexSector);
+    chunkSectorMapping.erase(chunkID);
 }
 
 void ChunksVertexArray::render(const std::vector<Chunk::ChunkID> &targets) const {
-    std::vector<GLsizei> counts;
-    std::vector<void *> indexOffsets;
-    std::vector<GLint> baseIndices;
-    size_t actualTargetCount = 0;
+    VOXEL_PROFILE_SCOPE("ChunksVertexArray::render");
+
+    if (meshLayout == ChunkMeshLayout_PulledQuads) {
+        renderPulledQuads(targets);
+    } else {
+        renderIndexed(targets);
+    }
+}
+
+void ChunksVertexArray::renderIndexed(const std::vector<Chunk::ChunkID> &targets) const {
+    std::vector<GLDrawElementsCommand> commands;
+    std::vector<glm::ivec3> origins;
 
     for (const Chunk::ChunkID target: targets) {
         if (!chunkSectorMapping.contains(target)) {
             continue;
         }
 
-        const auto &[vertexSector, indexSector] = chunkSectorMapping.at(target);
+        const auto &[vertexSector, indexSector, origin] = chunkSectorMapping.at(target);
 
         const off_t vertexOffset = static_cast<off_t>(vertexSector.slabID * SLAB_SIZE) + vertexSector.offset;
-        const off_t indexOffset = static_cast<off_t>(indexSector.slabID * SLAB_SIZE) + indexSector.offset;
-
-        counts.push_back(static_cast<GLsizei>(indexSector.size));
-        indexOffsets.push_back(reinterpret_cast<void *>(indexOffset * sizeof(GLElementBuffer::ElemType)));
-        baseIndices.push_back(static_cast<GLint>(vertexOffset));
-        actualTargetCount++;
+        const off_t indexOffset = static_cast<off_t>(indexSector->slabID * SLAB_SIZE) + indexSector->offset;
+
+        commands.push_back({
+            .count = static_cast<GLuint>(indexSector->size),
+            .instanceCount = 1,
+            .firstIndex = static_cast<GLuint>(indexOffset),
+            .baseVertex = static_cast<GLint>(vertexOffset),
+            .baseInstance = static_cast<GLuint>(origins.size()),
+        });
+        origins.push_back(origin);
     }
 
-    glMultiDrawElementsBaseVertex(
+    if (commands.empty()) return;
+
+    chunkOriginBuffer->write(origins.data(), origins.size(), 0);
+    elementsCommandBuffer->write(commands.data(), commands.size(), 0);
+    elementsCommandBuffer->enable();
+
+    glMultiDrawElementsIndirect(
         GL_TRIANGLES,
-        counts.data(),
         GLElementBuffer::getGlElemType(),
-        indexOffsets.data(),
-        static_cast<GLsizei>(actualTargetCount),
-        baseIndices.data()
+        nullptr,
+        static_cast<GLsizei>(commands.size()),
+        0
     );
 }
 
+void ChunksVertexArray::renderPulledQuads(const std::vector<Chunk::ChunkID> &targets) const {
+    constexpr GLuint verticesPerQuad = IndexedMeshData::QUAD_INDEX_PATTERN.size();
+
+    std::vector<GLDrawArraysCommand> commands;
+    std::vector<glm::ivec3> origins;
+
+    for (const Chunk::ChunkID target: targets) {
+        if (!chunkSectorMapping.contains(target)) {
+            continue;
+        }
+
+        const auto &[quadSector, _, origin] = chunkSectorMapping.at(target);
+
+        const off_t quadOffset = static_cast<off_t>(quadSector.slabID * SLAB_SIZE) + quadSector.offset;
+
+        // `gl_VertexID` includes `first`, so the shader can find the quad by dividing it by `verticesPerQuad`
+        commands.push_back({
+            .count = verticesPerQuad * static_cast<GLuint>(quadSector.size),
+            .instanceCount = 1,
+            .first = verticesPerQuad * static_cast<GLuint>(quadOffset),
+            .baseInstance = static_cast<GLuint>(origins.size()),
+        });
+        origins.push_back(origin);
+    }
+
+    if (commands.empty()) return;
+
+    chunkOriginBuffer->write(origins.data(), origins.size(), 0);
+    arraysCommandBuffer->write(commands.data(), commands.size(), 0);
+    arraysCommandBuffer->enable();
+    quadBuffer->enable();
+
+    glMultiDrawArraysIndirect(GL_TRIANGLES, nullptr, static_cast<GLsizei>(commands.size()), 0);
+}
+
 ChunksVertexArray::SectorLevel ChunksVertexArray::calcSectorLevel(const size_t dataSize) {
-    return SizeUtils::log(2, dataSize / 3);
+    // round up, so that the sector can always fit all the data
+    return SizeUtils::log(2, (dataSize + MIN_SECTOR_SIZE - 1) / MIN_SECTOR_SIZE);
 }
 
 size_t ChunksVertexArray::calcSectorSize(const SectorLevel level) {
@@ -31,6 +31,16 @@ public:
     virtual void enable();
 };
 
+/**
+ * Ways in which chunk meshes can be stored on the GPU.
+ */
+enum EChunkMeshLayout {
+    // 4 packed vertices and 6 indices per quad, drawn with an index buffer
+    ChunkMeshLayout_Indexed,
+    // a single packed record per quad, expanded into vertices by the shader using `gl_VertexID`
+    ChunkMeshLayout_PulledQuads,
+};
+
 /**
  * Specialization of the GLVertexArray class, used for the purpose of holding all the data
  * relevant for meshes of all chunks, held in one VAO.
@@ -43,10 +53,22 @@ public:
  * slab can fulfill the request, we allocate a new slab for this purpose.
  */
 class ChunksVertexArray final : public GLVertexArray {
-    std::unique_ptr<GLArrayBuffer<glm::ivec3>> posBuffer;
-    std::unique_ptr<GLArrayBuffer<glm::uint32>> normalUvTexBuffer;
+    EChunkMeshLayout meshLayout = ChunkMeshLayout_Indexed;
+
+    // packed, chunk-relative vertices (see `PackedVertex`), used by the indexed layout
+    std::unique_ptr<GLArrayBuffer<glm::uvec2>> vertexBuffer;
     std::unique_ptr<GLElementBuffer> indicesBuffer;
 
+    // packed quads (see `PackedQuad`), used by the pulled quads layout
+    std::unique_ptr<GLShaderStorageBuffer<glm::uint32>> quadBuffer;
+    static constexpr GLuint QUAD_BUFFER_BINDING = 0;
+
+    // per-draw data, rewritten on every render. each draw's base instance points to its chunk's origin,
+    // which is how the shader learns where to put the chunk-relative vertices
+    std::unique_ptr<GLArrayBuffer<glm::ivec3>> chunkOriginBuffer;
+    std::unique_ptr<GLDrawIndirectBuffer<GLDrawElementsCommand>> elementsCommandBuffer;
+    std::unique_ptr<GLDrawIndirectBuffer<GLDrawArraysCommand>> arraysCommandBuffer;
+
     // min number of indices in a non-empty chunk is 3, because there are 3 indices in just one triangle.
     // realistically this is actually 36, because a minimal non-empty chunk has 1 block which has 6 faces,
     // thus 36 indices.
@@ -115,9 +137,9 @@ class ChunksVertexArray final : public GLVertexArray {
     };
 
     /**
-     * As all information about vertices (position, normal, UV, texID) is always grouped
-     * in a way that their respective buffers always hold the same number of elements,
-     * we allocate slabs and sectors for these pieces of data uniformly. Indices, however,
+     * As all information about vertices (position, normal, UV, texID) is packed together
+     * into a single buffer, there is only one set of slabs and sectors for vertices. With the pulled
+     * quads layout, the same slabs are used for allocating quads instead, and indices aren't needed. Indices, however,
      * differ in this regard so all allocation regarding the indices buffer is performed
      * separately.
      */
@@ -128,7 +150,9 @@ class ChunksVertexArray final : public GLVertexArray {
      * a given chunk.
      */
     struct ChunkSectorsData {
-        SectorData vertexSector, indexSector;
+        SectorData vertexSector;
+        std::optional<SectorData> indexSector;
+        glm::ivec3 origin;
     };
 
     std::unordered_map<Chunk::ChunkID, ChunkSectorsData> chunkSectorMapping;
@@ -140,9 +164,39 @@ public:
 
     void eraseChunk(Chunk::ChunkID chunkID);
 
+    /**
+     * @return Origin of the currently stored mesh of a given chunk, if there is one.
+     */
+    [[nodiscard]]
+    std::optional<glm::ivec3> getChunkOrigin(Chunk::ChunkID chunkID) const;
+
     void render(const std::vector<Chunk::ChunkID>& targets) const;
 
+    [[nodiscard]]
+    EChunkMeshLayout getMeshLayout() const { return meshLayout; }
+
+    /**
+     * Switches the layout in which chunk meshes are stored. This drops all currently stored meshes,
+     * so they have to be written again afterwards.
+     */
+    void setMeshLayout(EChunkMeshLayout layout);
+
+    /**
+     * @return Number of bytes of GPU memory currently allocated for chunk meshes.
+     */
+    [[nodiscard]]
+    size_t getAllocatedBytes() const;
+
 private:
+    /**
+     * (Re)creates all buffers needed by the current mesh layout, with their minimal sizes.
+     */
+    void createBuffers();
+
+    void renderIndexed(const std::vector<Chunk::ChunkID>& targets) const;
+
+    void renderPulledQuads(const std::vector<Chunk::ChunkID>& targets) const;
+
     [[nodiscard]]
     static SectorLevel calcSectorLevel(size_t dataSize);
 
@@ -1,33 +1,100 @@
 #include "mesh-context.h"
 
+#include <bit>
 #include <iostream>
+#include <limits>
 
 #include "gl/gl-vao.h"
 
-std::vector<glm::uint32> IndexedMeshData::packNormalUvTex() const {
-    std::vector<glm::uint32> packedData;
+void IndexedMeshData::clear() {
+    origin = {};
+    vertices.clear();
+    indices.clear();
+    quads.clear();
+}
 
-    for (size_t i = 0; i < vertices.size(); i++) {
-        glm::uint32 packedVertex = 0;
+void IndexedMeshData::addQuad(const std::array<glm::ivec3, 4> &positions, const std::array<glm::uint32, 4> &packed) {
+    if (vertices.size() + 4 > std::numeric_limits<GLElementBuffer::ElemType>::max()) {
+        throw std::runtime_error("Detected overflow during mesh indexing. Please use a larger type for indices");
+    }
 
-        const glm::uint32 faceIndex = getFaceIndex(getFaceFromNormal(normals[i]));
-        packedVertex |= (faceIndex & 0x7) << 29;
+    const auto baseIndex = static_cast<GLElementBuffer::ElemType>(vertices.size());
 
-        packedVertex |= (static_cast<glm::uint32>(uvs[i].x) & 0x1F) << 24;
-        packedVertex |= (static_cast<glm::uint32>(uvs[i].y) & 0x1F) << 19;
+    for (size_t i = 0; i < 4; i++) {
+        vertices.emplace_back(packPosition(positions[i]), packed[i]);
+    }
 
-        packedVertex |= static_cast<glm::uint32>(texIDs[i]) & 0xFF;
+    for (const auto index: QUAD_INDEX_PATTERN) {
+        indices.push_back(baseIndex + index);
+    }
+}
 
-        packedData.push_back(packedVertex);
+PackedQuad IndexedMeshData::packQuad(const EBlockFace face, const glm::ivec3 &start, const int width,
+                                     const int height, const int texID) {
+    const bool isInChunk = VecUtils::all<int>(start, [](const int c) { return c >= 0 && c < Chunk::CHUNK_SIZE; });
+
+    if (!isInChunk || width < 1 || width > Chunk::CHUNK_SIZE || height < 1 || height > Chunk::CHUNK_SIZE) {
+        throw std::runtime_error("quad doesn't fit in its chunk in IndexedMeshData::packQuad()");
     }
 
-    return packedData;
+    PackedQuad packedQuad = 0;
+
+    packedQuad |= static_cast<glm::uint32>(start.x);
+    packedQuad |= static_cast<glm::uint32>(start.y) << 4;
+    packedQuad |= static_cast<glm::uint32>(start.z) << 8;
+
+    packedQuad |= getFaceIndex(face) << 12;
+
+    packedQuad |= static_cast<glm::uint32>(width - 1) << 15;
+    packedQuad |= static_cast<glm::uint32>(height - 1) << 19;
+
+    packedQuad |= (static_cast<glm::uint32>(texID) & 0xFF) << 23;
+
+    return packedQuad;
+}
+
+glm::uint32 IndexedMeshData::packPosition(const glm::ivec3 &relPos) {
+    const bool isInChunk = VecUtils::all<int>(relPos, [](const int c) { return c >= 0 && c <= Chunk::CHUNK_SIZE; });
+
+    if (!isInChunk) {
+        throw std::runtime_error("vertex position outside of its chunk in IndexedMeshData::packPosition()");
+    }
+
+    return static_cast<glm::uint32>(relPos.x)
+           | static_cast<glm::uint32>(relPos.y) << POSITION_BITS
+           | static_cast<glm::uint32>(relPos.z) << 2 * POSITION_BITS;
+}
+
+glm::ivec3 IndexedMeshData::unpackPosition(const glm::uint32 packedPos) {
+    constexpr glm::uint32 mask = (1u << POSITION_BITS) - 1;
+
+    return {
+        packedPos & mask,
+        (packedPos >> POSITION_BITS) & mask,
+        (packedPos >> 2 * POSITION_BITS) & mask
+    };
+}
+
+glm::uint32 IndexedMeshData::packNormalUvTex(const EBlockFace face, const glm::ivec2 &uv, const int texID) {
+    glm::uint32 packedVertex = 0;
+
+    packedVertex |= (getFaceIndex(face) & 0x7) << 29;
+
+    packedVertex |= (static_cast<glm::uint32>(uv.x) & 0x1F) << 24;
+    packedVertex |= (static_cast<glm::uint32>(uv.y) & 0x1F) << 19;
+
+    packedVertex |= static_cast<glm::uint32>(texID) & 0xFF;
+
+    return packedVertex;
 }
 
 void ChunkMeshContext::clear() {
     quads.clear();
     triangles.clear();
-    indexedData = {};
+
+    if (indexedData) {
+        indexedData->clear();
+    }
 }
 
 void ChunkMeshContext::addQuad(const Vertex &min, const Vertex &max) {
@@ -39,77 +106,165 @@ void ChunkMeshContext::addTriangle(const Vertex &vertex1, const Vertex &vertex2,
     triangles.emplace_back(vertex1, vertex2, vertex3);
 }
 
-static void indexVertex(const Vertex &vertex, IndexedMeshData &data,
-                        std::map<Vertex, GLElementBuffer::ElemType> &vertexToOutIndex) {
-    const auto it = vertexToOutIndex.find(vertex);
+IndexedMeshData& ChunkMeshContext::resetIndexedData() {
+    if (!indexedData) {
+        indexedData = IndexedMeshData();
+    }
+
+    indexedData->clear();
+    indexedData->layout = layout;
+    return *indexedData;
+}
+
+void ChunkMeshContext::makeIndexed() {
+    IndexedMeshData &data = resetIndexedData();
+    data.origin = modelTranslate;
 
-    if (it != vertexToOutIndex.end()) {
-        // A similar vertex is already indexed, use that index instead!
-        data.indices.push_back(it->second);
+    data.vertices.reserve(4 * quads.size() + 3 * triangles.size());
+    data.quads.reserve(quads.size());
+    data.indices.reserve(6 * quads.size() + 3 * triangles.size());
 
-    } else {
-        // If not, it needs to be added.
-        data.vertices.push_back(vertex.position);
-        data.uvs.push_back(vertex.uv);
-        data.normals.push_back(vertex.normal);
-        data.texIDs.push_back(vertex.texSamplerID);
+    for (const auto &quad: quads) {
+        const auto corners = getQuadCorners(quad);
+        const EBlockFace face = getFaceFromNormal(corners[0].normal);
 
-        if (data.vertices.size() - 1 >= std::numeric_limits<GLElementBuffer::ElemType>::max()) {
-            throw std::runtime_error("Detected overflow during mesh indexing. Please use a larger type for indices");
+        std::array<glm::ivec3, 4> positions{};
+        std::array<glm::uint32, 4> packed{};
+
+        for (size_t i = 0; i < 4; i++) {
+            positions[i] = corners[i].position - data.origin;
+            packed[i] = IndexedMeshData::packNormalUvTex(face, corners[i].uv, corners[i].texSamplerID);
         }
 
-        const auto newIndex = static_cast<GLElementBuffer::ElemType>(data.vertices.size() - 1);
-        data.indices.push_back(newIndex);
-        vertexToOutIndex.emplace(vertex, newIndex);
+        data.addQuad(positions, packed);
+
+        // recover the quad's size from the extent of its corners. the corner with the lowest coordinates lies
+        // on the covered blocks' far side for positive faces, so it has to be moved back to get the start block
+        glm::ivec3 minCorner = positions[0], maxCorner = positions[0];
+        for (const glm::ivec3 &position: positions) {
+            minCorner = glm::min(minCorner, position);
+            maxCorner = glm::max(maxCorner, position);
+        }
+
+        const glm::ivec3 extent = maxCorner - minCorner;
+        const glm::ivec3 normal = getNormalFromFace(face);
+        const bool isPositive = face == Right || face == Top || face == Front;
+
+        const int width = extent.x != 0 ? extent.x : extent.y;
+        const int height = extent.z != 0 ? extent.z : extent.y;
+
+        data.quads.push_back(IndexedMeshData::packQuad(
+            face, minCorner - (isPositive ? normal : glm::ivec3(0)), width, height, corners[0].texSamplerID
+        ));
+    }
+
+    if (!triangles.empty()) {
+        indexTriangles();
     }
 }
 
-void ChunkMeshContext::makeIndexed() {
-    indexedData = IndexedMeshData();
-    std::map<Vertex, GLElementBuffer::ElemType> vertexToOutIndex;
+static size_t hashVertex(const PackedVertex &vertex) {
+    const std::uint64_t key = static_cast<std::uint64_t>(vertex.x) << 32 | vertex.y;
+    const std::uint64_t hash = key * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+void ChunkMeshContext::indexTriangles() {
+    using ElemType = GLElementBuffer::ElemType;
+    static constexpr ElemType EMPTY_SLOT = std::numeric_limits<ElemType>::max();
+
+    IndexedMeshData &data = *indexedData;
+
+    // keeping the load factor at or below 1/2 keeps the linear probing sequences short
+    const size_t slotCount = std::bit_ceil(std::max<size_t>(16, 2 * 3 * triangles.size()));
+    const size_t slotMask = slotCount - 1;
+    vertexSlots.assign(slotCount, EMPTY_SLOT);
+
+    const auto indexVertex = [&](const Vertex &vertex) {
+        const PackedVertex packed = {
+            IndexedMeshData::packPosition(vertex.position - data.origin),
+            IndexedMeshData::packNormalUvTex(getFaceFromNormal(vertex.normal), vertex.uv, vertex.texSamplerID)
+        };
+
+        size_t slot = hashVertex(packed) & slotMask;
+
+        while (vertexSlots[slot] != EMPTY_SLOT) {
+            const ElemType index = vertexSlots[slot];
+
+            if (data.vertices[index] == packed) {
+                // A similar vertex is already indexed, use that index instead!
+                data.indices.push_back(index);
+                return;
+            }
+
+            slot = (slot + 1) & slotMask;
+        }
+
+        // If not, it needs to be added.
+        if (data.vertices.size() >= EMPTY_SLOT) {
+            throw std::runtime_error("Detected overflow during mesh indexing. Please use a larger type for indices");
+        }
+
+        const auto newIndex = static_cast<ElemType>(data.vertices.size());
+        data.vertices.push_back(packed);
+        data.indices.push_back(newIndex);
+        vertexSlots[slot] = newIndex;
+    };
 
     for (const auto &[v1, v2, v3]: triangles) {
-        indexVertex(v1, *indexedData, vertexToOutIndex);
-        indexVertex(v2, *indexedData, vertexToOutIndex);
-        indexVertex(v3, *indexedData, vertexToOutIndex);
+        indexVertex(v1);
+        indexVertex(v2);
+        indexVertex(v3);
     }
 }
 
-void ChunkMeshContext::triangulateQuads() {
-    for (auto &[v1, v2]: quads) {
-        Vertex v3 = {
-            .position = {},
-            .uv = {v2.uv.x, v1.uv.y},
-            .normal = v1.normal,
-            .texSamplerID = v1.texSamplerID,
-        };
+std::array<Vertex, 4> ChunkMeshContext::getQuadCorners(const Quad &quad) {
+    const auto &[v1, v2] = quad;
 
-        Vertex v4 = {
-            .position = {},
-            .uv = {v1.uv.x, v2.uv.y},
-            .normal = v1.normal,
-            .texSamplerID = v1.texSamplerID,
-        };
+    Vertex v3 = {
+        .position = {},
+        .uv = {v2.uv.x, v1.uv.y},
+        .normal = v1.normal,
+        .texSamplerID = v1.texSamplerID,
+    };
+
+    Vertex v4 = {
+        .position = {},
+        .uv = {v1.uv.x, v2.uv.y},
+        .normal = v1.normal,
+        .texSamplerID = v1.texSamplerID,
+    };
 
-        if (v1.position.x == v2.position.x) {
-            v3.position = {v1.position.x, v1.position.y, v2.position.z};
-            v4.position = {v1.position.x, v2.position.y, v1.position.z};
+    if (v1.position.x == v2.position.x) {
+        v3.position = {v1.position.x, v1.position.y, v2.position.z};
+        v4.position = {v1.position.x, v2.position.y, v1.position.z};
 
-        } else if (v1.position.y == v2.position.y) {
-            v3.position = {v2.position.x, v1.position.y, v1.position.z};
-            v4.position = {v1.position.x, v1.position.y, v2.position.z};
+    } else if (v1.position.y == v2.position.y) {
+        v3.position = {v2.position.x, v1.position.y, v1.position.z};
+        v4.position = {v1.position.x, v1.position.y, v2.position.z};
 
-        } else if (v1.position.z == v2.position.z) {
-            v3.position = {v2.position.x, v1.position.y, v1.position.z};
-            v4.position = {v1.position.x, v2.position.y, v1.position.z};
+    } else if (v1.position.z == v2.position.z) {
+        v3.position = {v2.position.x, v1.position.y, v1.position.z};
+        v4.position = {v1.position.x, v2.position.y, v1.position.z};
 
-        } else {
-            throw std::runtime_error("invalid axis alignment in triangulateQuads()");
-        }
+    } else {
+        throw std::runtime_error("invalid axis alignment in getQuadCorners()");
+    }
+
+    return {v1, v3, v2, v4};
+}
+
+void ChunkMeshContext::triangulateQuads() {
+    for (const auto &quad: quads) {
+        const auto corners = getQuadCorners(quad);
+        const auto &pattern = IndexedMeshData::QUAD_INDEX_PATTERN;
 
-        triangles.emplace_back(v1, v3, v2);
-        triangles.emplace_back(v1, v2, v4);
+        triangles.emplace_back(corners[pattern[0]], corners[pattern[1]], corners[pattern[2]]);
+        triangles.emplace_back(corners[pattern[3]], corners[pattern[4]], corners[pattern[5]]);
     }
+
+    // the quads are now represented by the triangles, keeping them would make `makeIndexed` emit them twice
+    quads.clear();
 }
 
 void ChunkMeshContext::mergeQuads() {
@@ -1,13 +1,13 @@
 #ifndef VOXEL_MESH_CONTEXT_H
 #define VOXEL_MESH_CONTEXT_H
 
+#include <array>
 #include <vector>
-#include <cstring>
-#include <map>
 #include <memory>
 #include <optional>
 
 #include "gl/gl-buffer.h"
+#include "gl/gl-vao.h"
 #include "glm/glm.hpp"
 #include "src/voxel/chunk/chunk.h"
 
@@ -19,24 +19,87 @@ struct Vertex {
     glm::ivec2 uv;
     glm::vec3 normal;
     int texSamplerID;
-
-    bool operator<(const Vertex other) const {
-        return memcmp(this, &other, sizeof(Vertex)) > 0;
-    }
 };
 
+/**
+ * A single vertex of a chunk mesh, packed into 64 bits in the same form as it's uploaded to the GPU.
+ * `x` holds the vertex' position relative to the chunk's origin (see `IndexedMeshData::packPosition`),
+ * `y` holds its normal, UV and texture ID (see `IndexedMeshData::packNormalUvTex`).
+ */
+using PackedVertex = glm::uvec2;
+
+/**
+ * A whole quad packed into 32 bits, used when rendering by vertex pulling (see `packQuad` for the layout).
+ * The shader expands it into the same 4 vertices as the ones the indexed layout stores explicitly.
+ */
+using PackedQuad = glm::uint32;
+
 /**
  * Structure holding all data describing a mesh after indexing has been performed on it.
+ * Vertices are kept packed and relative to `origin`, so that a single vertex only takes up 8 bytes;
+ * the origin itself is supplied to the shader separately, once per chunk.
  */
 struct IndexedMeshData {
-    std::vector<glm::ivec3> vertices;
-    std::vector<glm::ivec2> uvs;
-    std::vector<glm::vec3> normals;
-    std::vector<int> texIDs;
+    glm::ivec3 origin{};
+    std::vector<PackedVertex> vertices;
     std::vector<GLElementBuffer::ElemType> indices;
 
+    // the same mesh as described by `vertices` and `indices`, but with every quad stored as a single record
+    std::vector<PackedQuad> quads;
+
+    // layout in which the mesh is going to be uploaded. the binary mesher fills only the data it needs,
+    // i.e. either `vertices` and `indices`, or `quads`
+    EChunkMeshLayout layout = ChunkMeshLayout_Indexed;
+
+    /**
+     * Index pattern shared by all quads, relative to the first of their 4 vertices.
+     * Splits the quad into triangles `(0, 1, 2)` and `(0, 2, 3)`.
+     */
+    static constexpr std::array<GLElementBuffer::ElemType, 6> QUAD_INDEX_PATTERN = {0, 1, 2, 0, 2, 3};
+
+    // number of bits used for each coordinate of a packed position. coordinates range over `[0, CHUNK_SIZE]`,
+    // as vertices on the far side of a chunk lie exactly on its boundary
+    static constexpr int POSITION_BITS = 5;
+    static_assert(Chunk::CHUNK_SIZE < (1 << POSITION_BITS));
+
+    void clear();
+
+    /**
+     * Appends a quad as 4 unique vertices, indexed using `QUAD_INDEX_PATTERN`.
+     *
+     * @param positions Positions of the quad's corners, relative to `origin`.
+     * @param packed Normals, UVs and texture IDs of the quad's corners, packed using `packNormalUvTex`.
+     */
+    void addQuad(const std::array<glm::ivec3, 4> &positions, const std::array<glm::uint32, 4> &packed);
+
+    /**
+     * Packs a quad into a single 32-bit word, as expected by the vertex pulling cube shader. Layout, from
+     * the least significant bit: 3 x 4 bits of `start`, 3 bits of face index, 4 bits of `width - 1`,
+     * 4 bits of `height - 1`, 8 bits of texture ID.
+     *
+     * @param face Direction the quad is facing.
+     * @param start Chunk-relative coordinates of the block with the lowest coordinates covered by the quad.
+     * @param width Size of the quad along the lower of the two axes perpendicular to its normal.
+     * @param height Size of the quad along the higher of the two axes perpendicular to its normal.
+     */
+    [[nodiscard]]
+    static PackedQuad packQuad(EBlockFace face, const glm::ivec3 &start, int width, int height, int texID);
+
+    /**
+     * Packs a position relative to the chunk's origin into a single 32-bit word, as expected by the cube shader.
+     * This throws a runtime_error if the position doesn't lie within the chunk.
+     */
+    [[nodiscard]]
+    static glm::uint32 packPosition(const glm::ivec3 &relPos);
+
     [[nodiscard]]
-    std::vector<glm::uint32> packNormalUvTex() const;
+    static glm::ivec3 unpackPosition(glm::uint32 packedPos);
+
+    /**
+     * Packs the given vertex attributes into a single 32-bit word, as expected by the cube shader.
+     */
+    [[nodiscard]]
+    static glm::uint32 packNormalUvTex(EBlockFace face, const glm::ivec2 &uv, int texID);
 };
 
 /**
@@ -50,14 +113,20 @@ class ChunkMeshContext {
     std::vector<Triangle> triangles{};
     std::optional<IndexedMeshData> indexedData;
 
+    // open-addressing table used for deduplicating vertices of loose triangles, kept to reuse its memory
+    std::vector<GLElementBuffer::ElemType> vertexSlots{};
+
 public:
     glm::vec3 modelTranslate{};
 
     bool isFreshlyUpdated = false;
 
+    // layout given to the indexed data whenever it's reset, see `IndexedMeshData::layout`
+    EChunkMeshLayout layout = ChunkMeshLayout_Indexed;
+
     /**
-     * Clears all the quads, triangles and indexed vertices from this mesh, only leaving
-     * allocated GLBuffers intact.
+     * Clears all the quads, triangles and indexed vertices from this mesh, keeping the allocated memory
+     * around so that it can be reused by the next mesh.
      */
     void clear();
 
@@ -76,7 +145,8 @@ public:
     void addTriangle(const Vertex &vertex1, const Vertex &vertex2, const Vertex &vertex3);
 
     /**
-     * Splits all quads in this mesh into triangles.
+     * Splits all quads in this mesh into triangles. This is only needed if the triangles are to be processed
+     * further, as `makeIndexed` handles quads on its own.
      */
     void triangulateQuads();
 
@@ -88,7 +158,9 @@ public:
     void mergeQuads();
 
     /**
-     * Indexes the triangles in this mesh, optimizing the memory usage of this mesh.
+     * Indexes the quads and triangles in this mesh, optimizing the memory usage of this mesh.
+     * Quads never share vertices with each other, so they're emitted directly as 4 vertices each,
+     * while vertices of loose triangles are deduplicated using a hash table.
      */
     void makeIndexed();
 
@@ -98,7 +170,24 @@ public:
     [[nodiscard]]
     const IndexedMeshData& getIndexedData() const { return *indexedData; }
 
+    /**
+     * Empties this mesh' indexed data and sets its layout to `layout`, so that it can be written to directly
+     * without going through quads and triangles. Memory allocated by previous meshes is reused.
+     */
+    IndexedMeshData& resetIndexedData();
+
 private:
+    /**
+     * @return The 4 corners of a quad, ordered such that `QUAD_INDEX_PATTERN` yields correctly wound triangles.
+     */
+    [[nodiscard]]
+    static std::array<Vertex, 4> getQuadCorners(const Quad &quad);
+
+    /**
+     * Appends the triangles of this mesh to its indexed data, reusing indices of identical vertices.
+     */
+    void indexTriangles();
+
     /**
      * Merges a set of quads facing the same direction, i.e. all up-facing quads or down-facing or etc.
      *
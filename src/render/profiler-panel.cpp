@@ -0,0 +1,177 @@
+#include "profiler-panel.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <ranges>
+#include <string_view>
+
+#include "gui.h"
+
+// where traces are exported to, relative to the working directory
+static constexpr auto TRACE_PATH = "profile-trace.json";
+
+static constexpr float TIMELINE_WIDTH = 600.0f;
+static constexpr float ROW_HEIGHT = 16.0f;
+
+static float nanosecondsToMilliseconds(const std::uint64_t ns) {
+    return static_cast<float>(static_cast<double>(ns) / 1e6);
+}
+
+/**
+ * @return Color of a scope in the timeline, which is always the same for the same name.
+ */
+static ImU32 getScopeColor(const std::string_view name) {
+    const size_t hash = std::hash<std::string_view>{}(name);
+    const float hue = static_cast<float>(hash % 360) / 360.0f;
+    return ImColor::HSV(hue, 0.5f, 0.7f);
+}
+
+void ProfilerPanel::renderGuiSection() {
+    if (!ImGui::CollapsingHeader("Profiler ")) return;
+
+#ifndef VOXEL_PROFILING
+    ImGui::Text("Built without VOXEL_PROFILING, so nothing is measured.");
+#endif
+
+    bool isRecording = Profiler::isEnabled();
+    if (ImGui::Checkbox("record", &isRecording)) {
+        Profiler::setEnabled(isRecording);
+    }
+
+    ImGui::SameLine();
+    ImGui::Checkbox("freeze frame", &isFrozen);
+
+    const std::vector<std::uint64_t> frameStarts = Profiler::getFrameStarts();
+
+    std::vector<float> frameTimes;
+    for (size_t i = 1; i < frameStarts.size(); i++) {
+        frameTimes.push_back(nanosecondsToMilliseconds(frameStarts[i] - frameStarts[i - 1]));
+    }
+
+    ImGui::SameLine();
+    if (ImGui::Button("slowest recent frame") && !frameTimes.empty()) {
+        const auto slowest = static_cast<size_t>(std::ranges::max_element(frameTimes) - frameTimes.begin());
+        showFrame(frameStarts[slowest], frameStarts[slowest + 1]);
+        isFrozen = true;
+    }
+
+    ImGui::SameLine();
+    if (ImGui::Button("export trace")) {
+        try {
+            Profiler::exportChromeTrace(TRACE_PATH);
+            exportStatus = std::string("exported to ") + TRACE_PATH;
+        } catch (const std::exception &e) {
+            exportStatus = e.what();
+        }
+    }
+
+    if (!exportStatus.empty()) {
+        ImGui::Text("%s", exportStatus.c_str());
+    }
+
+    ImGui::PlotHistogram("##frame times", frameTimes.data(), static_cast<int>(frameTimes.size()), 0,
+                         "frame times", 0.0f, FLT_MAX, ImVec2(TIMELINE_WIDTH, 40.0f));
+
+    if (!isFrozen && frameStarts.size() >= 2) {
+        showFrame(frameStarts[frameStarts.size() - 2], frameStarts.back());
+    }
+
+    if (shownFrameEnd == shownFrameStart) return;
+
+    ImGui::Text("Frame: %.2f ms", nanosecondsToMilliseconds(shownFrameEnd - shownFrameStart));
+    renderTimeline();
+    renderScopeTotals();
+}
+
+void ProfilerPanel::showFrame(const std::uint64_t frameStart, const std::uint64_t frameEnd) {
+    shownFrameStart = frameStart;
+    shownFrameEnd = frameEnd;
+    shownEvents = Profiler::collect(frameStart, frameEnd);
+
+    std::map<std::string_view, ScopeTotal> totals;
+
+    for (const auto &threadEvents: shownEvents) {
+        for (const auto &event: threadEvents.events) {
+            // only the part of the scope within the frame counts
+            const std::uint64_t start = std::max(event.startNs, frameStart);
+            const std::uint64_t end = std::min(event.endNs, frameEnd);
+
+            ScopeTotal &total = totals.try_emplace(event.name, ScopeTotal{event.name}).first->second;
+            total.calls++;
+            total.totalNs += end - start;
+        }
+    }
+
+    shownTotals.clear();
+    for (const auto &total: totals | std::views::values) {
+        shownTotals.push_back(total);
+    }
+
+    std::ranges::sort(shownTotals, [](const ScopeTotal &a, const ScopeTotal &b) { return a.totalNs > b.totalNs; });
+}
+
+void ProfilerPanel::renderTimeline() const {
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    const double nsPerPixel = static_cast<double>(shownFrameEnd - shownFrameStart) / TIMELINE_WIDTH;
+
+    for (const auto &[threadID, threadName, events]: shownEvents) {
+        std::uint32_t maxDepth = 0;
+        for (const auto &event: events) {
+            maxDepth = std::max(maxDepth, event.depth);
+        }
+
+        ImGui::Text("%s", threadName.c_str());
+
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const float height = static_cast<float>(maxDepth + 1) * ROW_HEIGHT;
+        ImGui::Dummy(ImVec2(TIMELINE_WIDTH, height));
+
+        drawList->AddRectFilled(origin, origin + ImVec2(TIMELINE_WIDTH, height), IM_COL32(30, 30, 30, 255));
+
+        for (const auto &event: events) {
+            const std::uint64_t start = std::max(event.startNs, shownFrameStart) - shownFrameStart;
+            const std::uint64_t end = std::min(event.endNs, shownFrameEnd) - shownFrameStart;
+
+            const float x0 = origin.x + static_cast<float>(static_cast<double>(start) / nsPerPixel);
+            const float x1 = std::max(x0 + 1.0f, origin.x + static_cast<float>(static_cast<double>(end) / nsPerPixel));
+            const float y0 = origin.y + static_cast<float>(event.depth) * ROW_HEIGHT;
+
+            const ImVec2 min(x0, y0);
+            const ImVec2 max(x1, y0 + ROW_HEIGHT - 1.0f);
+            drawList->AddRectFilled(min, max, getScopeColor(event.name));
+
+            // names are only written into scopes wide enough to fit them
+            if (ImGui::CalcTextSize(event.name).x + 4.0f <= x1 - x0) {
+                drawList->AddText(ImVec2(x0 + 2.0f, y0), IM_COL32(255, 255, 255, 255), event.name);
+            }
+
+            if (ImGui::IsMouseHoveringRect(min, max)) {
+                ImGui::SetTooltip("%s: %.3f ms", event.name, nanosecondsToMilliseconds(event.endNs - event.startNs));
+            }
+        }
+    }
+}
+
+void ProfilerPanel::renderScopeTotals() const {
+    constexpr auto tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg;
+
+    if (!ImGui::BeginTable("scope totals", 3, tableFlags, ImVec2(TIMELINE_WIDTH, 0.0f))) return;
+
+    ImGui::TableSetupColumn("scope");
+    ImGui::TableSetupColumn("calls");
+    ImGui::TableSetupColumn("total (ms)");
+    ImGui::TableHeadersRow();
+
+    for (const auto &[name, calls, totalNs]: shownTotals) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("%s", name);
+        ImGui::TableNextColumn();
+        ImGui::Text("%zu", calls);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", nanosecondsToMilliseconds(totalNs));
+    }
+
+    ImGui::EndTable();
+}
@@ -0,0 +1,47 @@
+#ifndef VOXEL_PROFILER_PANEL_H
+#define VOXEL_PROFILER_PANEL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "src/utils/profiler.h"
+
+/**
+ * GUI section showing what the `Profiler` recorded during a single frame: a timeline of the scopes
+ * measured on each thread, and how much time was spent in each kind of scope in total.
+ *
+ * By default, the last finished frame is shown. It can be frozen, so that it can be looked at more closely,
+ * or the slowest of the recent frames can be picked, which is the quickest way to find out what caused a hitch.
+ */
+class ProfilerPanel {
+    struct ScopeTotal {
+        const char *name;
+        size_t calls = 0;
+        std::uint64_t totalNs = 0;
+    };
+
+    std::vector<Profiler::ThreadEvents> shownEvents;
+    std::vector<ScopeTotal> shownTotals;
+    std::uint64_t shownFrameStart = 0, shownFrameEnd = 0;
+
+    bool isFrozen = false;
+
+    // where the last trace was exported, or why it couldn't be
+    std::string exportStatus;
+
+public:
+    void renderGuiSection();
+
+private:
+    /**
+     * Collects the scopes recorded between the given times, so that they're shown from now on.
+     */
+    void showFrame(std::uint64_t frameStart, std::uint64_t frameEnd);
+
+    void renderTimeline() const;
+
+    void renderScopeTotals() const;
+};
+
+#endif //VOXEL_PROFILER_PANEL_H
@@ -0,0 +1,56 @@
+#include "recording-render-backend.h"
+
+RecordingRenderBackend::RecordingRenderBackend(const EChunkMeshLayout layout) : meshLayout(layout) {
+    // the samplers don't matter as long as different block types get different ones, like different textures
+    for (int type = 0; type < BlockType_NumTypes; type++) {
+        blockSamplers[type].fill(type);
+    }
+}
+
+void RecordingRenderBackend::setChunkMeshLayout(const EChunkMeshLayout layout) {
+    if (layout == meshLayout) return;
+
+    meshLayout = layout;
+    storedMeshes.clear();
+    storedQuadCount = 0;
+}
+
+void RecordingRenderBackend::writeChunkMesh(const Chunk::ChunkID id, const IndexedMeshData &mesh) {
+    // meshes hold only the data of the layout they're made for, in which the indexed one takes 4 vertices per quad
+    const size_t quadCount = meshLayout == ChunkMeshLayout_PulledQuads ? mesh.quads.size() : mesh.vertices.size() / 4;
+
+    // a new mesh of a chunk replaces its previous one
+    size_t &storedQuads = storedMeshes[id];
+    storedQuadCount = storedQuadCount - storedQuads + quadCount;
+    storedQuads = quadCount;
+
+    stats.meshWrites++;
+    stats.quadsWritten += quadCount;
+
+    // the same amounts of data `ChunksVertexArray` uploads in each layout
+    if (meshLayout == ChunkMeshLayout_PulledQuads) {
+        stats.bytesWritten += mesh.quads.size() * sizeof(PackedQuad);
+    } else {
+        stats.bytesWritten += mesh.vertices.size() * sizeof(PackedVertex)
+                              + mesh.indices.size() * sizeof(GLElementBuffer::ElemType);
+    }
+}
+
+void RecordingRenderBackend::freeChunkMesh(const Chunk::ChunkID id) {
+    const auto it = storedMeshes.find(id);
+    if (it == storedMeshes.end()) return;
+
+    storedQuadCount -= it->second;
+    storedMeshes.erase(it);
+    stats.meshFrees++;
+}
+
+void RecordingRenderBackend::makeChunksShadowMap(const std::vector<Chunk::ChunkID> &targets) {
+    (void) targets;
+    stats.shadowPasses++;
+}
+
+void RecordingRenderBackend::renderChunks(const std::vector<Chunk::ChunkID> &targets) {
+    stats.renderPasses++;
+    stats.chunksRendered += targets.size();
+}
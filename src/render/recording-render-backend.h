@@ -0,0 +1,93 @@
+#ifndef VOXEL_RECORDING_RENDER_BACKEND_H
+#define VOXEL_RECORDING_RENDER_BACKEND_H
+
+#include <unordered_map>
+
+#include "chunk-render-backend.h"
+
+/**
+ * Render backend which doesn't draw anything, but keeps count of what would have been uploaded and drawn.
+ * It needs neither a window nor a GPU, so chunks can be streamed, generated and meshed headlessly,
+ * e.g. in benchmarks following a scripted camera path.
+ *
+ * Every chunk is considered to be within the view frustum, as the camera has a position but no orientation.
+ */
+class RecordingRenderBackend final : public ChunkRenderBackend {
+public:
+    /**
+     * Counts of operations requested since the last call to `resetStats`.
+     */
+    struct Stats {
+        size_t meshWrites = 0;
+        size_t meshFrees = 0;
+        size_t quadsWritten = 0;
+        size_t bytesWritten = 0;
+        size_t renderPasses = 0;
+        size_t shadowPasses = 0;
+        size_t chunksRendered = 0;
+    };
+
+private:
+    glm::vec3 cameraPos{};
+    EChunkMeshLayout meshLayout;
+    BlockSamplerTable blockSamplers{};
+    bool doDrawShadows = false;
+
+    // number of quads in the currently stored mesh of each chunk
+    std::unordered_map<Chunk::ChunkID, size_t> storedMeshes;
+    size_t storedQuadCount = 0;
+
+    Stats stats;
+
+public:
+    explicit RecordingRenderBackend(EChunkMeshLayout layout = ChunkMeshLayout_PulledQuads);
+
+    void setCameraPos(const glm::vec3 &pos) { cameraPos = pos; }
+
+    void setDrawShadows(const bool b) { doDrawShadows = b; }
+
+    /**
+     * Switches to another mesh layout, dropping all meshes just like `OpenGLRenderer` does.
+     */
+    void setChunkMeshLayout(EChunkMeshLayout layout);
+
+    [[nodiscard]]
+    const Stats& getStats() const { return stats; }
+
+    void resetStats() { stats = {}; }
+
+    [[nodiscard]]
+    size_t getStoredMeshCount() const { return storedMeshes.size(); }
+
+    [[nodiscard]]
+    size_t getStoredQuadCount() const { return storedQuadCount; }
+
+    [[nodiscard]]
+    glm::vec3 getCameraPos() const override { return cameraPos; }
+
+    [[nodiscard]]
+    bool isChunkInFrustum(const Chunk &chunk) const override { (void) chunk; return true; }
+
+    [[nodiscard]]
+    bool shouldDrawShadows() const override { return doDrawShadows; }
+
+    void setRenderDistance(const int renderDistance) override { (void) renderDistance; }
+
+    [[nodiscard]]
+    EChunkMeshLayout getChunkMeshLayout() const override { return meshLayout; }
+
+    [[nodiscard]]
+    const BlockSamplerTable& getBlockSamplerTable() const override { return blockSamplers; }
+
+    void writeChunkMesh(Chunk::ChunkID id, const IndexedMeshData &mesh) override;
+
+    void freeChunkMesh(Chunk::ChunkID id) override;
+
+    void makeChunksShadowMap(const std::vector<Chunk::ChunkID> &targets) override;
+
+    void renderChunks(const std::vector<Chunk::ChunkID> &targets) override;
+
+    void addChunkOutline(const glm::ivec3 &chunkPos) override { (void) chunkPos; }
+};
+
+#endif //VOXEL_RECORDING_RENDER_BACKEND_H
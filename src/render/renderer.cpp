@@ -5,6 +5,8 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <limits>
 #include <ranges>
 
 #include <GL/glew.h>
@@ -15,6 +17,17 @@
 #include "gui.h"
 #include "gl/gl-shader.h"
 
+const char* getRenderPassName(const ERenderPass pass) {
+    switch (pass) {
+        case RenderPass_Shadows: return "shadows";
+        case RenderPass_Chunks: return "chunks";
+        case RenderPass_Skybox: return "skybox";
+        case RenderPass_Outlines: return "outlines";
+        case RenderPass_Hud: return "hud";
+        default: return "unknown";
+    }
+}
+
 // vertices of a the skybox cube.
 // might change this to be generated more intelligently... but it's good enough for now
 static std::vector<glm::vec3> skyboxVerticesList = {
@@ -63,7 +76,8 @@ static std::vector<glm::vec3> skyboxVerticesList = {
 
 OpenGLRenderer::OpenGLRenderer(const int windowWidth, const int windowHeight) {
     glfwWindowHint(GLFW_SAMPLES, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    // 4.3 is needed for indirect multi-draws, which let us pass each chunk's origin through the base instance
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
@@ -119,6 +133,8 @@ OpenGLRenderer::OpenGLRenderer(const int windowWidth, const int windowHeight) {
     skyboxShader = std::make_unique<GLShader>("skybox-shader.vert", "skybox-shader.frag");
     lineShader = std::make_unique<GLShader>("line-shader.vert", "line-shader.frag");
     depthShader = std::make_unique<GLShader>("depth-shader.vert", "depth-shader.frag");
+    cubePulledShader = std::make_unique<GLShader>("cube-shader-pulled.vert", "cube-shader.frag");
+    depthPulledShader = std::make_unique<GLShader>("depth-shader-pulled.vert", "depth-shader.frag");
     debugDepthShader = std::make_unique<GLShader>("debug-depth-quad.vert", "debug-depth-quad.frag");
     cubeShader->enable();
 
@@ -135,8 +151,16 @@ OpenGLRenderer::OpenGLRenderer(const int windowWidth, const int windowHeight) {
     // init peripheral structures
     camera = std::make_unique<Camera>(window);
 
-    depthMap = std::make_unique<GLFrameBuffer>();
-    depthMap->attachDepth(depthMapSize);
+    for (size_t i = 0; i < SHADOW_CASCADE_COUNT; i++) {
+        ShadowCascade &cascade = shadowCascades[i];
+        cascade.size = SHADOW_CASCADE_SIZES[i];
+        cascade.depthMap = std::make_unique<GLFrameBuffer>();
+        cascade.depthMap->attachDepth(cascade.size);
+    }
+
+    for (auto &timer: passTimers) {
+        timer = std::make_unique<GLTimer>();
+    }
 }
 
 OpenGLRenderer::~OpenGLRenderer() {
@@ -181,6 +205,14 @@ void OpenGLRenderer::loadTextures() const {
     textureManager->loadSkyboxTextures(skyboxTexturePaths);
 }
 
+GLShader& OpenGLRenderer::getCubeShader() const {
+    return chunksVao->getMeshLayout() == ChunkMeshLayout_PulledQuads ? *cubePulledShader : *cubeShader;
+}
+
+GLShader& OpenGLRenderer::getDepthShader() const {
+    return chunksVao->getMeshLayout() == ChunkMeshLayout_PulledQuads ? *depthPulledShader : *depthShader;
+}
+
 void OpenGLRenderer::startRendering() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -188,9 +220,10 @@ void OpenGLRenderer::startRendering() {
     projectionMatrix = camera->getProjectionMatrix();
     vpMatrix = projectionMatrix * viewMatrix;
 
-    cubeShader->enable();
-    cubeShader->setUniform("LightDirection_worldspace", skybox.lightDirection);
-    cubeShader->setUniform("doDrawShadows", shadowConfig.doDrawShadows);
+    GLShader &chunkShader = getCubeShader();
+    chunkShader.enable();
+    chunkShader.setUniform("LightDirection_worldspace", skybox.lightDirection);
+    chunkShader.setUniform("doDrawShadows", shadowConfig.doDrawShadows);
 
     for (auto &vertices: tempLineVertexGroups | std::views::values) {
         vertices.clear();
@@ -218,16 +251,46 @@ void OpenGLRenderer::renderGuiSection() {
 
         ImGui::Text("Shadows: ");
         ImGui::Checkbox("draw?", &shadowConfig.doDrawShadows);
-        ImGui::DragFloat("frustum radius", &shadowConfig.frustumRadius, 1.f, 0.f, 1000.f, "%.0f");
-        ImGui::DragFloat("near plane", &shadowConfig.nearPlane, 0.1f, 0.f, 1000.f, "%.1f");
-        ImGui::DragFloat("far plane", &shadowConfig.farPlane, 1.f, 0.f, 1000.f, "%.0f");
+        ImGui::SameLine();
+        ImGui::Checkbox("partial updates?", &shadowConfig.doUsePartialUpdates);
+        ImGui::DragFloat("split lambda", &shadowConfig.splitLambda, 0.01f, 0.f, 1.f, "%.2f");
         ImGui::DragFloat("light distance", &shadowConfig.lightDistance, 1.f, 0.f, 1000.f, "%.0f");
+        ImGui::Text("Shadow distance: %.0f", shadowDistance);
+        for (size_t i = 0; i < SHADOW_CASCADE_COUNT; i++) {
+            const ShadowCascade &cascade = shadowCascades[i];
+            ImGui::Text("    cascade %zu (%dx%d) up to %.1f: full %zu, partial %zu, reused %zu", i,
+                        cascade.size.x, cascade.size.y, cascade.endDistance,
+                        cascade.fullRenders, cascade.partialRenders, cascade.reuses);
+        }
+
+        ImGui::Text("Chunk meshes: ");
+        bool isPulled = chunksVao->getMeshLayout() == ChunkMeshLayout_PulledQuads;
+        if (ImGui::Checkbox("vertex pulling?", &isPulled)) {
+            chunksVao->setMeshLayout(isPulled ? ChunkMeshLayout_PulledQuads : ChunkMeshLayout_Indexed);
+            invalidateShadowCache();
+        }
+        ImGui::Text("GPU memory: %.2f MB", static_cast<float>(chunksVao->getAllocatedBytes()) / (1024.f * 1024.f));
+
+        ImGui::Text("GPU time (ms), a few frames behind:");
+        for (int pass = 0; pass < RenderPass_NumPasses; pass++) {
+            const GLTimer &timer = *passTimers[pass];
+
+            if (pass == RenderPass_Shadows && !shadowConfig.doDrawShadows) {
+                ImGui::Text("    %s: off", getRenderPassName(static_cast<ERenderPass>(pass)));
+                continue;
+            }
+
+            ImGui::Text("    %s: %.3f (last %.3f, skipped %zu)", getRenderPassName(static_cast<ERenderPass>(pass)),
+                        timer.getSmoothedMs(), timer.getLastMs(), timer.getSkippedCount());
+        }
     }
 
     camera->renderGuiSection();
 }
 
 void OpenGLRenderer::renderSkybox() const {
+    const GLTimer::Scope timing(*passTimers[RenderPass_Skybox]);
+
     glDepthMask(GL_FALSE);
     skyboxShader->enable();
 
@@ -243,62 +306,310 @@ void OpenGLRenderer::renderSkybox() const {
 }
 
 void OpenGLRenderer::makeChunksShadowMap(const std::vector<Chunk::ChunkID>& targets) {
-    // todo - make these dependent on the render distance
-    const auto [doDrawShadows, frustumRadius, nearPlane, farPlane, lightDistance] = shadowConfig;
+    const GLTimer::Scope timing(*passTimers[RenderPass_Shadows]);
+
+    updateShadowCascades();
+
+    for (ShadowCascade &cascade: shadowCascades) {
+        makeShadowCascadeMap(cascade, targets);
+    }
+
+    glm::ivec2 windowSize;
+    glfwGetWindowSize(window, &windowSize.x, &windowSize.y);
+    glViewport(0, 0, windowSize.x, windowSize.y);
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void OpenGLRenderer::updateShadowCascades() {
+    const float cameraNear = camera->getNearPlane();
+    const float cameraFar = camera->getFarPlane();
+    const float farDistance = std::clamp(shadowDistance, cameraNear, cameraFar);
+
+    // corners of the whole view frustum, first the ones on the near plane, then the ones on the far plane
+    const glm::mat4 inverseVpMatrix = glm::inverse(vpMatrix);
+    std::array<glm::vec3, 8> frustumCorners{};
+
+    for (int i = 0; i < 8; i++) {
+        const glm::vec4 ndcCorner = {i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : -1.f, 1.f};
+        const glm::vec4 corner = inverseVpMatrix * ndcCorner;
+        frustumCorners[i] = glm::vec3(corner.x, corner.y, corner.z) / corner.w;
+    }
+
+    // view depth grows linearly along the frustum's edges, so any depth's corners are in between the near and far ones
+    const auto getSliceCorner = [&](const int corner, const float depth) {
+        const float t = (depth - cameraNear) / (cameraFar - cameraNear);
+        return glm::mix(frustumCorners[corner], frustumCorners[corner + 4], t);
+    };
+
+    const glm::vec3 lightDirection = glm::normalize(skybox.lightDirection);
+    float startDistance = cameraNear;
+
+    for (size_t i = 0; i < SHADOW_CASCADE_COUNT; i++) {
+        ShadowCascade &cascade = shadowCascades[i];
+
+        // logarithmic splits spread texels evenly across the screen, but leave the nearest cascades tiny
+        const float fraction = static_cast<float>(i + 1) / SHADOW_CASCADE_COUNT;
+        const float logSplit = cameraNear * std::pow(farDistance / cameraNear, fraction);
+        const float uniformSplit = cameraNear + (farDistance - cameraNear) * fraction;
+        cascade.endDistance = glm::mix(uniformSplit, logSplit, shadowConfig.splitLambda);
+
+        std::array<glm::vec3, 8> sliceCorners{};
+        glm::vec3 center(0);
+
+        for (int corner = 0; corner < 4; corner++) {
+            sliceCorners[corner] = getSliceCorner(corner, startDistance);
+            sliceCorners[corner + 4] = getSliceCorner(corner, cascade.endDistance);
+        }
 
-    const glm::mat4 lightProjection = glm::ortho(
-        -frustumRadius, frustumRadius,
-        -frustumRadius, frustumRadius,
-        nearPlane, farPlane
-    );
+        for (const glm::vec3 &corner: sliceCorners) {
+            center += corner / 8.0f;
+        }
+
+        // the cascade is fit around a bounding sphere of its slice. unlike a box, its size doesn't change as the
+        // camera rotates, and rounding it up keeps the light's matrix from changing with the slightest movement
+        float radius = 0.f;
+        for (const glm::vec3 &corner: sliceCorners) {
+            radius = std::max(radius, glm::length(corner - center));
+        }
+        radius = std::max(1.0f, std::ceil(radius));
+
+        // the sphere's center is snapped to a grid, so that the cascade stays put and its shadow map can be reused
+        // while the camera moves within a single cell. the sphere grows to still contain the whole slice
+        const float snapStep = radius / 4.0f;
+        const glm::vec3 snappedCenter = glm::round(center / snapStep) * snapStep;
+        radius += snapStep * std::sqrt(3.0f) / 2.0f;
+
+        const glm::mat4 lightView = glm::lookAt(
+            snappedCenter + lightDirection * (radius + shadowConfig.lightDistance),
+            snappedCenter,
+            glm::vec3(0.f, 1.f, 0.f)
+        );
+
+        glm::mat4 lightProjection = glm::ortho(
+            -radius, radius,
+            -radius, radius,
+            0.f, 2.0f * radius + shadowConfig.lightDistance
+        );
+
+        // the projection is shifted so that texels always cover the same parts of the world,
+        // which keeps the edges of shadows from shimmering whenever the cascade moves
+        const glm::vec2 halfSize = glm::vec2(cascade.size) * 0.5f;
+        const glm::vec4 projectedOrigin = lightProjection * lightView * glm::vec4(0.f, 0.f, 0.f, 1.f);
+        const glm::vec2 originTexel = glm::vec2(projectedOrigin.x, projectedOrigin.y) * halfSize;
+        const glm::vec2 texelOffset = (glm::round(originTexel) - originTexel) / halfSize;
+
+        lightProjection[3][0] += texelOffset.x;
+        lightProjection[3][1] += texelOffset.y;
+
+        cascade.lightVpMatrix = lightProjection * lightView;
+        startDistance = cascade.endDistance;
+    }
+}
+
+void OpenGLRenderer::makeShadowCascadeMap(ShadowCascade &cascade, const std::vector<Chunk::ChunkID> &targets) {
+    const glm::ivec2 mapSize = cascade.size;
+
+    // only chunks within the cascade's light frustum are submitted
+    std::vector<Chunk::ChunkID> cascadeTargets;
+    std::vector<glm::ivec4> targetRects;
 
-    const glm::vec3 lightOffset =
-        VecUtils::floor(camera->getPos() * (1.0f / Chunk::CHUNK_SIZE)) * static_cast<float>(Chunk::CHUNK_SIZE);
-    const glm::mat4 lightView = glm::lookAt(
-        lightOffset + glm::normalize(skybox.lightDirection) * lightDistance,
-        lightOffset,
-        glm::vec3(0.f, 1.f, 0.f)
-    );
+    for (const Chunk::ChunkID id: targets) {
+        const auto origin = chunksVao->getChunkOrigin(id);
+        if (!origin) continue;
 
-    glViewport(0, 0, depthMapSize.x, depthMapSize.y);
+        const glm::ivec4 rect = getShadowMapRect(cascade.lightVpMatrix, mapSize, *origin);
+        if (rect.x >= rect.z || rect.y >= rect.w) continue;
 
-    depthMap->enable();
+        cascadeTargets.push_back(id);
+        targetRects.push_back(rect);
+    }
+
+    std::vector<Chunk::ChunkID> sortedTargets = cascadeTargets;
+    std::ranges::sort(sortedTargets);
+
+    // the cascade only moves when the camera crosses into another cell of its grid, or when the light
+    // or the shadow config changes. otherwise, the shadow map can be reused, at least partially
+    bool isFullRender = !cascade.cachedLightVpMatrix || *cascade.cachedLightVpMatrix != cascade.lightVpMatrix
+                        || !shadowConfig.doUsePartialUpdates;
+
+    glm::ivec4 dirtyRect = {0, 0, mapSize.x, mapSize.y};
+
+    if (!isFullRender) {
+        // chunks which started or stopped casting shadows, without their meshes changing, e.g. by getting occluded
+        std::vector<Chunk::ChunkID> changedTargets;
+        std::ranges::set_symmetric_difference(sortedTargets, cascade.cachedTargets, std::back_inserter(changedTargets));
+
+        for (const Chunk::ChunkID id: changedTargets) {
+            if (const auto origin = chunksVao->getChunkOrigin(id)) {
+                markShadowDirty(*origin);
+            }
+        }
+
+        dirtyRect = {mapSize.x, mapSize.y, 0, 0};
+
+        // too many changes might have invalidated the cache, in which case the list is empty
+        for (const glm::ivec3 &origin: cascade.dirtyChunkOrigins) {
+            const glm::ivec4 rect = getShadowMapRect(cascade.lightVpMatrix, mapSize, origin);
+            if (rect.x >= rect.z || rect.y >= rect.w) continue;
+
+            dirtyRect = {
+                std::min(dirtyRect.x, rect.x), std::min(dirtyRect.y, rect.y),
+                std::max(dirtyRect.z, rect.z), std::max(dirtyRect.w, rect.w)
+            };
+        }
+
+        // nothing that casts shadows within the light's frustum has changed
+        if (cascade.cachedLightVpMatrix && (dirtyRect.x >= dirtyRect.z || dirtyRect.y >= dirtyRect.w)) {
+            cascade.cachedTargets = std::move(sortedTargets);
+            cascade.dirtyChunkOrigins.clear();
+            cascade.reuses++;
+            return;
+        }
+
+        // past some point, scissoring saves less than culling the chunks outside the dirty part costs
+        const glm::ivec2 dirtySize = {dirtyRect.z - dirtyRect.x, dirtyRect.w - dirtyRect.y};
+        if (!cascade.cachedLightVpMatrix || dirtySize.x * dirtySize.y * 2 > mapSize.x * mapSize.y) {
+            isFullRender = true;
+        }
+    }
+
+    cascade.cachedLightVpMatrix = cascade.lightVpMatrix;
+    cascade.cachedTargets = std::move(sortedTargets);
+    cascade.dirtyChunkOrigins.clear();
+
+    glViewport(0, 0, mapSize.x, mapSize.y);
+
+    cascade.depthMap->enable();
+
+    if (!isFullRender) {
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(dirtyRect.x, dirtyRect.y, dirtyRect.z - dirtyRect.x, dirtyRect.w - dirtyRect.y);
+    }
 
     glClear(GL_DEPTH_BUFFER_BIT);
 
-    depthShader->enable();
-    lightVpMatrix = lightProjection * lightView;
-    depthShader->setUniform("MVP", lightVpMatrix);
+    GLShader &chunkDepthShader = getDepthShader();
+    chunkDepthShader.enable();
+    chunkDepthShader.setUniform("MVP", cascade.lightVpMatrix);
 
     chunksVao->enable();
-    chunksVao->render(targets); // todo idea: maybe redraw only if something changed?
 
-    depthMap->disable();
+    if (isFullRender) {
+        chunksVao->render(cascadeTargets);
+        cascade.fullRenders++;
+    } else {
+        // only chunks overlapping the redrawn part of the shadow map need to be drawn again
+        std::vector<Chunk::ChunkID> overlappingTargets;
+
+        for (size_t i = 0; i < cascadeTargets.size(); i++) {
+            const glm::ivec4 &rect = targetRects[i];
+            if (rect.x < dirtyRect.z && dirtyRect.x < rect.z && rect.y < dirtyRect.w && dirtyRect.y < rect.w) {
+                overlappingTargets.push_back(cascadeTargets[i]);
+            }
+        }
 
-    glm::ivec2 windowSize;
-    glfwGetWindowSize(window, &windowSize.x, &windowSize.y);
-    glViewport(0, 0, windowSize.x, windowSize.y);
+        chunksVao->render(overlappingTargets);
+        glDisable(GL_SCISSOR_TEST);
+        cascade.partialRenders++;
+    }
 
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    cascade.depthMap->disable();
 }
 
-void OpenGLRenderer::renderChunks(const std::vector<Chunk::ChunkID>& targets) const {
-    cubeShader->enable();
-    textureManager->bindBlockTextures(*cubeShader);
+void OpenGLRenderer::writeChunkMesh(const Chunk::ChunkID id, const IndexedMeshData& mesh) {
+    chunksVao->writeChunk(id, mesh);
+    markShadowDirty(mesh.origin);
+}
+
+void OpenGLRenderer::freeChunkMesh(const Chunk::ChunkID id) {
+    if (const auto origin = chunksVao->getChunkOrigin(id)) {
+        markShadowDirty(*origin);
+    }
+
+    chunksVao->eraseChunk(id);
+}
+
+void OpenGLRenderer::setRenderDistance(const int renderDistance) {
+    shadowDistance = static_cast<float>(renderDistance * Chunk::CHUNK_SIZE);
+}
+
+void OpenGLRenderer::markShadowDirty(const glm::ivec3 &chunkOrigin) {
+    for (ShadowCascade &cascade: shadowCascades) {
+        // nothing has to be tracked if the whole shadow map is going to be redrawn anyway
+        if (!cascade.cachedLightVpMatrix) continue;
+
+        if (cascade.dirtyChunkOrigins.size() >= MAX_DIRTY_SHADOW_CHUNKS) {
+            cascade.cachedLightVpMatrix = std::nullopt;
+            cascade.dirtyChunkOrigins.clear();
+            continue;
+        }
+
+        cascade.dirtyChunkOrigins.push_back(chunkOrigin);
+    }
+}
+
+void OpenGLRenderer::invalidateShadowCache() {
+    for (ShadowCascade &cascade: shadowCascades) {
+        cascade.cachedLightVpMatrix = std::nullopt;
+        cascade.dirtyChunkOrigins.clear();
+    }
+}
+
+glm::ivec4 OpenGLRenderer::getShadowMapRect(const glm::mat4 &lightVp, const glm::ivec2 &mapSize,
+                                            const glm::ivec3 &chunkOrigin) {
+    glm::vec2 minCorner(std::numeric_limits<float>::max());
+    glm::vec2 maxCorner(std::numeric_limits<float>::lowest());
+
+    // the light's projection is orthographic, so the chunk's corners bound everything it can cover
+    for (int i = 0; i < 8; i++) {
+        const glm::vec3 corner = glm::vec3(chunkOrigin)
+                                 + glm::vec3(i & 1, (i >> 1) & 1, (i >> 2) & 1) * static_cast<float>(Chunk::CHUNK_SIZE);
+        const glm::vec4 projected = lightVp * glm::vec4(corner, 1.0f);
+
+        minCorner = glm::min(minCorner, glm::vec2(projected.x, projected.y));
+        maxCorner = glm::max(maxCorner, glm::vec2(projected.x, projected.y));
+    }
+
+    // from normalized device coordinates to texels, with a texel of margin for rasterization rounding
+    const glm::vec2 texelCount = mapSize;
+    const glm::ivec2 minTexel = glm::clamp(glm::ivec2(glm::floor((minCorner * 0.5f + 0.5f) * texelCount)) - 1,
+                                           glm::ivec2(0), mapSize);
+    const glm::ivec2 maxTexel = glm::clamp(glm::ivec2(glm::ceil((maxCorner * 0.5f + 0.5f) * texelCount)) + 1,
+                                           glm::ivec2(0), mapSize);
+
+    return {minTexel.x, minTexel.y, maxTexel.x, maxTexel.y};
+}
+
+void OpenGLRenderer::renderChunks(const std::vector<Chunk::ChunkID>& targets) {
+    const GLTimer::Scope timing(*passTimers[RenderPass_Chunks]);
+
+    GLShader &chunkShader = getCubeShader();
+    chunkShader.enable();
+    textureManager->bindBlockTextures(chunkShader);
 
     // todo - move to tex manager
-    glActiveTexture(GL_TEXTURE0 + textureManager->getNextFreeUnit());
-    glBindTexture(GL_TEXTURE_2D, depthMap->getDepth());
-    cubeShader->setUniform("shadowMap", textureManager->getNextFreeUnit());
+    for (size_t i = 0; i < SHADOW_CASCADE_COUNT; i++) {
+        const ShadowCascade &cascade = shadowCascades[i];
+        const std::string index = "[" + std::to_string(i) + "]";
+        const int unit = textureManager->getNextFreeUnit() + static_cast<int>(i);
+
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, cascade.depthMap->getDepth());
+        chunkShader.setUniform("shadowMaps" + index, unit);
+        chunkShader.setUniform("lightVPs" + index, cascade.lightVpMatrix); // M is the identity matrix
+        chunkShader.setUniform("cascadeEnds" + index, cascade.endDistance);
+    }
 
-    cubeShader->setUniform("MVP", vpMatrix); // M is the identity matrix
-    cubeShader->setUniform("lightMVP", lightVpMatrix); // M is the identity matrix
+    chunkShader.setUniform("MVP", vpMatrix); // M is the identity matrix
 
     chunksVao->enable();
     chunksVao->render(targets);
 }
 
 void OpenGLRenderer::renderOutlines() {
+    const GLTimer::Scope timing(*passTimers[RenderPass_Outlines]);
+
     lineShader->enable();
     lineShader->setUniform("MVP", vpMatrix); // model matrix is the identity matrix so no need to multiply it in
 
@@ -361,6 +672,8 @@ auto OpenGLRenderer::addTargetedBlockOutline(const glm::ivec3 &blockPos) -> void
 }
 
 void OpenGLRenderer::renderHud() const {
+    const GLTimer::Scope timing(*passTimers[RenderPass_Hud]);
+
     constexpr float crosshairLength = 0.02;
     std::vector<glm::vec3> vertices;
 
@@ -393,6 +706,16 @@ void OpenGLRenderer::renderHud() const {
     cubeShader->enable();
 }
 
+std::array<float, RenderPass_NumPasses> OpenGLRenderer::getPassGpuTimes() const {
+    std::array<float, RenderPass_NumPasses> times{};
+
+    for (int pass = 0; pass < RenderPass_NumPasses; pass++) {
+        times[pass] = passTimers[pass]->getLastMs();
+    }
+
+    return times;
+}
+
 void OpenGLRenderer::finishRendering() const {
     //glFlush();
     glfwSwapBuffers(window);
@@ -3,21 +3,40 @@
 
 #include "GL/glew.h"
 
+#include <array>
+#include <optional>
 #include <vector>
 #include <filesystem>
 
 #include "src/voxel/chunk/chunk.h"
+#include "chunk-render-backend.h"
 #include "texture-manager.h"
 #include "camera.h"
 #include "mesh-context.h"
 #include "gl/gl-shader.h"
 #include "gl/gl-vao.h"
+#include "gl/gl-timer.h"
+
+/**
+ * Passes of a frame whose GPU time is measured.
+ */
+enum ERenderPass {
+    RenderPass_Shadows,
+    RenderPass_Chunks,
+    RenderPass_Skybox,
+    RenderPass_Outlines,
+    RenderPass_Hud,
+    RenderPass_NumPasses
+};
+
+[[nodiscard]]
+const char* getRenderPassName(ERenderPass pass);
 
 /**
  * The main renderer of the program. There should only be one instance of this class, as it
  * doesn't really make sense to have two renderers.
  */
-class OpenGLRenderer {
+class OpenGLRenderer final : public ChunkRenderBackend {
 public:
     enum LineType {
         CHUNK_OUTLINE,
@@ -36,6 +55,9 @@ private:
 
     std::unique_ptr<GLShader> cubeShader, skyboxShader, lineShader, depthShader, debugDepthShader{}; // todo - remove!
 
+    // variants of the chunk shaders used with the pulled quads mesh layout
+    std::unique_ptr<GLShader> cubePulledShader, depthPulledShader;
+
     std::unique_ptr<ChunksVertexArray> chunksVao;
 
     struct Skybox {
@@ -52,24 +74,74 @@ private:
     };
     std::unordered_map<LineType, std::vector<glm::vec3>> tempLineVertexGroups;
 
-    std::unique_ptr<GLFrameBuffer> depthMap;
-    static constexpr glm::ivec2 depthMapSize = {4096, 4096};
+    // has to match `SHADOW_CASCADE_COUNT` in the chunk fragment shader
+    static constexpr size_t SHADOW_CASCADE_COUNT = 4;
+
+    // farther cascades cover more of the world, but are also seen from further away, so they get by with fewer texels
+    static constexpr std::array<glm::ivec2, SHADOW_CASCADE_COUNT> SHADOW_CASCADE_SIZES = {{
+        {2048, 2048}, {2048, 2048}, {1024, 1024}, {1024, 1024}
+    }};
+
+    /**
+     * Shadow map of one part of the view frustum, between two distances from the camera. As long as the light's
+     * matrix stays the same, only the parts covered by chunks whose meshes changed since the shadow map was last
+     * rendered have to be redrawn.
+     */
+    struct ShadowCascade {
+        std::unique_ptr<GLFrameBuffer> depthMap;
+        glm::ivec2 size{};
+
+        // view depth up to which this cascade is used
+        float endDistance = 0.f;
+
+        glm::mat4 lightVpMatrix{};
+
+        // matrix with which the shadow map was rendered, or none if its contents can't be reused
+        std::optional<glm::mat4> cachedLightVpMatrix;
+
+        // chunks drawn into the shadow map, sorted
+        std::vector<Chunk::ChunkID> cachedTargets;
+
+        // origins of chunks whose meshes were written or freed since the shadow map was rendered
+        std::vector<glm::ivec3> dirtyChunkOrigins;
+
+        size_t fullRenders = 0, partialRenders = 0, reuses = 0;
+    };
+
+    std::array<ShadowCascade, SHADOW_CASCADE_COUNT> shadowCascades;
 
     struct {
         bool doDrawShadows = false;
-        float frustumRadius = 160.f, nearPlane = 1.f, farPlane = 1000.f;
+
+        // whether only the dirty parts of the shadow maps are redrawn, instead of the whole of them
+        bool doUsePartialUpdates = true;
+
+        // how the cascades are split, from evenly (0) to logarithmically (1) spaced
+        float splitLambda = 0.75f;
+
+        // how far beyond a cascade's bounds occluders are still picked up, towards the light
         float lightDistance = 200.f;
     } shadowConfig;
+
+    // how far from the camera shadows are drawn, following the render distance
+    float shadowDistance = 128.f;
+
+    // with this many dirty chunks, it's not worth tracking them anymore, as the whole shadow map gets redrawn anyway
+    static constexpr size_t MAX_DIRTY_SHADOW_CHUNKS = 256;
+
     float biasMin = 0.0005, biasFactor = 0.0007;
 
+    // GPU timers of each pass. their results arrive a few frames late
+    std::array<std::unique_ptr<GLTimer>, RenderPass_NumPasses> passTimers;
+
     // cached view and projection matrices and their product for the current render tick.
     // model matrix can't be cached because it's different for each chunk
-    glm::mat4 viewMatrix{}, projectionMatrix{}, vpMatrix{}, lightVpMatrix{};
+    glm::mat4 viewMatrix{}, projectionMatrix{}, vpMatrix{};
 
 public:
     OpenGLRenderer(int windowWidth, int windowHeight);
 
-    ~OpenGLRenderer();
+    ~OpenGLRenderer() override;
 
     void tick(float deltaTime) const;
 
@@ -92,16 +164,34 @@ public:
     const TextureManager& getTextureManager() const { return *textureManager; }
 
     [[nodiscard]]
-    glm::vec3 getCameraPos() const { return camera->getPos(); }
+    Camera& getCamera() const { return *camera; }
+
+    /**
+     * @return GPU time of the latest measured run of each pass, in milliseconds. The measurements
+     *         are a few frames old, and a pass which doesn't run anymore keeps its last time.
+     */
+    [[nodiscard]]
+    std::array<float, RenderPass_NumPasses> getPassGpuTimes() const;
+
+    [[nodiscard]]
+    glm::vec3 getCameraPos() const override { return camera->getPos(); }
 
     [[nodiscard]]
     std::vector<glm::ivec3> getLookedAtBlocks() const { return camera->getLookedAtBlocks(); }
 
     [[nodiscard]]
-    bool isChunkInFrustum(const Chunk& chunk) const { return camera->isChunkInFrustum(chunk.getPos()); }
+    bool isChunkInFrustum(const Chunk& chunk) const override { return camera->isChunkInFrustum(chunk.getPos()); }
 
     [[nodiscard]]
-    bool shouldDrawShadows() const { return shadowConfig.doDrawShadows; }
+    bool shouldDrawShadows() const override { return shadowConfig.doDrawShadows; }
+
+    void setRenderDistance(int renderDistance) override;
+
+    [[nodiscard]]
+    EChunkMeshLayout getChunkMeshLayout() const override { return chunksVao->getMeshLayout(); }
+
+    [[nodiscard]]
+    const BlockSamplerTable& getBlockSamplerTable() const override { return textureManager->getBlockSamplerTable(); }
 
     /**
      * Locks or unlocks the cursor. When the cursor is locked, it's confined to the center
@@ -110,17 +200,19 @@ public:
      */
     void setIsCursorLocked(bool b) const;
 
-    void writeChunkMesh(const Chunk::ChunkID id, const IndexedMeshData& mesh) const { chunksVao->writeChunk(id, mesh); }
+    void writeChunkMesh(Chunk::ChunkID id, const IndexedMeshData& mesh) override;
 
-    void freeChunkMesh(const Chunk::ChunkID id) const { chunksVao->eraseChunk(id); }
+    void freeChunkMesh(Chunk::ChunkID id) override;
 
     void renderGuiSection();
 
     void renderSkybox() const;
 
-    void makeChunksShadowMap(const std::vector<Chunk::ChunkID>& targets);
+    void makeChunksShadowMap(const std::vector<Chunk::ChunkID>& targets) override;
+
+    void renderChunks(const std::vector<Chunk::ChunkID>& targets) override;
 
-    void renderChunks(const std::vector<Chunk::ChunkID>& targets) const;
+    void addChunkOutline(const glm::ivec3 &chunkPos) override { addChunkOutline(chunkPos, CHUNK_OUTLINE); }
 
     /**
      * Adds a given chunk's outline to the list of lines that will be rendered later.
@@ -159,6 +251,48 @@ private:
 
     void loadTextures() const;
 
+    /**
+     * Splits the part of the view frustum within the shadow distance between the cascades,
+     * and fits each cascade's light matrix around its part.
+     */
+    void updateShadowCascades();
+
+    /**
+     * Renders those of the given chunks that fall within a cascade into its shadow map,
+     * reusing as much of its previous contents as possible.
+     */
+    void makeShadowCascadeMap(ShadowCascade &cascade, const std::vector<Chunk::ChunkID> &targets);
+
+    /**
+     * Notes that the shadow cast by a chunk at a given origin might have changed.
+     */
+    void markShadowDirty(const glm::ivec3 &chunkOrigin);
+
+    /**
+     * Makes the whole of each shadow map get redrawn the next time it's made.
+     */
+    void invalidateShadowCache();
+
+    /**
+     * @return Rectangle of shadow map texels covered by a chunk at a given origin, as min and max corners,
+     *         clamped to the shadow map. Empty if the chunk is outside the light's frustum.
+     */
+    [[nodiscard]]
+    static glm::ivec4 getShadowMapRect(const glm::mat4 &lightVp, const glm::ivec2 &mapSize,
+                                       const glm::ivec3 &chunkOrigin);
+
+    /**
+     * @return The shader used for rendering chunks with the current mesh layout.
+     */
+    [[nodiscard]]
+    GLShader& getCubeShader() const;
+
+    /**
+     * @return The shader used for rendering chunks to the shadow map with the current mesh layout.
+     */
+    [[nodiscard]]
+    GLShader& getDepthShader() const;
+
     /**
      * Debug callback used by GLFW to notify the user of errors.
      */
@@ -41,6 +41,11 @@ void TextureManager::loadBlockTextures(const BlockTexPathMapping &blockTexPathMa
         blockTextures[{block, Top}] = loadTexture(faceTexPathMapping.get(Top));
         blockTextures[{block, Bottom}] = loadTexture(faceTexPathMapping.get(Bottom));
     }
+
+    for (const auto &[key, texID]: blockTextures) {
+        const auto &[type, face] = key;
+        blockSamplerTable[type][getFaceIndex(face)] = textureUnits.at(texID);
+    }
 }
 
 void TextureManager::loadSkyboxTextures(const FaceMapping<std::filesystem::path> &skyboxTexturePaths) {
@@ -20,6 +20,7 @@ class TextureManager {
     int nextFreeUnit = 0;
 
     std::map<std::pair<EBlockType, EBlockFace>, GLuint> blockTextures;
+    BlockSamplerTable blockSamplerTable{};
 
     struct BlockTexCache {
         std::vector<GLint> handles;
@@ -66,6 +67,13 @@ public:
     [[nodiscard]]
     int getBlockSamplerID(EBlockType blockType, EBlockFace face) const;
 
+    /**
+     * @return Table of sampler IDs of all block textures. As opposed to `getBlockSamplerID()`, this is
+     * a plain array which can be cheaply copied and handed over to other threads.
+     */
+    [[nodiscard]]
+    const BlockSamplerTable& getBlockSamplerTable() const { return blockSamplerTable; }
+
     [[nodiscard]]
     int getNextFreeUnit() const { return nextFreeUnit; }
 
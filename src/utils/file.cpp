@@ -0,0 +1,59 @@
+#include "file.h"
+
+#include <array>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+void FileUtils::sync(const std::filesystem::path &path) {
+#ifdef _WIN32
+    const HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    const bool isSynced = file != INVALID_HANDLE_VALUE && FlushFileBuffers(file);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+    // syncing any descriptor of a file flushes all of its data, not only what was written through the descriptor
+    const int file = open(path.c_str(), O_RDONLY);
+    const bool isSynced = file >= 0 && fsync(file) == 0;
+    if (file >= 0) close(file);
+#endif
+
+    if (!isSynced) {
+        throw std::runtime_error("failed to sync file " + path.string() + " in FileUtils::sync()");
+    }
+}
+
+static constexpr std::array<std::uint32_t, 256> makeCrcTable() {
+    std::array<std::uint32_t, 256> table{};
+
+    for (std::uint32_t i = 0; i < 256; i++) {
+        std::uint32_t crc = i;
+
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 1 ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+        }
+
+        table[i] = crc;
+    }
+
+    return table;
+}
+
+std::uint32_t FileUtils::crc32(const std::span<const std::uint8_t> data) {
+    static constexpr std::array<std::uint32_t, 256> table = makeCrcTable();
+
+    std::uint32_t crc = 0xffffffff;
+
+    for (const std::uint8_t byte: data) {
+        crc = table[(crc ^ byte) & 0xff] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
@@ -0,0 +1,25 @@
+#ifndef VOXEL_FILE_H
+#define VOXEL_FILE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+/**
+ * Collection of various utils for handling files stored on disk.
+ */
+namespace FileUtils {
+    /**
+     * Blocks until all data written to a given file so far reaches the disk, so that it survives a crash.
+     * Writes still buffered by a stream have to be flushed to the file beforehand.
+     */
+    void sync(const std::filesystem::path &path);
+
+    /**
+     * @return CRC-32 checksum of given data, used to detect records which were only partially written.
+     */
+    [[nodiscard]]
+    std::uint32_t crc32(std::span<const std::uint8_t> data);
+}
+
+#endif //VOXEL_FILE_H
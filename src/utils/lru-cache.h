@@ -0,0 +1,67 @@
+#ifndef VOXEL_LRU_CACHE_H
+#define VOXEL_LRU_CACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Map holding at most a fixed number of elements, evicting the least recently used one when it's full.
+ *
+ * @tparam K Key type.
+ * @tparam V Value type.
+ * @tparam Hash Hash function of keys.
+ */
+template<typename K, typename V, typename Hash = std::hash<K>>
+class LruCache {
+    using Entry = std::pair<K, V>;
+
+    // entries ordered from the most recently used one to the least recently used one
+    std::list<Entry> entries;
+    std::unordered_map<K, typename std::list<Entry>::iterator, Hash> index;
+    size_t capacity;
+
+public:
+    explicit LruCache(const size_t c) : capacity(c) {
+        index.reserve(capacity);
+    }
+
+    [[nodiscard]]
+    size_t size() const { return entries.size(); }
+
+    [[nodiscard]]
+    size_t getCapacity() const { return capacity; }
+
+    /**
+     * Finds an element, marking it as the most recently used one.
+     *
+     * @return Pointer to the element, or null if it isn't cached. It stays valid until the element is evicted.
+     */
+    V* find(const K &key) {
+        const auto it = index.find(key);
+        if (it == index.end()) return nullptr;
+
+        entries.splice(entries.begin(), entries, it->second);
+        return &it->second->second;
+    }
+
+    /**
+     * Inserts an element which isn't cached yet, evicting the least recently used one if the cache is full.
+     *
+     * @return Reference to the inserted element. It stays valid until the element is evicted.
+     */
+    V& insert(const K &key, V value) {
+        if (entries.size() >= capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+
+        entries.emplace_front(key, std::move(value));
+        index.emplace(key, entries.begin());
+        return entries.front().second;
+    }
+};
+
+#endif //VOXEL_LRU_CACHE_H
@@ -0,0 +1,134 @@
+#include "mapped-file.h"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path &path) {
+    fileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        fileHandle = nullptr;
+        throw std::runtime_error("failed to open file " + path.string() + " in MappedFile::MappedFile()");
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize)) {
+        close();
+        throw std::runtime_error("failed to get size of file " + path.string() + " in MappedFile::MappedFile()");
+    }
+
+    // empty files can't be mapped, but there's nothing to read from them anyway
+    if (fileSize.QuadPart == 0) return;
+
+    mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle) {
+        close();
+        throw std::runtime_error("failed to map file " + path.string() + " in MappedFile::MappedFile()");
+    }
+
+    mappedData = static_cast<const std::uint8_t *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!mappedData) {
+        close();
+        throw std::runtime_error("failed to map file " + path.string() + " in MappedFile::MappedFile()");
+    }
+
+    mappedSize = static_cast<size_t>(fileSize.QuadPart);
+}
+
+void MappedFile::close() {
+    if (mappedData) UnmapViewOfFile(mappedData);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+
+    mappedData = nullptr;
+    mappedSize = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : mappedData(std::exchange(other.mappedData, nullptr)), mappedSize(std::exchange(other.mappedSize, 0)),
+      fileHandle(std::exchange(other.fileHandle, nullptr)),
+      mappingHandle(std::exchange(other.mappingHandle, nullptr)) {}
+
+MappedFile& MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        close();
+        mappedData = std::exchange(other.mappedData, nullptr);
+        mappedSize = std::exchange(other.mappedSize, 0);
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+    }
+
+    return *this;
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path &path) {
+    fileDescriptor = open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error("failed to open file " + path.string() + " in MappedFile::MappedFile()");
+    }
+
+    struct stat fileStat{};
+    if (fstat(fileDescriptor, &fileStat) != 0) {
+        close();
+        throw std::runtime_error("failed to get size of file " + path.string() + " in MappedFile::MappedFile()");
+    }
+
+    // empty files can't be mapped, but there's nothing to read from them anyway
+    if (fileStat.st_size == 0) return;
+
+    void *mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+    if (mapping == MAP_FAILED) {
+        close();
+        throw std::runtime_error("failed to map file " + path.string() + " in MappedFile::MappedFile()");
+    }
+
+    mappedData = static_cast<const std::uint8_t *>(mapping);
+    mappedSize = static_cast<size_t>(fileStat.st_size);
+}
+
+void MappedFile::close() {
+    if (mappedData) munmap(const_cast<std::uint8_t *>(mappedData), mappedSize);
+    if (fileDescriptor >= 0) ::close(fileDescriptor);
+
+    mappedData = nullptr;
+    mappedSize = 0;
+    fileDescriptor = -1;
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : mappedData(std::exchange(other.mappedData, nullptr)), mappedSize(std::exchange(other.mappedSize, 0)),
+      fileDescriptor(std::exchange(other.fileDescriptor, -1)) {}
+
+MappedFile& MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        close();
+        mappedData = std::exchange(other.mappedData, nullptr);
+        mappedSize = std::exchange(other.mappedSize, 0);
+        fileDescriptor = std::exchange(other.fileDescriptor, -1);
+    }
+
+    return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
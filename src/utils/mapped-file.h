@@ -0,0 +1,54 @@
+#ifndef VOXEL_MAPPED_FILE_H
+#define VOXEL_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+/**
+ * Read-only memory mapping of a whole file, so that its contents can be read straight from the page cache
+ * without copying them into a buffer first.
+ *
+ * The mapping reflects the size of the file at the time it was made. If the file grows afterwards,
+ * the new contents can be seen only through a new mapping.
+ */
+class MappedFile {
+    const std::uint8_t *mappedData = nullptr;
+    size_t mappedSize = 0;
+
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::filesystem::path &path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile& operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept;
+
+    MappedFile& operator=(MappedFile &&other) noexcept;
+
+    /**
+     * @return Pointer to the mapped contents, or null if the file was empty.
+     */
+    [[nodiscard]]
+    const std::uint8_t *data() const { return mappedData; }
+
+    [[nodiscard]]
+    size_t size() const { return mappedSize; }
+
+private:
+    void close();
+};
+
+#endif //VOXEL_MAPPED_FILE_H
@@ -0,0 +1,202 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    /**
+     * Ring buffer of a single thread's recorded scopes. Only the owning thread writes into it.
+     */
+    struct ThreadBuffer {
+        std::uint32_t threadID = 0;
+
+        // guarded by `registryMutex`, as it's read by other threads
+        std::string threadName;
+
+        std::array<Profiler::Event, Profiler::EVENTS_PER_THREAD> events{};
+
+        // total number of events ever written. it's only increased once an event is fully written,
+        // so everything before it can be read by other threads
+        std::atomic<std::uint64_t> writeCount = 0;
+
+        // number of scopes the owning thread is currently in
+        std::uint32_t depth = 0;
+    };
+
+    const Clock::time_point epoch = Clock::now();
+
+    // buffers of all threads which ever recorded anything. they're kept after their threads exit,
+    // so that their scopes can still be shown and exported
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+
+    std::mutex framesMutex;
+    std::deque<std::uint64_t> frameStarts;
+
+    ThreadBuffer& getThreadBuffer() {
+        thread_local const std::shared_ptr<ThreadBuffer> buffer = [] {
+            auto newBuffer = std::make_shared<ThreadBuffer>();
+
+            std::lock_guard lock(registryMutex);
+            newBuffer->threadID = static_cast<std::uint32_t>(threadBuffers.size());
+            newBuffer->threadName = "thread " + std::to_string(newBuffer->threadID);
+            threadBuffers.push_back(newBuffer);
+
+            return newBuffer;
+        }();
+
+        return *buffer;
+    }
+
+    /**
+     * @return Copy of the events in a buffer which ended no earlier than at a given time, leaving out any
+     *         that were overwritten while they were being copied.
+     */
+    std::vector<Profiler::Event> copyEvents(const ThreadBuffer &buffer, const std::uint64_t fromNs) {
+        constexpr std::uint64_t capacity = Profiler::EVENTS_PER_THREAD;
+
+        const std::uint64_t end = buffer.writeCount.load(std::memory_order_acquire);
+        const std::uint64_t begin = end > capacity ? end - capacity : 0;
+
+        // events are written in the order in which they end, so we can stop at the first one which ended too early
+        std::vector<Profiler::Event> events;
+        std::uint64_t first = end;
+
+        while (first > begin) {
+            const Profiler::Event &event = buffer.events[(first - 1) % capacity];
+            if (event.endNs < fromNs) break;
+
+            events.push_back(event);
+            first--;
+        }
+
+        std::ranges::reverse(events);
+
+        // the owning thread kept writing while we were copying, so the oldest events might have been
+        // overwritten halfway through. those are dropped, along with the one in the slot the owning thread
+        // might be writing right now, as `writeCount` is only increased after the write is done
+        const std::uint64_t endAfterCopy = buffer.writeCount.load(std::memory_order_acquire);
+        const std::uint64_t firstIntact = endAfterCopy + 1 > capacity ? endAfterCopy + 1 - capacity : 0;
+
+        if (firstIntact > first) {
+            const auto overwrittenCount = static_cast<std::ptrdiff_t>(std::min<std::uint64_t>(firstIntact - first,
+                                                                                               events.size()));
+            events.erase(events.begin(), events.begin() + overwrittenCount);
+        }
+
+        return events;
+    }
+}
+
+std::atomic<bool> Profiler::enabled = true;
+
+Profiler::Scope::Scope(const char *n) : name(n), isActive(isEnabled()) {
+    if (!isActive) return;
+
+    getThreadBuffer().depth++;
+    startNs = now();
+}
+
+Profiler::Scope::~Scope() {
+    if (!isActive) return;
+
+    const std::uint64_t endNs = now();
+    ThreadBuffer &buffer = getThreadBuffer();
+    buffer.depth--;
+
+    const std::uint64_t index = buffer.writeCount.load(std::memory_order_relaxed);
+    buffer.events[index % EVENTS_PER_THREAD] = {name, startNs, endNs, buffer.depth};
+    buffer.writeCount.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const std::string &name) {
+    ThreadBuffer &buffer = getThreadBuffer();
+
+    std::lock_guard lock(registryMutex);
+    buffer.threadName = name;
+}
+
+void Profiler::markFrame() {
+    const std::uint64_t time = now();
+
+    std::lock_guard lock(framesMutex);
+    frameStarts.push_back(time);
+
+    if (frameStarts.size() > FRAME_HISTORY) {
+        frameStarts.pop_front();
+    }
+}
+
+std::vector<std::uint64_t> Profiler::getFrameStarts() {
+    std::lock_guard lock(framesMutex);
+    return {frameStarts.begin(), frameStarts.end()};
+}
+
+std::vector<Profiler::ThreadEvents> Profiler::collect(const std::uint64_t fromNs, const std::uint64_t toNs) {
+    std::vector<ThreadEvents> result;
+    std::lock_guard lock(registryMutex);
+
+    for (const auto &buffer: threadBuffers) {
+        ThreadEvents threadEvents{buffer->threadID, buffer->threadName, copyEvents(*buffer, fromNs)};
+
+        std::erase_if(threadEvents.events, [&](const Event &event) { return event.startNs > toNs; });
+
+        if (!threadEvents.events.empty()) {
+            result.push_back(std::move(threadEvents));
+        }
+    }
+
+    return result;
+}
+
+void Profiler::exportChromeTrace(const std::filesystem::path &path) {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("failed to open file " + path.string() + " in Profiler::exportChromeTrace()");
+    }
+
+    const auto toMicroseconds = [](const std::uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"traceEvents\": [\n";
+
+    bool isFirst = true;
+    const auto separate = [&] {
+        file << (isFirst ? "" : ",\n");
+        isFirst = false;
+    };
+
+    for (const auto &[threadID, threadName, events]: collect(0, UINT64_MAX)) {
+        separate();
+        file << R"({"name": "thread_name", "ph": "M", "pid": 0, "tid": )" << threadID
+             << R"(, "args": {"name": ")" << threadName << "\"}}";
+
+        for (const Event &event: events) {
+            separate();
+            file << R"({"name": ")" << event.name << R"(", "ph": "X", "pid": 0, "tid": )" << threadID
+                 << ", \"ts\": " << toMicroseconds(event.startNs)
+                 << ", \"dur\": " << toMicroseconds(event.endNs - event.startNs) << "}";
+        }
+    }
+
+    for (const std::uint64_t frameStart: getFrameStarts()) {
+        separate();
+        file << R"({"name": "frame", "ph": "i", "s": "g", "pid": 0, "tid": 0, "ts": )"
+             << toMicroseconds(frameStart) << "}";
+    }
+
+    file << "\n]}\n";
+}
+
+std::uint64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count();
+}
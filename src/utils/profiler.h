@@ -0,0 +1,130 @@
+#ifndef VOXEL_PROFILER_H
+#define VOXEL_PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+/*
+ * Scopes are only measured if the program is built with `VOXEL_PROFILING` defined. Otherwise, the macros
+ * expand to nothing, so instrumented code doesn't pay anything for them.
+ */
+#ifdef VOXEL_PROFILING
+#define VOXEL_PROFILE_CONCAT_INNER(a, b) a##b
+#define VOXEL_PROFILE_CONCAT(a, b) VOXEL_PROFILE_CONCAT_INNER(a, b)
+
+/**
+ * Measures the rest of the enclosing scope under a given name, which has to be a string literal.
+ */
+#define VOXEL_PROFILE_SCOPE(name) const Profiler::Scope VOXEL_PROFILE_CONCAT(profileScope, __LINE__)(name)
+
+/**
+ * Marks the start of a new frame. Should be called by the render thread only.
+ */
+#define VOXEL_PROFILE_FRAME() Profiler::markFrame()
+#else
+#define VOXEL_PROFILE_SCOPE(name) ((void) 0)
+#define VOXEL_PROFILE_FRAME() ((void) 0)
+#endif
+
+/**
+ * Hierarchical CPU profiler, recording when each measured scope started and ended, on every thread.
+ *
+ * Each thread records its scopes into its own ring buffer, which only that thread writes into, without
+ * taking any locks. Readers copy the buffers out and drop whatever the writer might have overwritten
+ * while they were doing so. Only the most recent `EVENTS_PER_THREAD` scopes of each thread are kept.
+ *
+ * Timestamps are in nanoseconds since the profiler was first used.
+ */
+class Profiler {
+public:
+    static constexpr size_t EVENTS_PER_THREAD = 1 << 14;
+    static constexpr size_t FRAME_HISTORY = 256;
+
+    struct Event {
+        // name given to the scope, always a string literal
+        const char *name;
+        std::uint64_t startNs;
+        std::uint64_t endNs;
+
+        // number of measured scopes enclosing this one on the same thread
+        std::uint32_t depth;
+    };
+
+    struct ThreadEvents {
+        std::uint32_t threadID;
+        std::string threadName;
+
+        // ordered by the time at which the scopes ended, so children come before their parents
+        std::vector<Event> events;
+    };
+
+    /**
+     * Measures the time between its construction and destruction.
+     */
+    class Scope {
+        const char *name;
+        std::uint64_t startNs = 0;
+        bool isActive;
+
+    public:
+        explicit Scope(const char *n);
+
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+    static std::atomic<bool> enabled;
+
+public:
+    /**
+     * Pauses or resumes recording. Scopes which were entered while recording was paused aren't recorded.
+     */
+    static void setEnabled(const bool b) { enabled.store(b, std::memory_order_relaxed); }
+
+    [[nodiscard]]
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * Names the calling thread in the timeline and in exported traces.
+     */
+    static void setThreadName(const std::string &name);
+
+    /**
+     * Records the start of a new frame.
+     */
+    static void markFrame();
+
+    /**
+     * @return Start times of the most recent frames, from the oldest one.
+     */
+    [[nodiscard]]
+    static std::vector<std::uint64_t> getFrameStarts();
+
+    /**
+     * @return Recorded scopes of all threads which overlap a given time range. Threads without any such scopes
+     *         are left out.
+     */
+    [[nodiscard]]
+    static std::vector<ThreadEvents> collect(std::uint64_t fromNs, std::uint64_t toNs);
+
+    /**
+     * Writes all recorded scopes into a file in Chrome's trace event format, which can be opened
+     * in `chrome://tracing` or Perfetto.
+     */
+    static void exportChromeTrace(const std::filesystem::path &path);
+
+    /**
+     * @return The current time, in the same units as recorded timestamps.
+     */
+    [[nodiscard]]
+    static std::uint64_t now();
+};
+
+#endif //VOXEL_PROFILER_H
@@ -0,0 +1,63 @@
+#include "thread-pool.h"
+
+#include <string>
+
+#include "profiler.h"
+
+ThreadPool::ThreadPool(const size_t threadCount) {
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        isStopping = true;
+    }
+
+    condition.notify_all();
+
+    for (auto &worker: workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard lock(mutex);
+        tasks.push(std::move(task));
+    }
+
+    condition.notify_one();
+}
+
+size_t ThreadPool::getQueuedCount() const {
+    std::lock_guard lock(mutex);
+    return tasks.size();
+}
+
+size_t ThreadPool::getDefaultThreadCount() {
+    const size_t hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 2 ? hardwareThreads - 1 : 1;
+}
+
+void ThreadPool::workerLoop(const size_t index) {
+    Profiler::setThreadName("worker " + std::to_string(index));
+
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [&] { return isStopping || !tasks.empty(); });
+
+            if (isStopping) return;
+
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef VOXEL_THREAD_POOL_H
+#define VOXEL_THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed-size pool of worker threads executing submitted tasks in FIFO order.
+ * Tasks which are still waiting in the queue when the pool is destroyed are discarded,
+ * while tasks which are already running are allowed to finish.
+ */
+class ThreadPool {
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    bool isStopping = false;
+
+public:
+    explicit ThreadPool(size_t threadCount);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Schedules a task to be executed by one of the worker threads.
+     */
+    void enqueue(std::function<void()> task);
+
+    /**
+     * @return Number of tasks which were submitted, but not yet picked up by any worker.
+     */
+    [[nodiscard]]
+    size_t getQueuedCount() const;
+
+    [[nodiscard]]
+    size_t getThreadCount() const { return workers.size(); }
+
+    /**
+     * @return Number of threads worth spawning on this machine, leaving one core for the render thread.
+     */
+    [[nodiscard]]
+    static size_t getDefaultThreadCount();
+
+private:
+    void workerLoop(size_t index);
+};
+
+#endif //VOXEL_THREAD_POOL_H
@@ -0,0 +1,58 @@
+#ifndef VOXEL_TOROIDAL_GRID_H
+#define VOXEL_TOROIDAL_GRID_H
+
+#include <bit>
+#include <cstddef>
+#include <vector>
+#include "glm/vec3.hpp"
+
+/**
+ * Flat 3-dimensional array addressed by unbounded integer coordinates, which wrap around modulo its width.
+ *
+ * This is meant for indexing things in a window moving around a larger space: as long as the window is
+ * narrower than the grid, no two positions inside of it share a cell, and moving the window doesn't require
+ * moving anything that stays inside of it. Since a cell may just as well be shared with a position outside
+ * the window, users need to verify that a looked up element is actually the one at the requested position.
+ *
+ * The width is rounded up to a power of two, so that wrapping is a single bitwise operation.
+ *
+ * @tparam T Element type.
+ */
+template<typename T>
+class ToroidalGrid {
+    size_t width = 0;
+    int mask = 0;
+    std::vector<T> cells;
+
+public:
+    ToroidalGrid() = default;
+
+    /**
+     * @param minWidth Minimal width of the grid, i.e. the width of the widest window it should be able to hold.
+     */
+    explicit ToroidalGrid(const size_t minWidth)
+        : width(std::bit_ceil(minWidth)), mask(static_cast<int>(width) - 1), cells(width * width * width) {}
+
+    [[nodiscard]]
+    size_t getWidth() const { return width; }
+
+    const T& operator[](const glm::ivec3 &pos) const {
+        return cells[getIndex(pos)];
+    }
+
+    T& operator[](const glm::ivec3 &pos) {
+        return cells[getIndex(pos)];
+    }
+
+private:
+    [[nodiscard]]
+    size_t getIndex(const glm::ivec3 &pos) const {
+        // masking a two's complement integer yields its non-negative remainder, also for negative coordinates
+        const auto x = static_cast<size_t>(pos.x & mask);
+        const auto y = static_cast<size_t>(pos.y & mask);
+        const auto z = static_cast<size_t>(pos.z & mask);
+        return (x * width + y) * width + z;
+    }
+};
+
+#endif //VOXEL_TOROIDAL_GRID_H
@@ -1,8 +1,10 @@
 #ifndef VOXEL_VEC_H
 #define VOXEL_VEC_H
 
+#include <cstdint>
 #include <string>
 #include <functional>
+#include "glm/vec2.hpp"
 #include "glm/vec3.hpp"
 #include "glm/geometric.hpp"
 
@@ -10,12 +12,32 @@
  * Collection of various utils for handling GLM 3-dimensional vectors.
  */
 namespace VecUtils {
+    /**
+     * Hashes vectors by mixing the hashes of their components. `std::hash` of an integer is often the integer
+     * itself, so simply xor-ing those together makes small, nearby coordinates like chunk positions collide a lot.
+     */
     struct VecHash {
-        size_t operator()(const glm::vec3 &a) const {
-            const size_t h1 = std::hash<double>()(a.x);
-            const size_t h2 = std::hash<double>()(a.y);
-            const size_t h3 = std::hash<double>()(a.z);
-            return (h1 ^ (h2 << 1)) ^ h3;
+        template<typename T>
+        size_t operator()(const glm::vec<3, T> &a) const {
+            return combine(combine(combine(0, a.x), a.y), a.z);
+        }
+
+        template<typename T>
+        size_t operator()(const glm::vec<2, T> &a) const {
+            return combine(combine(0, a.x), a.y);
+        }
+
+    private:
+        /**
+         * @return Hash of a value mixed into a given seed, using the finalizer of splitmix64.
+         */
+        template<typename T>
+        static size_t combine(const size_t seed, const T &value) {
+            std::uint64_t h = seed ^ std::hash<T>()(value);
+            h += 0x9e3779b97f4a7c15ULL;
+            h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+            return static_cast<size_t>(h ^ (h >> 31));
         }
     };
 
@@ -0,0 +1,297 @@
+#include "batch-perlin.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "libnoise/interp.h"
+#include "noise-graph.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define VOXEL_HAS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(VOXEL_HAS_X86) && (defined(__GNUC__) || defined(__clang__))
+// lets the compiler emit AVX2 instructions in single functions only, without requiring them everywhere else.
+// FMA is deliberately left out, as fused multiply-adds would round differently than libnoise does
+#define VOXEL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define VOXEL_TARGET_AVX2
+#endif
+
+using NoiseGraph::detail::GRADIENTS;
+using NoiseGraph::detail::X_NOISE_GEN;
+using NoiseGraph::detail::Y_NOISE_GEN;
+using NoiseGraph::detail::Z_NOISE_GEN;
+using NoiseGraph::detail::SEED_NOISE_GEN;
+using NoiseGraph::detail::SHIFT_NOISE_GEN;
+
+// coordinates at or beyond which `noise::MakeInt32Range` changes them
+static constexpr double INT32_RANGE_LIMIT = 1073741824.0;
+
+#ifdef VOXEL_HAS_X86
+static bool isAvx2Supported() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+
+    // the OS also has to preserve the upper halves of the vector registers
+    __cpuid(info, 1);
+    const bool hasOsxsave = info[2] & (1 << 27);
+    const bool hasAvx = info[2] & (1 << 28);
+    if (!hasOsxsave || !hasAvx || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+/**
+ * Vector counterpart of `sCurve`.
+ */
+VOXEL_TARGET_AVX2
+static __m256d sCurveAvx2(const __m256d a, const noise::NoiseQuality quality) {
+    switch (quality) {
+        case noise::QUALITY_FAST:
+            return a;
+        case noise::QUALITY_STD: {
+            const __m256d t = _mm256_sub_pd(_mm256_set1_pd(3.0), _mm256_mul_pd(_mm256_set1_pd(2.0), a));
+            return _mm256_mul_pd(_mm256_mul_pd(a, a), t);
+        }
+        default: {
+            const __m256d a3 = _mm256_mul_pd(_mm256_mul_pd(a, a), a);
+            const __m256d a4 = _mm256_mul_pd(a3, a);
+            const __m256d a5 = _mm256_mul_pd(a4, a);
+            const __m256d t = _mm256_sub_pd(_mm256_mul_pd(_mm256_set1_pd(6.0), a5),
+                                            _mm256_mul_pd(_mm256_set1_pd(15.0), a4));
+            return _mm256_add_pd(t, _mm256_mul_pd(_mm256_set1_pd(10.0), a3));
+        }
+    }
+}
+
+VOXEL_TARGET_AVX2
+static __m256d linearInterpAvx2(const __m256d n0, const __m256d n1, const __m256d a) {
+    return _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(_mm256_set1_pd(1.0), a), n0), _mm256_mul_pd(a, n1));
+}
+
+/**
+ * Vector counterpart of `gradientNoise`, taking the lattice point's partial hashes instead of its coordinates.
+ */
+VOXEL_TARGET_AVX2
+static __m256d gradientNoiseAvx2(const __m256d px, const __m256d py, const __m256d pz, const __m128i hash) {
+    __m128i vectorIndex = _mm_xor_si128(hash, _mm_srai_epi32(hash, SHIFT_NOISE_GEN));
+    vectorIndex = _mm_slli_epi32(_mm_and_si128(vectorIndex, _mm_set1_epi32(0xff)), 2);
+
+    const __m256d gx = _mm256_i32gather_pd(GRADIENTS, vectorIndex, 8);
+    const __m256d gy = _mm256_i32gather_pd(GRADIENTS + 1, vectorIndex, 8);
+    const __m256d gz = _mm256_i32gather_pd(GRADIENTS + 2, vectorIndex, 8);
+
+    const __m256d dot = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(gx, px), _mm256_mul_pd(gy, py)),
+                                      _mm256_mul_pd(gz, pz));
+    return _mm256_mul_pd(dot, _mm256_set1_pd(2.12));
+}
+
+/**
+ * Lattice data of four points along a single axis.
+ */
+struct AxisLatticeAvx2 {
+    __m256d offset0; // point's offsets from the lower and upper lattice coordinates
+    __m256d offset1;
+    __m128i hash0; // lower and upper lattice coordinates' contributions to the hash
+    __m128i hash1;
+    __m256d curve; // interpolation weight
+};
+
+VOXEL_TARGET_AVX2
+static AxisLatticeAvx2 makeAxisLatticeAvx2(const __m256d coord, const std::uint32_t hashFactor,
+                                           const noise::NoiseQuality quality) {
+    // truncate, then step down unless the coordinate was positive
+    const __m256d truncated = _mm256_round_pd(coord, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    const __m256d isPositive = _mm256_cmp_pd(coord, _mm256_setzero_pd(), _CMP_GT_OQ);
+    const __m256d lower = _mm256_sub_pd(truncated, _mm256_andnot_pd(isPositive, _mm256_set1_pd(1.0)));
+
+    const __m128i lowerInt = _mm256_cvttpd_epi32(lower);
+    const __m128i factor = _mm_set1_epi32(static_cast<int>(hashFactor));
+
+    AxisLatticeAvx2 result;
+    result.offset0 = _mm256_sub_pd(coord, lower);
+    result.offset1 = _mm256_sub_pd(coord, _mm256_add_pd(lower, _mm256_set1_pd(1.0)));
+    result.hash0 = _mm_mullo_epi32(lowerInt, factor);
+    result.hash1 = _mm_add_epi32(result.hash0, factor);
+    result.curve = sCurveAvx2(result.offset0, quality);
+    return result;
+}
+
+/**
+ * Interpolates between the noise at a pair of lattice points differing only in their x coordinates.
+ */
+VOXEL_TARGET_AVX2
+static __m256d interpXAvx2(const AxisLatticeAvx2 &lx, const __m256d py, const __m128i hy, const __m256d pz,
+                           const __m128i hz, const __m128i seedHash) {
+    const __m128i hyz = _mm_add_epi32(_mm_add_epi32(hy, hz), seedHash);
+    const __m256d n0 = gradientNoiseAvx2(lx.offset0, py, pz, _mm_add_epi32(lx.hash0, hyz));
+    const __m256d n1 = gradientNoiseAvx2(lx.offset1, py, pz, _mm_add_epi32(lx.hash1, hyz));
+    return linearInterpAvx2(n0, n1, lx.curve);
+}
+
+/**
+ * Vector counterpart of `coherentNoise`.
+ */
+VOXEL_TARGET_AVX2
+static __m256d coherentNoiseAvx2(const __m256d x, const __m256d y, const __m256d z, const int seed,
+                                 const noise::NoiseQuality quality) {
+    const AxisLatticeAvx2 lx = makeAxisLatticeAvx2(x, X_NOISE_GEN, quality);
+    const AxisLatticeAvx2 ly = makeAxisLatticeAvx2(y, Y_NOISE_GEN, quality);
+    const AxisLatticeAvx2 lz = makeAxisLatticeAvx2(z, Z_NOISE_GEN, quality);
+
+    const __m128i seedHash = _mm_set1_epi32(static_cast<int>(SEED_NOISE_GEN * static_cast<std::uint32_t>(seed)));
+
+    const __m256d iy0 = linearInterpAvx2(interpXAvx2(lx, ly.offset0, ly.hash0, lz.offset0, lz.hash0, seedHash),
+                                         interpXAvx2(lx, ly.offset1, ly.hash1, lz.offset0, lz.hash0, seedHash),
+                                         ly.curve);
+    const __m256d iy1 = linearInterpAvx2(interpXAvx2(lx, ly.offset0, ly.hash0, lz.offset1, lz.hash1, seedHash),
+                                         interpXAvx2(lx, ly.offset1, ly.hash1, lz.offset1, lz.hash1, seedHash),
+                                         ly.curve);
+
+    return linearInterpAvx2(iy0, iy1, lz.curve);
+}
+
+/**
+ * Applies `noise::MakeInt32Range` to all lanes. Coordinates this large practically never appear,
+ * so the lanes are only spilled to memory if any of them needs changing.
+ */
+VOXEL_TARGET_AVX2
+static __m256d makeInt32RangeAvx2(const __m256d coord) {
+    const __m256d absCoord = _mm256_andnot_pd(_mm256_set1_pd(-0.0), coord);
+    const __m256d isOutOfRange = _mm256_cmp_pd(absCoord, _mm256_set1_pd(INT32_RANGE_LIMIT), _CMP_GE_OQ);
+
+    if (!_mm256_movemask_pd(isOutOfRange)) return coord;
+
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, coord);
+
+    for (double &lane: lanes) {
+        lane = noise::MakeInt32Range(lane);
+    }
+
+    return _mm256_load_pd(lanes);
+}
+
+VOXEL_TARGET_AVX2
+static void evaluateAvx2(const double *xs, const double *ys, const double *zs, double *out, const size_t count,
+                         const NoiseGraph::Perlin &perlin) {
+    const __m256d frequency = _mm256_set1_pd(perlin.frequency);
+    const __m256d lacunarity = _mm256_set1_pd(perlin.lacunarity);
+
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m256d x = _mm256_mul_pd(_mm256_loadu_pd(xs + i), frequency);
+        __m256d y = _mm256_mul_pd(_mm256_loadu_pd(ys + i), frequency);
+        __m256d z = _mm256_mul_pd(_mm256_loadu_pd(zs + i), frequency);
+
+        __m256d value = _mm256_setzero_pd();
+        double curPersistence = 1.0;
+
+        for (int octave = 0; octave < perlin.octaveCount; octave++) {
+            const int seed = NoiseGraph::detail::octaveSeed(perlin.seed, octave);
+            const __m256d signal = coherentNoiseAvx2(makeInt32RangeAvx2(x), makeInt32RangeAvx2(y),
+                                                     makeInt32RangeAvx2(z), seed, perlin.quality);
+            value = _mm256_add_pd(value, _mm256_mul_pd(signal, _mm256_set1_pd(curPersistence)));
+
+            x = _mm256_mul_pd(x, lacunarity);
+            y = _mm256_mul_pd(y, lacunarity);
+            z = _mm256_mul_pd(z, lacunarity);
+            curPersistence *= perlin.persistence;
+        }
+
+        _mm256_storeu_pd(out + i, value);
+    }
+
+    for (; i < count; i++) {
+        out[i] = perlin.getValue(xs[i], ys[i], zs[i]);
+    }
+}
+#endif
+
+BatchPerlin::BatchPerlin(const noise::module::Perlin &module, const bool allowSimd)
+    : BatchPerlin(NoiseGraph::Perlin{
+                      .frequency = module.GetFrequency(),
+                      .lacunarity = module.GetLacunarity(),
+                      .persistence = module.GetPersistence(),
+                      .octaveCount = module.GetOctaveCount(),
+                      .seed = module.GetSeed(),
+                      .quality = module.GetNoiseQuality()
+                  }, allowSimd) {}
+
+BatchPerlin::BatchPerlin(const NoiseGraph::Perlin &p, const bool allowSimd)
+    : perlin(p), useSimd(false) {
+#ifdef VOXEL_HAS_X86
+    useSimd = allowSimd && isAvx2Supported();
+#else
+    (void) allowSimd;
+#endif
+}
+
+void BatchPerlin::evaluate(const std::span<const double> xs, const std::span<const double> ys,
+                           const std::span<const double> zs, const std::span<double> out) const {
+    if (xs.size() != out.size() || ys.size() != out.size() || zs.size() != out.size()) {
+        throw std::runtime_error("mismatched sizes of coordinate and output spans in BatchPerlin::evaluate");
+    }
+
+#ifdef VOXEL_HAS_X86
+    if (useSimd) {
+        evaluateAvx2(xs.data(), ys.data(), zs.data(), out.data(), out.size(), perlin);
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < out.size(); i++) {
+        out[i] = perlin.getValue(xs[i], ys[i], zs[i]);
+    }
+}
+
+void BatchPerlin::evaluatePlane(const double lowerX, const double lowerZ, const double upperX, const double upperZ,
+                                const int width, const int height, const std::span<float> out) const {
+    if (width <= 0 || height <= 0 || out.size() != static_cast<size_t>(width) * static_cast<size_t>(height)) {
+        throw std::runtime_error("invalid grid size in BatchPerlin::evaluatePlane");
+    }
+
+    // coordinates are stepped by accumulating deltas rather than by multiplying them,
+    // so that rounding matches `NoiseMapBuilderPlane`
+    const double xDelta = (upperX - lowerX) / static_cast<double>(width);
+    const double zDelta = (upperZ - lowerZ) / static_cast<double>(height);
+
+    std::vector<double> xs(width);
+    double xCur = lowerX;
+
+    for (int x = 0; x < width; x++) {
+        xs[x] = xCur;
+        xCur += xDelta;
+    }
+
+    // whole rows are evaluated at once, as each one shares the x coordinates and lies at a single z coordinate
+    const std::vector<double> ys(width, 0.0);
+    std::vector<double> zs(width);
+    std::vector<double> values(width);
+    double zCur = lowerZ;
+
+    for (int z = 0; z < height; z++) {
+        std::ranges::fill(zs, zCur);
+        evaluate(xs, ys, zs, values);
+
+        for (int x = 0; x < width; x++) {
+            out[z * width + x] = static_cast<float>(values[x]);
+        }
+
+        zCur += zDelta;
+    }
+}
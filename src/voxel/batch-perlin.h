@@ -0,0 +1,64 @@
+#ifndef VOXEL_BATCH_PERLIN_H
+#define VOXEL_BATCH_PERLIN_H
+
+#include <span>
+
+#include "libnoise/noise.h"
+#include "noise-graph.h"
+
+/**
+ * Evaluator of `noise::module::Perlin` (or `NoiseGraph::Perlin`) noise at many points at once.
+ *
+ * This follows libnoise's algorithm operation by operation and uses its gradient table, so that results match
+ * the module's `GetValue` (exactly, as long as the compiler doesn't fuse multiplications and additions),
+ * but it avoids the module's per-point virtual calls. Where AVX2 is available, four points are evaluated
+ * at once, gathering gradients of all of them with a single instruction. Otherwise, a scalar implementation
+ * of the same algorithm is used.
+ */
+class BatchPerlin {
+    NoiseGraph::Perlin perlin;
+
+    bool useSimd;
+
+public:
+    /**
+     * @param module Module whose settings should be used.
+     * @param allowSimd Whether SIMD instructions may be used if the CPU supports them.
+     */
+    explicit BatchPerlin(const noise::module::Perlin &module, bool allowSimd = true);
+
+    /**
+     * @param p Settings of the noise.
+     * @param allowSimd Whether SIMD instructions may be used if the CPU supports them.
+     */
+    explicit BatchPerlin(const NoiseGraph::Perlin &p, bool allowSimd = true);
+
+    /**
+     * @return Whether the AVX2 implementation is used.
+     */
+    [[nodiscard]]
+    bool isUsingSimd() const { return useSimd; }
+
+    /**
+     * Evaluates the noise at given points, writing the results to `out`. All spans need to be of the same size.
+     */
+    void evaluate(std::span<const double> xs, std::span<const double> ys, std::span<const double> zs,
+                  std::span<double> out) const;
+
+    /**
+     * Evaluates the noise on a grid of points in the y = 0 plane, just like `noiseutils::NoiseMapBuilderPlane`
+     * (without seamless tiling) does, including the way it steps between points.
+     *
+     * @param lowerX Lowest x coordinate of the grid.
+     * @param lowerZ Lowest z coordinate of the grid.
+     * @param upperX Upper bound of the grid's x coordinates, itself excluded.
+     * @param upperZ Upper bound of the grid's z coordinates, itself excluded.
+     * @param width Number of points along the x axis.
+     * @param height Number of points along the z axis.
+     * @param out Results, indexed by `[z * width + x]`.
+     */
+    void evaluatePlane(double lowerX, double lowerZ, double upperX, double upperZ, int width, int height,
+                       std::span<float> out) const;
+};
+
+#endif //VOXEL_BATCH_PERLIN_H
@@ -19,6 +19,12 @@ enum EBlockType : std::uint8_t {
     BlockType_NumTypes
 };
 
+/**
+ * Flat lookup table of texture sampler IDs used by each face of each block type,
+ * indexed by `[blockType][getFaceIndex(face)]`.
+ */
+using BlockSamplerTable = std::array<std::array<int, N_FACES>, BlockType_NumTypes>;
+
 class Block {
 public:
     /**
@@ -145,4 +145,23 @@ static glm::uint32 getFaceIndex(const EBlockFace face) {
     }
 }
 
+static EBlockFace getOppositeFace(const EBlockFace face) {
+    switch (face) {
+        case Front:
+            return Back;
+        case Back:
+            return Front;
+        case Right:
+            return Left;
+        case Left:
+            return Right;
+        case Top:
+            return Bottom;
+        case Bottom:
+            return Top;
+        default:
+            throw std::runtime_error("invalid face value in getOppositeFace()");
+    }
+}
+
 #endif //FACE_H
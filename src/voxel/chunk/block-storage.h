@@ -0,0 +1,225 @@
+#ifndef VOXEL_BLOCK_STORAGE_H
+#define VOXEL_BLOCK_STORAGE_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "src/voxel/block/block.h"
+#include "src/utils/cube-array.h"
+
+/**
+ * Compressed storage of a cube of blocks, keeping a palette of block types present in the cube
+ * and a bit-packed index into this palette for each block.
+ *
+ * Cubes consisting of a single block type (which are most of them, like chunks of air high above
+ * the terrain or of stone deep below) don't allocate anything apart from the object itself.
+ * Other cubes use the smallest power-of-two number of bits per block able to index the whole palette,
+ * so that an index never straddles two words. The palette only ever grows when blocks are updated;
+ * `compact` can be used to shrink it again.
+ *
+ * @tparam S Size of the cube.
+ */
+template<size_t S>
+class BlockStorage {
+    using Word = std::uint64_t;
+
+    static constexpr size_t WORD_BITS = 8 * sizeof(Word);
+    static constexpr size_t BLOCK_COUNT = S * S * S;
+
+    // type of all blocks in the cube, valid only when `bitsPerIndex == 0`
+    EBlockType uniformType = BlockType_None;
+
+    std::vector<EBlockType> palette;
+    std::vector<Word> indices;
+    size_t bitsPerIndex = 0;
+
+public:
+    explicit BlockStorage(const EBlockType type = BlockType_None) : uniformType(type) {}
+
+    [[nodiscard]]
+    bool isUniform() const { return bitsPerIndex == 0; }
+
+    /**
+     * @return Type of all blocks in the cube. This is only meaningful if `isUniform()` holds.
+     */
+    [[nodiscard]]
+    EBlockType getUniformType() const { return uniformType; }
+
+    [[nodiscard]]
+    EBlockType get(const size_t x, const size_t y, const size_t z) const {
+        if (isUniform()) return uniformType;
+        return palette[readIndex(flatten(x, y, z))];
+    }
+
+    void set(const size_t x, const size_t y, const size_t z, const EBlockType type) {
+        if (isUniform()) {
+            if (type == uniformType) return;
+
+            palette = {uniformType};
+            resizeIndices(1);
+        }
+
+        writeIndex(flatten(x, y, z), getOrAddPaletteIndex(type));
+    }
+
+    /**
+     * Sets all blocks in the cube to a given type, releasing all memory used for the palette.
+     */
+    void fill(const EBlockType type) {
+        uniformType = type;
+        bitsPerIndex = 0;
+        palette = std::vector<EBlockType>();
+        indices = std::vector<Word>();
+    }
+
+    /**
+     * Replaces the contents of this storage with the given blocks, using the smallest possible palette.
+     */
+    void assign(const CubeArray<Block, S> &blocks) {
+        std::array<bool, 256> isPresent{};
+        std::vector<EBlockType> newPalette;
+
+        for (size_t x = 0; x < S; x++) {
+            for (size_t y = 0; y < S; y++) {
+                for (size_t z = 0; z < S; z++) {
+                    const EBlockType type = blocks[x][y][z].blockType;
+
+                    if (!isPresent[type]) {
+                        isPresent[type] = true;
+                        newPalette.push_back(type);
+                    }
+                }
+            }
+        }
+
+        fill(newPalette[0]);
+        if (newPalette.size() == 1) return;
+
+        palette = std::move(newPalette);
+        indices.assign(getIndexWordCount(getBitsFor(palette.size())), 0);
+        bitsPerIndex = getBitsFor(palette.size());
+
+        std::array<Word, 256> paletteIndices{};
+        for (size_t i = 0; i < palette.size(); i++) {
+            paletteIndices[palette[i]] = i;
+        }
+
+        for (size_t x = 0; x < S; x++) {
+            for (size_t y = 0; y < S; y++) {
+                for (size_t z = 0; z < S; z++) {
+                    writeIndex(flatten(x, y, z), paletteIndices[blocks[x][y][z].blockType]);
+                }
+            }
+        }
+    }
+
+    /**
+     * Writes all blocks of the cube to a plain array.
+     */
+    void unpack(CubeArray<Block, S> &blocks) const {
+        for (size_t x = 0; x < S; x++) {
+            for (size_t y = 0; y < S; y++) {
+                for (size_t z = 0; z < S; z++) {
+                    blocks[x][y][z].blockType = get(x, y, z);
+                }
+            }
+        }
+    }
+
+    /**
+     * Rebuilds the palette so that it contains only the block types which are actually present,
+     * possibly turning the storage back into a uniform one.
+     */
+    void compact() {
+        if (isUniform()) return;
+
+        CubeArray<Block, S> blocks;
+        unpack(blocks);
+        assign(blocks);
+    }
+
+    /**
+     * @return Number of bytes used by this storage, including the object itself.
+     */
+    [[nodiscard]]
+    size_t getMemoryUsage() const {
+        return sizeof(*this) + palette.capacity() * sizeof(EBlockType) + indices.capacity() * sizeof(Word);
+    }
+
+private:
+    [[nodiscard]]
+    static size_t flatten(const size_t x, const size_t y, const size_t z) {
+        return (x * S + y) * S + z;
+    }
+
+    [[nodiscard]]
+    static size_t getBitsFor(const size_t paletteSize) {
+        size_t bits = 1;
+
+        while ((size_t{1} << bits) < paletteSize) {
+            bits *= 2;
+        }
+
+        return bits;
+    }
+
+    [[nodiscard]]
+    static size_t getIndexWordCount(const size_t bits) {
+        return (BLOCK_COUNT * bits + WORD_BITS - 1) / WORD_BITS;
+    }
+
+    [[nodiscard]]
+    Word readIndex(const size_t block) const {
+        const size_t bit = block * bitsPerIndex;
+        const Word mask = (Word{1} << bitsPerIndex) - 1;
+        return (indices[bit / WORD_BITS] >> (bit % WORD_BITS)) & mask;
+    }
+
+    void writeIndex(const size_t block, const Word index) {
+        const size_t bit = block * bitsPerIndex;
+        const Word mask = (Word{1} << bitsPerIndex) - 1;
+
+        Word &word = indices[bit / WORD_BITS];
+        word = (word & ~(mask << (bit % WORD_BITS))) | (index << (bit % WORD_BITS));
+    }
+
+    /**
+     * Finds a type in the palette, adding it if it's not there yet. Adding a type may require widening
+     * all indices, in which case they're repacked.
+     */
+    [[nodiscard]]
+    Word getOrAddPaletteIndex(const EBlockType type) {
+        for (size_t i = 0; i < palette.size(); i++) {
+            if (palette[i] == type) return i;
+        }
+
+        palette.push_back(type);
+
+        const size_t newBits = getBitsFor(palette.size());
+        if (newBits != bitsPerIndex) {
+            resizeIndices(newBits);
+        }
+
+        return palette.size() - 1;
+    }
+
+    /**
+     * Repacks all indices to use a given number of bits each.
+     */
+    void resizeIndices(const size_t newBits) {
+        std::vector<Word> newIndices(getIndexWordCount(newBits), 0);
+
+        if (bitsPerIndex != 0) {
+            for (size_t block = 0; block < BLOCK_COUNT; block++) {
+                const size_t bit = block * newBits;
+                newIndices[bit / WORD_BITS] |= readIndex(block) << (bit % WORD_BITS);
+            }
+        }
+
+        indices = std::move(newIndices);
+        bitsPerIndex = newBits;
+    }
+};
+
+#endif //VOXEL_BLOCK_STORAGE_H
@@ -6,11 +6,17 @@
 
 #include "chunk-manager.h"
 
-#include "src/render/renderer.h"
-#include "src/render/gui.h"
+#include "deps/imgui/imgui.h"
+#include "src/utils/profiler.h"
 #include "src/utils/size.h"
+#include "src/voxel/world-gen.h"
 
-void ChunkManager::ChunkSlot::bind(std::unique_ptr<Chunk>&& c) {
+static float millisecondsBetween(const std::chrono::steady_clock::time_point start,
+                                 const std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+void ChunkManager::ChunkSlot::bind(std::shared_ptr<Chunk>&& c) {
     if (isBound())
         throw std::runtime_error("tried to call bind() while already bound");
 
@@ -21,40 +27,55 @@ void ChunkManager::ChunkSlot::unbind() {
     if (!isBound())
         throw std::runtime_error("tried to call unbind() while not bound");
 
-    if (chunk->isLoaded()) {
+    // a pending chunk is still being worked on, so it's left alone -- its job's result is discarded later
+    if (!isPending && chunk->isLoaded()) {
         chunk->unload();
     }
 
     chunk = nullptr;
+    isPending = false;
+    isMeshing = false;
+    hasMesh = false;
+    isOccluded = false;
 }
 
-ChunkManager::ChunkManager(std::shared_ptr<OpenGLRenderer> r, std::shared_ptr<WorldGen> wg)
-    : renderer(std::move(r)), worldGen(std::move(wg)) {
+ChunkManager::ChunkManager(std::shared_ptr<ChunkRenderBackend> r, std::shared_ptr<WorldGen> wg,
+                           const std::filesystem::path &saveDirectory)
+    : chunkMeshLayout(r->getChunkMeshLayout()), blockSamplers(r->getBlockSamplerTable()),
+      renderer(std::move(r)), worldGen(std::move(wg)),
+      chunkStore(std::make_unique<ChunkStore>(saveDirectory)),
+      threadPool(std::make_unique<ThreadPool>(ThreadPool::getDefaultThreadCount())) {
 
     const size_t visibleAreaWidth = 2 * renderDistance + gracePeriodWidth + 1;
-    for (size_t i = 0; i < SizeUtils::pow(visibleAreaWidth, 3); i++) {
-        chunkSlots.emplace_back(std::make_shared<ChunkSlot>());
-    }
+    addChunkSlots(SizeUtils::pow(visibleAreaWidth, 3));
+    renderer->setRenderDistance(renderDistance);
 
+    rebuildSlotGrid();
     loadNearChunks();
     sortChunkSlots(loadableChunks);
 }
 
+ChunkManager::~ChunkManager() {
+    for (const auto &slot: chunkSlots) {
+        if (slot->isReady() && slot->chunk->isModified()) {
+            chunkStore->save(*slot->chunk);
+        }
+    }
+}
+
 void ChunkManager::renderChunks() const {
+    VOXEL_PROFILE_SCOPE("ChunkManager::renderChunks");
+
     if (renderer->shouldDrawShadows()) {
 
         std::vector<Chunk::ChunkID> targets;
 
         for (const auto &slot: chunkSlots) {
-            if (!slot->isBound())
+            if (!slot->isReady() || !slot->hasMesh)
                 continue;
-            if (!slot->chunk->shouldRender())
+            if (!slot->chunk->shouldRender() || slot->isOccluded)
                 continue;
 
-            if (slot->chunk->isDirty()) {
-                makeChunkMesh(*slot);
-            }
-
             targets.push_back(slot->chunk->getID());
         }
 
@@ -64,10 +85,6 @@ void ChunkManager::renderChunks() const {
     std::vector<Chunk::ChunkID> targets;
 
     for (const auto &slot: visibleChunks) {
-        if (slot->chunk->isDirty()) {
-            makeChunkMesh(*slot);
-        }
-
         targets.push_back(slot->chunk->getID());
     }
 
@@ -75,22 +92,21 @@ void ChunkManager::renderChunks() const {
 }
 
 void ChunkManager::renderChunkOutlines() const {
-    for (auto &slot: chunkSlots) {
-        if (!slot->isBound())
-            continue;
-
-        OpenGLRenderer::LineType lineType = OpenGLRenderer::CHUNK_OUTLINE;
-        if (std::ranges::find(visibleChunks, slot) == visibleChunks.end()) {
-            lineType = OpenGLRenderer::EMPTY_CHUNK_OUTLINE;
-        } else {
-            renderer->addChunkOutline(slot->chunk->getPos() * Chunk::CHUNK_SIZE, lineType);
-        }
+    // only visible chunks get outlined, so there's no need to look at the other slots at all
+    for (const auto &slot: visibleChunks) {
+        renderer->addChunkOutline(slot->chunk->getPos() * Chunk::CHUNK_SIZE);
     }
 }
 
 void ChunkManager::tick() {
+    VOXEL_PROFILE_SCOPE("ChunkManager::tick");
+
+    checkChunkMeshLayout();
     updateChunkSlots();
     updateLoadList();
+    uploadFinishedJobs();
+    updateOcclusion();
+    dispatchMeshJobs();
     updateRenderList();
 }
 
@@ -104,15 +120,61 @@ void ChunkManager::renderGuiSection() {
         ImGui::SameLine();
         if (ImGui::ArrowButton("cm_right1", ImGuiDir_Right)) { setRenderDistance(renderDistance + 1); }
 
-        ImGui::Text("Chunks served per frame: %d ", chunksServePerFrame);
+        ImGui::Text("Max jobs in flight: %d ", maxJobsInFlight);
         ImGui::SameLine();
-        if (ImGui::ArrowButton("cm_left2", ImGuiDir_Left)) { chunksServePerFrame = std::max(chunksServePerFrame - 1, 0); }
+        if (ImGui::ArrowButton("cm_left2", ImGuiDir_Left)) { maxJobsInFlight = std::max(maxJobsInFlight - 1, 1); }
         ImGui::SameLine();
-        if (ImGui::ArrowButton("cm_right2", ImGuiDir_Right)) { chunksServePerFrame++; }
+        if (ImGui::ArrowButton("cm_right2", ImGuiDir_Right)) { maxJobsInFlight++; }
+
+        ImGui::PushItemWidth(100.0f);
+        ImGui::DragFloat("upload budget (ms)", &uploadBudgetMs, 0.1f, 0.1f, 100.f, "%.1f");
+        ImGui::PopItemWidth();
+
+        ImGui::Text("Loadable chunks: %zu", loadableChunks.size());
+        ImGui::Text("Visible chunks: %zu", visibleChunks.size());
+        ImGui::Text("Chunk slots: %zu", chunkSlots.size());
+
+        ImGui::Text("Worker threads: %zu", threadPool->getThreadCount());
+        ImGui::Text("Queued jobs: %zu, in flight: %d", threadPool->getQueuedCount(), jobsInFlight);
+        ImGui::Text("Awaiting upload: %zu, uploaded last frame: %zu",
+                    uploadQueue.size(), lastFrameStats.uploads);
+        const auto [columnHits, columnMisses] = worldGen->getColumnCacheStats();
+        ImGui::Text("Height map columns: built %zu, reused %zu", columnMisses, columnHits);
+
+        ImGui::Text("Saved chunks waiting to be written: %zu", chunkStore->getPendingCount());
+        ImGui::Text("Edits waiting to be written: %zu, journal size: %.1f KB",
+                    chunkStore->getPendingEditCount(), static_cast<double>(chunkStore->getJournalSize()) / 1024.0);
+
+        bool doSyncWrites = chunkStore->getSyncPolicy() == SyncPolicy_Batch;
+        if (ImGui::Checkbox("sync writes to disk?", &doSyncWrites)) {
+            chunkStore->setSyncPolicy(doSyncWrites ? SyncPolicy_Batch : SyncPolicy_Never);
+        }
+        ImGui::Text("Latency (ms): wait %.2f, load %.2f, mesh %.2f, upload %.2f",
+                    pipelineStats.waitMs, pipelineStats.loadMs, pipelineStats.meshMs, pipelineStats.uploadMs);
+
+        size_t readyChunks = 0, uniformChunks = 0, blockBytes = 0;
+        for (const auto &slot: chunkSlots) {
+            if (!slot->isReady()) continue;
+
+            readyChunks++;
+            uniformChunks += slot->chunk->isUniform();
+            blockBytes += slot->chunk->getBlockMemoryUsage();
+        }
 
-        ImGui::Text("Loadable chunks: %d", loadableChunks.size());
-        ImGui::Text("Visible chunks: %d", visibleChunks.size());
-        ImGui::Text("Chunk slots: %d", chunkSlots.size());
+        constexpr size_t denseChunkBytes = Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE * sizeof(Block);
+        constexpr double bytesPerMB = 1024.0 * 1024.0;
+        ImGui::Text("Block memory: %.2f MB (dense: %.2f MB)",
+                    static_cast<double>(blockBytes) / bytesPerMB,
+                    static_cast<double>(readyChunks * denseChunkBytes) / bytesPerMB);
+        ImGui::Text("Uniform chunks: %zu / %zu", uniformChunks, readyChunks);
+
+        const size_t skippedChunks = skippedChunksStats.emptyChunks + skippedChunksStats.occludedChunks;
+        const float skippedPercentage = skippedChunksStats.readyChunks == 0
+                                            ? 0.f
+                                            : 100.f * static_cast<float>(skippedChunks)
+                                              / static_cast<float>(skippedChunksStats.readyChunks);
+        ImGui::Text("Skipped chunks: %.1f%% (empty: %zu, occluded: %zu)",
+                    skippedPercentage, skippedChunksStats.emptyChunks, skippedChunksStats.occludedChunks);
     }
 }
 
@@ -124,113 +186,450 @@ void ChunkManager::updateChunkSlots() {
     if (currChunkPos == lastOccupiedChunkPos)
         return;
 
+    const glm::ivec3 prevChunkPos = lastOccupiedChunkPos;
     lastOccupiedChunkPos = currChunkPos;
 
-    unloadFarChunks();
-    loadNearChunks();
+    unloadLeavingChunks(prevChunkPos);
+    loadEnteringChunks(prevChunkPos);
 }
 
-void ChunkManager::unloadFarChunks() {
-    for (const auto &slot: chunkSlots) {
-        if (!slot->isBound()) continue;
-
-        const glm::ivec3 chunkPosDist = VecUtils::abs(slot->chunk->getPos() - lastOccupiedChunkPos);
-        const bool isOutsideRenderDistance = VecUtils::any<float>(
-            chunkPosDist,
-            [&](const float x) { return x > static_cast<float>(renderDistance + gracePeriodWidth); }
-        );
+/**
+ * Calls `f` for every position lying within `radius` from `center` along each axis, but not within
+ * `excludedRadius` from `excludedCenter`. This takes time proportional to the number of such positions,
+ * instead of the number of all positions around `center`.
+ */
+template<typename F>
+static void forEachInBoxDifference(const glm::ivec3 &center, const int radius,
+                                   const glm::ivec3 &excludedCenter, const int excludedRadius, F &&f) {
+    const glm::ivec3 min = center - radius;
+    const glm::ivec3 max = center + radius;
+    const glm::ivec3 excludedMin = excludedCenter - excludedRadius;
+    const glm::ivec3 excludedMax = excludedCenter + excludedRadius;
+
+    // the difference is split into disjoint slabs, one per axis. positions in the slab of a given axis lie
+    // outside the excluded box along that axis, but inside of it along all previous axes
+    for (int axis = 0; axis < 3; axis++) {
+        glm::ivec3 from = min, to = max;
+
+        for (int prevAxis = 0; prevAxis < axis; prevAxis++) {
+            from[prevAxis] = std::max(min[prevAxis], excludedMin[prevAxis]);
+            to[prevAxis] = std::min(max[prevAxis], excludedMax[prevAxis]);
+        }
 
-        if (isOutsideRenderDistance) {
-            renderer->freeChunkMesh(slot->chunk->getID());
-            slot->unbind();
+        // the parts of the slab lying before and after the excluded box
+        const std::array<std::pair<int, int>, 2> ranges = {
+            std::make_pair(min[axis], std::min(max[axis], excludedMin[axis] - 1)),
+            std::make_pair(std::max(min[axis], excludedMax[axis] + 1), max[axis]),
+        };
+
+        for (const auto &[rangeFrom, rangeTo]: ranges) {
+            from[axis] = rangeFrom;
+            to[axis] = rangeTo;
+
+            for (int x = from.x; x <= to.x; x++) {
+                for (int y = from.y; y <= to.y; y++) {
+                    for (int z = from.z; z <= to.z; z++) {
+                        f(glm::ivec3(x, y, z));
+                    }
+                }
+            }
         }
     }
+}
 
-    erase_if(loadableChunks, [&](const ChunkSlotPtr &slot) {
-        return !slot->isBound() || VecUtils::any<float>(
-            VecUtils::abs(slot->chunk->getPos() - lastOccupiedChunkPos),
-            [&](const float x) { return x > static_cast<float>(renderDistance + gracePeriodWidth); }
-        );
-    });
+void ChunkManager::unloadLeavingChunks(const glm::ivec3 &prevChunkPos) {
+    // all bound chunks lie within this distance from the previous position, so only the slabs of chunks
+    // which are now too far away along the movement need to be checked
+    const int unloadDistance = renderDistance + gracePeriodWidth;
+
+    forEachInBoxDifference(prevChunkPos, unloadDistance, lastOccupiedChunkPos, unloadDistance,
+                           [&](const glm::ivec3 &chunkPos) {
+                               if (getSlot(chunkPos)) {
+                                   unbindSlot(slotGrid[chunkPos]);
+                               }
+                           });
+
+    erase_if(loadableChunks, [](const ChunkSlotPtr &slot) { return !slot->isBound(); });
 }
 
-void ChunkManager::loadNearChunks() {
-    const size_t newChunkLoadCubeWidth = 2 * renderDistance + 1;
-    CubeVector<uint8_t> loadedChunksMap{newChunkLoadCubeWidth}; // uint8_t instead of bool because vector<bool> sucks
+void ChunkManager::loadEnteringChunks(const glm::ivec3 &prevChunkPos) {
+    std::vector<ChunkSlotPtr> newChunks;
 
-    // check which positions, relative to ours, are occupied by loaded chunks
-    for (const auto &slot: chunkSlots) {
-        if (!slot->isBound()) continue;
+    // everything within render distance from the previous position was already bound
+    forEachInBoxDifference(lastOccupiedChunkPos, renderDistance, prevChunkPos, renderDistance,
+                           [&](const glm::ivec3 &chunkPos) {
+                               if (!getSlot(chunkPos)) {
+                                   newChunks.push_back(bindSlot(chunkPos));
+                               }
+                           });
+
+    sortChunkSlots(newChunks);
+
+    // chunks already waiting to be loaded stay sorted with respect to where the camera used to be,
+    // which is still a good enough order, so the new ones are just merged into them
+    const glm::vec3 cameraPos = renderer->getCameraPos();
+    std::vector<ChunkSlotPtr> mergedChunks;
+    mergedChunks.reserve(loadableChunks.size() + newChunks.size());
+
+    auto oldIt = loadableChunks.begin();
+    auto newIt = newChunks.begin();
 
-        const glm::ivec3 relPos = slot->chunk->getPos() - lastOccupiedChunkPos;
+    while (oldIt != loadableChunks.end() && newIt != newChunks.end()) {
+        if (getSquaredDistance(cameraPos, **newIt) < getSquaredDistance(cameraPos, **oldIt)) {
+            mergedChunks.push_back(std::move(*newIt++));
+        } else {
+            mergedChunks.push_back(std::move(*oldIt++));
+        }
+    }
 
-        // relPos shifted so that it's non-negative
-        const glm::ivec3 shiftedRelPos = relPos + renderDistance;
+    std::move(oldIt, loadableChunks.end(), std::back_inserter(mergedChunks));
+    std::move(newIt, newChunks.end(), std::back_inserter(mergedChunks));
+    loadableChunks = std::move(mergedChunks);
+}
 
-        // we're interested only in positions within render distance -- we don't care about chunks that are
-        // still loaded only because they're in the grace period
-        if (VecUtils::all<int>(shiftedRelPos, [&](const int x) { return x < newChunkLoadCubeWidth; })) {
-            loadedChunksMap[shiftedRelPos] = true;
+void ChunkManager::loadNearChunks() {
+    // we're interested only in positions within render distance -- we don't care about chunks that are
+    // still loaded only because they're in the grace period
+    for (int x = -renderDistance; x <= renderDistance; x++) {
+        for (int y = -renderDistance; y <= renderDistance; y++) {
+            for (int z = -renderDistance; z <= renderDistance; z++) {
+                const glm::ivec3 newChunkPos = lastOccupiedChunkPos + glm::ivec3(x, y, z);
+
+                if (!getSlot(newChunkPos)) {
+                    loadableChunks.push_back(bindSlot(newChunkPos));
+                }
+            }
         }
     }
 
-    // use the previously gathered information to load missing chunks to free slots
-    auto slotIt = chunkSlots.begin();
+    sortChunkSlots(loadableChunks);
+}
 
-    loadedChunksMap.forEach([&](const size_t x, const size_t y, const size_t z, const uint8_t &isLoaded) {
-        if (isLoaded) return;
+void ChunkManager::addChunkSlots(const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        chunkSlots.emplace_back(std::make_shared<ChunkSlot>());
+        freeSlots.push_back(chunkSlots.back());
+    }
+}
 
-        // chunk at `newChunkPos` is unloaded but should be -- we'll load it
-        const glm::ivec3 newChunkPos = lastOccupiedChunkPos + glm::ivec3(x, y, z) - renderDistance;
+ChunkManager::ChunkSlotPtr ChunkManager::bindSlot(const glm::ivec3 &chunkPos) {
+    if (freeSlots.empty())
+        throw std::runtime_error("ran out of free chunk slots in ChunkManager::bindSlot()");
 
-        // find a free slot and bind it with the new chunk
-        while ((*slotIt)->isBound()) {
-            slotIt++;
-        }
+    ChunkSlotPtr slot = std::move(freeSlots.back());
+    freeSlots.pop_back();
 
-        (*slotIt)->bind(std::make_unique<Chunk>(nextFreeID++, newChunkPos));
-        loadableChunks.push_back(*slotIt);
-    });
+    slot->bind(std::make_shared<Chunk>(nextFreeID++, chunkPos));
+    slotGrid[chunkPos] = slot;
+    return slot;
+}
 
-    sortChunkSlots(loadableChunks);
+void ChunkManager::unbindSlot(const ChunkSlotPtr &slot) {
+    const glm::ivec3 chunkPos = slot->chunk->getPos();
+
+    if (slot->isReady() && slot->chunk->isModified()) {
+        chunkStore->save(*slot->chunk);
+    }
+
+    renderer->freeChunkMesh(slot->chunk->getID());
+    slotGrid[chunkPos] = nullptr;
+    dirtyChunks.erase(slot);
+    slot->unbind();
+    freeSlots.push_back(slot);
+
+    // neighbours which are still loaded culled their faces against this chunk
+    markNeighboursDirty(chunkPos);
+    occlusionChangedChunks.push_back(chunkPos);
+}
+
+float ChunkManager::getSquaredDistance(const glm::vec3 &cameraPos, const ChunkSlot &slot) {
+    return glm::length2(cameraPos - static_cast<glm::vec3>(slot.chunk->getPos() * Chunk::CHUNK_SIZE));
 }
 
 void ChunkManager::sortChunkSlots(std::vector<ChunkSlotPtr>& chunks) const {
     const glm::vec3 cameraPos = renderer->getCameraPos();
 
     std::ranges::sort(chunks, [&](const ChunkSlotPtr &a, const ChunkSlotPtr &b) {
-        const auto aDist = glm::length2(cameraPos - static_cast<glm::vec3>(a->chunk->getPos() * Chunk::CHUNK_SIZE));
-        const auto bDist = glm::length2(cameraPos - static_cast<glm::vec3>(b->chunk->getPos() * Chunk::CHUNK_SIZE));
-        return aDist < bDist;
+        return getSquaredDistance(cameraPos, *a) < getSquaredDistance(cameraPos, *b);
     });
 }
 
 void ChunkManager::updateLoadList() {
-    int nChunksLoaded = 0;
-
     for (const ChunkSlotPtr &slot: loadableChunks) {
-        if (nChunksLoaded == chunksServePerFrame) {
+        if (jobsInFlight >= maxJobsInFlight) {
             break;
         }
 
-        if (!slot->chunk->isLoaded()) {
-            slot->chunk->generate(*worldGen); // todo - this should load from disk, not always generate.
-            makeChunkMesh(*slot);
-            nChunksLoaded++;
+        if (!slot->isPending && !slot->chunk->isLoaded()) {
+            dispatchLoadJob(slot);
+        }
+    }
+
+    erase_if(loadableChunks, [](const ChunkSlotPtr &slot) { return slot->isPending || slot->chunk->isLoaded(); });
+}
+
+void ChunkManager::dispatchLoadJob(const ChunkSlotPtr &slot) {
+    slot->isPending = true;
+    jobsInFlight++;
+
+    const Clock::time_point dispatchTime = Clock::now();
+
+    threadPool->enqueue([this, slot, chunk = slot->chunk, dispatchTime] {
+        const Clock::time_point startTime = Clock::now();
+
+        // chunks which were saved don't need to be generated at all
+        if (!chunkStore->load(*chunk)) {
+            chunk->generate(*worldGen);
+        }
+
+        chunkStore->replayEdits(*chunk);
+
+        ChunkJobResult result{
+            .slot = slot,
+            .chunk = chunk,
+            .mesh = nullptr,
+            .layout = ChunkMeshLayout_Indexed,
+            .waitMs = millisecondsBetween(dispatchTime, startTime),
+            .loadMs = millisecondsBetween(startTime, Clock::now()),
+            .meshMs = 0.f,
+        };
+
+        std::lock_guard lock(finishedJobsMutex);
+        finishedJobs.push_back(std::move(result));
+    });
+}
+
+void ChunkManager::dispatchMeshJobs() {
+    VOXEL_PROFILE_SCOPE("ChunkManager::dispatchMeshJobs");
+
+    // empty chunks never need a mesh, while occluded ones are meshed only if they stop being occluded.
+    // chunks being meshed are added back once their job is done, and ones whose neighbours aren't ready
+    // once the last of those is loaded, so none of them have to be kept around until then
+    erase_if(dirtyChunks, [&](const ChunkSlotPtr &slot) {
+        return !slot->isReady() || slot->isMeshing || !slot->chunk->isDirty()
+               || !slot->chunk->shouldRender() || slot->isOccluded
+               || !areNeighboursReady(*slot);
+    });
+
+    if (jobsInFlight >= maxJobsInFlight) return;
+
+    std::vector<ChunkSlotPtr> meshableChunks(dirtyChunks.begin(), dirtyChunks.end());
+    sortChunkSlots(meshableChunks);
+
+    for (const ChunkSlotPtr &slot: meshableChunks) {
+        if (jobsInFlight >= maxJobsInFlight) {
+            break;
+        }
+
+        dispatchMeshJob(slot);
+        dirtyChunks.erase(slot);
+    }
+}
+
+void ChunkManager::dispatchMeshJob(const ChunkSlotPtr &slot) {
+    // the worker only gets a copy of the blocks, so the chunk stays usable (and editable) in the meantime.
+    // edits made from now on mark the chunk dirty again, making it wait for another mesh job
+    auto neighbourhood = std::make_shared<Chunk::PaddedBlockArray>();
+    gatherNeighbourhood(*slot, *neighbourhood);
+    slot->chunk->markClean();
+
+    slot->isMeshing = true;
+    jobsInFlight++;
+
+    const Clock::time_point dispatchTime = Clock::now();
+
+    threadPool->enqueue([this, slot, chunk = slot->chunk, neighbourhood, layout = chunkMeshLayout, dispatchTime] {
+        const Clock::time_point startTime = Clock::now();
+
+        auto mesh = std::make_unique<ChunkMeshContext>();
+        mesh->layout = layout;
+        chunk->createMesh(*mesh, blockSamplers, *neighbourhood);
+
+        ChunkJobResult result{
+            .slot = slot,
+            .chunk = chunk,
+            .mesh = std::move(mesh),
+            .layout = layout,
+            .waitMs = millisecondsBetween(dispatchTime, startTime),
+            .loadMs = 0.f,
+            .meshMs = millisecondsBetween(startTime, Clock::now()),
+        };
+
+        std::lock_guard lock(finishedJobsMutex);
+        finishedJobs.push_back(std::move(result));
+    });
+}
+
+void ChunkManager::uploadFinishedJobs() {
+    VOXEL_PROFILE_SCOPE("ChunkManager::uploadFinishedJobs");
+
+    {
+        std::lock_guard lock(finishedJobsMutex);
+        std::ranges::move(finishedJobs, std::back_inserter(uploadQueue));
+        finishedJobs.clear();
+    }
+
+    lastFrameStats = {};
+    const Clock::time_point startTime = Clock::now();
+
+    while (!uploadQueue.empty() && millisecondsBetween(startTime, Clock::now()) < uploadBudgetMs) {
+        ChunkJobResult result = std::move(uploadQueue.front());
+        uploadQueue.pop_front();
+        jobsInFlight--;
+
+        PipelineStats::record(pipelineStats.waitMs, result.waitMs);
+
+        // the chunk might have been unloaded while it was being worked on, in which case we just drop it
+        if (result.slot->chunk != result.chunk) {
+            continue;
+        }
+
+        if (!result.mesh) {
+            PipelineStats::record(pipelineStats.loadMs, result.loadMs);
+            lastFrameStats.loads++;
+            lastFrameStats.loadMs += result.loadMs;
+
+            result.slot->isPending = false;
+            dirtyChunks.insert(result.slot);
+            occlusionChangedChunks.push_back(result.chunk->getPos());
+
+            // neighbours meshed before this chunk was loaded assumed it was empty
+            markNeighboursDirty(result.chunk->getPos());
+            continue;
+        }
+
+        // the renderer switched to another layout after the job was dispatched, which already marked the chunk
+        // dirty. the mesh can't be uploaded, so the chunk just waits for another job
+        if (result.layout != chunkMeshLayout) {
+            result.slot->isMeshing = false;
+            dirtyChunks.insert(result.slot);
+            continue;
+        }
+
+        PipelineStats::record(pipelineStats.meshMs, result.meshMs);
+
+        const Clock::time_point uploadStartTime = Clock::now();
+        renderer->writeChunkMesh(result.chunk->getID(), result.mesh->getIndexedData());
+        const float uploadMs = millisecondsBetween(uploadStartTime, Clock::now());
+        PipelineStats::record(pipelineStats.uploadMs, uploadMs);
+
+        result.slot->isMeshing = false;
+        result.slot->hasMesh = true;
+
+        // the chunk was edited while it was being meshed, so it needs yet another mesh
+        if (result.chunk->isDirty()) {
+            dirtyChunks.insert(result.slot);
+        }
+
+        lastFrameStats.uploads++;
+        lastFrameStats.meshMs += result.meshMs;
+        lastFrameStats.uploadMs += uploadMs;
+    }
+}
+
+void ChunkManager::updateOcclusion() {
+    VOXEL_PROFILE_SCOPE("ChunkManager::updateOcclusion");
+
+    // whether a chunk is occluded depends only on itself and its direct neighbours
+    for (const glm::ivec3 &chunkPos: occlusionChangedChunks) {
+        updateChunkOcclusion(chunkPos);
+
+        for (const EBlockFace face: blockFaces) {
+            updateChunkOcclusion(chunkPos + static_cast<glm::ivec3>(getNormalFromFace(face)));
+        }
+    }
+
+    occlusionChangedChunks.clear();
+}
+
+void ChunkManager::updateChunkOcclusion(const glm::ivec3 &chunkPos) {
+    ChunkSlot* slot = getSlot(chunkPos);
+    if (!slot || !slot->isReady()) return;
+
+    const bool wasOccluded = slot->isOccluded;
+
+    slot->isOccluded = slot->chunk->isSolid() && std::ranges::all_of(blockFaces, [&](const EBlockFace face) {
+        const ChunkSlot* neighbour = getSlot(chunkPos + static_cast<glm::ivec3>(getNormalFromFace(face)));
+        return neighbour && neighbour->isReady() && neighbour->chunk->isFaceSolid(getOppositeFace(face));
+    });
+
+    // occluded chunks were dropped from the dirty ones without being meshed
+    if (wasOccluded && !slot->isOccluded && slot->chunk->isDirty()) {
+        dirtyChunks.insert(slotGrid[chunkPos]);
+    }
+}
+
+ChunkManager::ChunkSlot* ChunkManager::getSlot(const glm::ivec3 &chunkPos) const {
+    // the cell may also hold a chunk lying a multiple of the grid's width away
+    ChunkSlot* slot = slotGrid[chunkPos].get();
+    return slot && slot->isBound() && slot->chunk->getPos() == chunkPos ? slot : nullptr;
+}
+
+void ChunkManager::rebuildSlotGrid() {
+    slotGrid = ToroidalGrid<ChunkSlotPtr>(2 * (renderDistance + gracePeriodWidth) + 1);
+
+    for (const auto &slot: chunkSlots) {
+        if (slot->isBound()) {
+            slotGrid[slot->chunk->getPos()] = slot;
+        }
+    }
+}
+
+bool ChunkManager::areNeighboursReady(const ChunkSlot &slot) const {
+    return std::ranges::all_of(blockFaces, [&](const EBlockFace face) {
+        const ChunkSlot* neighbour = getSlot(slot.chunk->getPos() + static_cast<glm::ivec3>(getNormalFromFace(face)));
+        return !neighbour || neighbour->isReady();
+    });
+}
+
+void ChunkManager::gatherNeighbourhood(const ChunkSlot &slot, Chunk::PaddedBlockArray &neighbourhood) const {
+    slot.chunk->copyBlocks(neighbourhood);
+
+    for (const EBlockFace face: blockFaces) {
+        const ChunkSlot* neighbour = getSlot(slot.chunk->getPos() + static_cast<glm::ivec3>(getNormalFromFace(face)));
+
+        if (neighbour && neighbour->isReady()) {
+            neighbour->chunk->copyBoundary(getOppositeFace(face), neighbourhood);
         }
     }
+}
+
+void ChunkManager::markChunkDirty(const ChunkSlotPtr &slot) {
+    slot->chunk->markDirty();
+    dirtyChunks.insert(slot);
+}
+
+void ChunkManager::markNeighboursDirty(const glm::ivec3 &chunkPos) {
+    for (const EBlockFace face: blockFaces) {
+        const glm::ivec3 neighbourPos = chunkPos + static_cast<glm::ivec3>(getNormalFromFace(face));
+        const ChunkSlot* neighbour = getSlot(neighbourPos);
 
-    erase_if(loadableChunks, [](const ChunkSlotPtr &slot) { return slot->chunk->isLoaded(); });
+        if (neighbour && neighbour->isReady()) {
+            markChunkDirty(slotGrid[neighbourPos]);
+        }
+    }
 }
 
 void ChunkManager::updateRenderList() {
     // clear the render list each frame BEFORE we do our tests to see what chunks should be rendered
     visibleChunks.clear();
+    skippedChunksStats = {};
 
     for (auto &slot: chunkSlots) {
-        if (!slot->isBound())
+        if (!slot->isReady())
+            continue;
+
+        skippedChunksStats.readyChunks++;
+
+        if (!slot->chunk->shouldRender()) { // early flags check, so we don't always have to do the frustum check...
+            skippedChunksStats.emptyChunks++;
+            continue;
+        }
+        if (slot->isOccluded) {
+            skippedChunksStats.occludedChunks++;
             continue;
-        if (!slot->chunk->shouldRender()) // early flags check, so we don't always have to do the frustum check...
+        }
+        if (!slot->hasMesh)
             continue;
         if (!renderer->isChunkInFrustum(*slot->chunk))
             continue;
@@ -239,6 +638,19 @@ void ChunkManager::updateRenderList() {
     }
 }
 
+void ChunkManager::checkChunkMeshLayout() {
+    if (renderer->getChunkMeshLayout() == chunkMeshLayout) return;
+
+    chunkMeshLayout = renderer->getChunkMeshLayout();
+
+    for (const auto &slot: chunkSlots) {
+        if (slot->isReady()) {
+            markChunkDirty(slot);
+            slot->hasMesh = false;
+        }
+    }
+}
+
 std::optional<glm::ivec3> ChunkManager::getTargetedBlock(const std::vector<glm::ivec3> &lookedAtBlocks) const {
     for (auto &block: lookedAtBlocks) {
         const Chunk* chunk = getOwningChunk(block);
@@ -255,62 +667,101 @@ std::optional<glm::ivec3> ChunkManager::getTargetedBlock(const std::vector<glm::
     return {};
 }
 
-void ChunkManager::updateBlock(const glm::ivec3 &block, const EBlockType type) const {
+void ChunkManager::updateBlock(const glm::ivec3 &block, const EBlockType type) {
     Chunk* chunk = getOwningChunk(block);
     if (!chunk) return;
 
     const glm::ivec3 relativeBlockPos = block - chunk->getPos() * Chunk::CHUNK_SIZE;
     chunk->updateBlock(relativeBlockPos, type);
-}
+    chunkStore->recordEdit(chunk->getPos(), relativeBlockPos, type);
+    occlusionChangedChunks.push_back(chunk->getPos());
 
-void ChunkManager::setRenderDistance(const int newRenderDistance) {
-    if (renderDistance == newRenderDistance) return;
+    std::vector<ChunkSlot*> affectedSlots = {getSlot(chunk->getPos())};
 
-    const size_t visibleAreaWidth = 2 * newRenderDistance + gracePeriodWidth + 1;
-    const size_t newSlotsCount = SizeUtils::pow(visibleAreaWidth, 3);
+    // editing a block on the chunk's boundary may uncover or hide a face of the neighbouring chunk's block
+    for (const EBlockFace face: blockFaces) {
+        const glm::ivec3 normal = getNormalFromFace(face);
+        const bool isNeighbourOutside = VecUtils::any<int>(relativeBlockPos + normal, [](const int x) {
+            return x < 0 || x >= Chunk::CHUNK_SIZE;
+        });
 
-    if (newRenderDistance > renderDistance) {
-        const size_t slotsToAdd = newSlotsCount - chunkSlots.size();
+        if (!isNeighbourOutside) continue;
 
-        for (size_t i = 0; i < slotsToAdd; i++) {
-            chunkSlots.emplace_back(std::make_shared<ChunkSlot>());
+        ChunkSlot* neighbour = getSlot(chunk->getPos() + normal);
+        if (neighbour && neighbour->isReady()) {
+            neighbour->chunk->markDirty();
+            affectedSlots.push_back(neighbour);
         }
+    }
 
-    } else {
-        chunkSlots.clear();
-        loadableChunks.clear();
-        visibleChunks.clear();
-
-        for (size_t i = 0; i < newSlotsCount; i++) {
-            chunkSlots.emplace_back(std::make_shared<ChunkSlot>());
+    // edits are meshed right away so that they show up immediately. if a worker is already meshing
+    // one of the chunks, it's left dirty instead and gets another mesh job once the current one is done
+    for (ChunkSlot* slot: affectedSlots) {
+        if (!slot->isMeshing) {
+            makeChunkMesh(*slot);
         }
+    }
+}
+
+bool ChunkManager::isSettled() const {
+    if (!loadableChunks.empty() || jobsInFlight > 0) return false;
+
+    // chunks which are loaded but not yet meshed would be picked up by `dispatchMeshJobs`
+    return std::ranges::none_of(dirtyChunks, [](const ChunkSlotPtr &slot) {
+        return slot->isReady() && slot->chunk->isDirty() && slot->chunk->shouldRender() && !slot->isOccluded;
+    });
+}
+
+void ChunkManager::setRenderDistance(const int newRenderDistance) {
+    if (renderDistance == newRenderDistance) return;
+
+    const size_t visibleAreaWidth = 2 * newRenderDistance + gracePeriodWidth + 1;
+    const size_t newSlotsCount = SizeUtils::pow(visibleAreaWidth, 3);
 
-        // todo - copy already loaded closest chunks into this new list instead of wiping everything
-        // sortChunkSlots(chunkSlots);
-        // chunkSlots.resize(newSlotsCount);`
+    if (newRenderDistance < renderDistance) {
+        // chunks in the new grace period are unloaded as well, as there might be more of them than the new
+        // slots can hold. everything within the new render distance stays loaded, along with its mesh
+        forEachInBoxDifference(lastOccupiedChunkPos, renderDistance + gracePeriodWidth,
+                               lastOccupiedChunkPos, newRenderDistance,
+                               [&](const glm::ivec3 &chunkPos) {
+                                   if (getSlot(chunkPos)) {
+                                       unbindSlot(slotGrid[chunkPos]);
+                                   }
+                               });
+
+        erase_if(loadableChunks, [](const ChunkSlotPtr &slot) { return !slot->isBound(); });
+        erase_if(visibleChunks, [](const ChunkSlotPtr &slot) { return !slot->isBound(); });
+
+        // drop the excess slots, all of which are free by now
+        erase_if(chunkSlots, [](const ChunkSlotPtr &slot) { return !slot->isBound(); });
+        freeSlots.clear();
     }
 
+    addChunkSlots(newSlotsCount - chunkSlots.size());
+
     renderDistance = newRenderDistance;
+    renderer->setRenderDistance(renderDistance);
+    rebuildSlotGrid();
     loadNearChunks();
 }
 
 Chunk* ChunkManager::getOwningChunk(const glm::ivec3 &block) const {
     const glm::ivec3 owningChunkPos = VecUtils::floor(static_cast<glm::vec3>(block) * (1.0f / Chunk::CHUNK_SIZE));
 
-    const auto it = std::ranges::find_if(chunkSlots, [&](const ChunkSlotPtr &slot) {
-        return slot->isBound() && slot->chunk->isLoaded() && slot->chunk->getPos() == owningChunkPos;
-    });
-
-    if (it == chunkSlots.end()) {
-        return nullptr;
-    }
-
-    return (*it)->chunk.get();
+    const ChunkSlot* slot = getSlot(owningChunkPos);
+    return slot && slot->isReady() ? slot->chunk.get() : nullptr;
 }
 
-void ChunkManager::makeChunkMesh(const ChunkSlot &slot) const {
+void ChunkManager::makeChunkMesh(ChunkSlot &slot) const {
+    Chunk::PaddedBlockArray neighbourhood;
+    gatherNeighbourhood(slot, neighbourhood);
+
     ChunkMeshContext& meshCtx = *slot.mesh;
-    slot.chunk->createMesh(meshCtx, renderer->getTextureManager());
+    meshCtx.layout = chunkMeshLayout;
+    slot.chunk->createMesh(meshCtx, blockSamplers, neighbourhood);
+    slot.chunk->markClean();
     renderer->writeChunkMesh(slot.chunk->getID(), meshCtx.getIndexedData());
     meshCtx.clear();
+
+    slot.hasMesh = true;
 }
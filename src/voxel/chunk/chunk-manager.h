@@ -3,35 +3,130 @@
 
 #include <vector>
 #include <memory>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <filesystem>
+#include <unordered_set>
 #include "chunk.h"
+#include "chunk-store.h"
 #include "src/render/mesh-context.h"
-#include "src/render/renderer.h"
+#include "src/render/chunk-render-backend.h"
+#include "src/utils/thread-pool.h"
+#include "src/utils/toroidal-grid.h"
 
 /**
  * Class responsible for managing chunks in the world -- most importantly
  * loading and unloading them dynamically.
+ *
+ * Loading and meshing of chunks is done asynchronously by a pool of worker threads, as two separate jobs.
+ * Chunks edited by the player are saved to disk when they're unloaded, and are later loaded back from there
+ * instead of being generated again.
+ * A chunk is meshed only once all of its neighbours which are to be loaded are generated, so that faces
+ * on its boundary can be culled against them. The render thread only dispatches jobs and uploads their
+ * results, the latter being limited by a per-frame time budget.
  */
 class ChunkManager {
+public:
+    /**
+     * Work done by the last call to `tick`. Loading and meshing times are the ones measured by the worker
+     * threads, summed over the jobs whose results were processed during that tick.
+     */
+    struct FrameStats {
+        size_t loads = 0;
+        size_t uploads = 0;
+        float loadMs = 0.f;
+        float meshMs = 0.f;
+        float uploadMs = 0.f;
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
     struct ChunkSlot {
-        std::unique_ptr<Chunk> chunk;
+        // shared, because a worker thread may still hold onto the chunk after it's been unbound from its slot
+        std::shared_ptr<Chunk> chunk;
         std::unique_ptr<ChunkMeshContext> mesh = std::make_unique<ChunkMeshContext>();
 
+        // set while the bound chunk is owned by a worker thread. the render thread must not touch
+        // the chunk's contents as long as this is set.
+        bool isPending = false;
+
+        // set while a worker thread is meshing a copy of the bound chunk's blocks
+        bool isMeshing = false;
+
+        // set once a mesh of the bound chunk was uploaded to the renderer, so that it can be rendered
+        bool hasMesh = false;
+
+        // set if the bound chunk is solid and surrounded by chunks whose adjacent faces are solid as well,
+        // in which case none of it can be seen and it doesn't need to be meshed nor rendered
+        bool isOccluded = false;
+
         [[nodiscard]]
         bool isBound() const { return chunk != nullptr; }
 
-        void bind(std::unique_ptr<Chunk>&& c);
+        /**
+         * @return Is the bound chunk loaded and safe to be accessed by the render thread?
+         */
+        [[nodiscard]]
+        bool isReady() const { return isBound() && !isPending && chunk->isLoaded(); }
+
+        void bind(std::shared_ptr<Chunk>&& c);
 
         void unbind();
     };
 
     using ChunkSlotPtr = std::shared_ptr<ChunkSlot>;
 
+    /**
+     * Result of a job run by a worker thread, waiting to be uploaded by the render thread.
+     * Jobs generating a chunk don't produce a mesh, in which case `mesh` is null.
+     * Meshes are made only in the layout the renderer used when the job was dispatched, given by `layout`.
+     */
+    struct ChunkJobResult {
+        ChunkSlotPtr slot;
+        std::shared_ptr<Chunk> chunk;
+        std::unique_ptr<ChunkMeshContext> mesh;
+        EChunkMeshLayout layout;
+        float waitMs, loadMs, meshMs;
+    };
+
+    /**
+     * Smoothed statistics of the chunk loading pipeline, shown in the GUI.
+     */
+    struct PipelineStats {
+        float waitMs = 0.f;
+        float loadMs = 0.f;
+        float meshMs = 0.f;
+        float uploadMs = 0.f;
+
+        static void record(float &stat, const float value) {
+            constexpr float smoothing = 0.95f;
+            stat = stat * smoothing + value * (1.0f - smoothing);
+        }
+    } pipelineStats;
+
+    FrameStats lastFrameStats;
+
+    /**
+     * Counts of loaded chunks which were skipped when building the last frame's render list.
+     */
+    struct SkippedChunksStats {
+        size_t readyChunks = 0;
+        size_t emptyChunks = 0;
+        size_t occludedChunks = 0;
+    } skippedChunksStats;
+
     // list of chunks that are waiting to be loaded
     std::vector<ChunkSlotPtr> loadableChunks;
 
     // list of chunks that should be rendered
     std::vector<ChunkSlotPtr> visibleChunks;
 
+    // ready chunks which were marked dirty and may need a new mesh, so that finding them doesn't take looking
+    // at every slot. ones which can't be meshed right now are dropped, and added again once that changes
+    std::unordered_set<ChunkSlotPtr> dirtyChunks;
+
     // how many chunks around the camera should always be loaded
     int renderDistance = 8;
 
@@ -42,8 +137,22 @@ class ChunkManager {
      */
     int gracePeriodWidth = 1;
 
-    // this limits how many chunks can be loaded each frame to prevent big stutters
-    int chunksServePerFrame = 8;
+    // this limits how many chunks can be handed to the worker threads at once. keeping this low lets
+    // the closest chunks get picked first whenever the camera moves, instead of queueing far away ones.
+    int maxJobsInFlight = 16;
+
+    // how much time (in milliseconds) may be spent each frame on uploading finished chunk meshes
+    float uploadBudgetMs = 2.f;
+
+    // number of jobs dispatched to the worker threads whose results weren't yet uploaded
+    int jobsInFlight = 0;
+
+    // results pushed by worker threads, guarded by `finishedJobsMutex`
+    std::deque<ChunkJobResult> finishedJobs;
+    std::mutex finishedJobsMutex;
+
+    // results already taken from `finishedJobs`, waiting for their turn to be uploaded
+    std::deque<ChunkJobResult> uploadQueue;
 
     // ID given to the next newly created chunk
     Chunk::ChunkID nextFreeID = 0;
@@ -54,13 +163,55 @@ class ChunkManager {
      */
     std::vector<ChunkSlotPtr> chunkSlots;
 
+    // slots from `chunkSlots` which aren't bound to any chunk
+    std::vector<ChunkSlotPtr> freeSlots;
+
+    /*
+     * bound slots, indexed by the position of their chunks. all bound chunks lie within
+     * `renderDistance + gracePeriodWidth` chunks from `lastOccupiedChunkPos`, so the grid is wide enough
+     * for each of them to get its own cell.
+     */
+    ToroidalGrid<ChunkSlotPtr> slotGrid;
+
     glm::ivec3 lastOccupiedChunkPos = {0, 0, 0};
 
-    std::shared_ptr<OpenGLRenderer> renderer;
+    // positions of chunks which were loaded, unloaded or edited since occlusion was last updated. occlusion
+    // has to be recalculated for each of them and their neighbours, as only those could have been affected
+    std::vector<glm::ivec3> occlusionChangedChunks;
+
+    // layout of chunk meshes in which they were last uploaded. when the renderer switches to another one,
+    // it drops all meshes, so they have to be made again
+    EChunkMeshLayout chunkMeshLayout;
+
+    // copy of the renderer's sampler table, so that worker threads can use it without touching the renderer
+    BlockSamplerTable blockSamplers;
+
+    std::shared_ptr<ChunkRenderBackend> renderer;
     std::shared_ptr<WorldGen> worldGen;
 
+    // used by worker threads too, so it has to outlive them
+    std::unique_ptr<ChunkStore> chunkStore;
+
+    // declared last so that it's destroyed first, joining the workers before anything they use is gone
+    std::unique_ptr<ThreadPool> threadPool;
+
 public:
-    explicit ChunkManager(std::shared_ptr<OpenGLRenderer> r, std::shared_ptr<WorldGen> wg);
+    /**
+     * @param r Renderer to which meshes are uploaded, also providing the camera's position.
+     *          It doesn't need to draw anything, so chunks can be managed without a window as well.
+     * @param saveDirectory Directory in which edited chunks are saved.
+     */
+    explicit ChunkManager(std::shared_ptr<ChunkRenderBackend> r, std::shared_ptr<WorldGen> wg,
+                          const std::filesystem::path &saveDirectory);
+
+    /**
+     * Saves all loaded chunks which were edited.
+     */
+    ~ChunkManager();
+
+    ChunkManager(const ChunkManager&) = delete;
+
+    ChunkManager& operator=(const ChunkManager&) = delete;
 
     void tick();
 
@@ -92,11 +243,20 @@ public:
      * @param block The block's coordinates.
      * @param type Type of which the block should now be.
      */
-    void updateBlock(const glm::ivec3 &block, EBlockType type) const;
+    void updateBlock(const glm::ivec3 &block, EBlockType type);
+
+    [[nodiscard]]
+    const FrameStats& getLastFrameStats() const { return lastFrameStats; }
+
+    /**
+     * @return Whether all chunks within render distance are loaded and meshed, with no jobs left running.
+     */
+    [[nodiscard]]
+    bool isSettled() const;
 
     /**
      * Updates the render distance.
-     * This clears all loaded chunks and as a consequence needs them to be reloaded later.
+     * Chunks which are still within the new render distance stay loaded, along with their meshes.
      */
     void setRenderDistance(int newRenderDistance);
 
@@ -110,39 +270,147 @@ private:
     [[nodiscard]]
     Chunk* getOwningChunk(const glm::ivec3 &block) const;
 
+    /**
+     * @return The slot to which the chunk at a given chunk position is bound, or null if there isn't any.
+     */
+    [[nodiscard]]
+    ChunkSlot* getSlot(const glm::ivec3 &chunkPos) const;
 
-    void makeChunkMesh(const ChunkSlot& slot) const;
+    /**
+     * Recreates `slotGrid` to fit the current render distance, reinserting all bound slots.
+     */
+    void rebuildSlotGrid();
+
+    /**
+     * @return Whether all neighbours of a given slot's chunk which are bound are also ready,
+     *         meaning the chunk can be meshed with all of its neighbours' blocks known.
+     */
+    [[nodiscard]]
+    bool areNeighboursReady(const ChunkSlot &slot) const;
+
+    /**
+     * Copies blocks of a given slot's chunk, along with the boundary layers of its ready neighbours.
+     * Blocks of neighbours which aren't ready are left empty.
+     */
+    void gatherNeighbourhood(const ChunkSlot &slot, Chunk::PaddedBlockArray &neighbourhood) const;
+
+    /**
+     * Marks the chunk bound to a given slot as needing a new mesh, and adds it to `dirtyChunks`.
+     */
+    void markChunkDirty(const ChunkSlotPtr &slot);
+
+    /**
+     * Marks all ready neighbours of a chunk at a given position as needing a new mesh, which is needed
+     * whenever the blocks on their shared boundary might have changed.
+     */
+    void markNeighboursDirty(const glm::ivec3 &chunkPos);
+
+    /**
+     * Meshes the chunk bound to a given slot and uploads the mesh right away, on the render thread.
+     */
+    void makeChunkMesh(ChunkSlot &slot) const;
 
     /**
      * Checks if any chunks should be loaded or unloaded, and does so if that's the case.
+     * Only chunks entering and leaving the loaded area when the camera moves are touched.
      */
     void updateChunkSlots();
 
     /**
      * Unloads all chunks that are at least `RENDER_DISTANCE + GRACE_PERIOD_WIDTH` chunks' worth of distance
-     * away from the camera's position.
+     * away from the camera's position, assuming that all loaded chunks were within that distance
+     * from `prevChunkPos`.
+     */
+    void unloadLeavingChunks(const glm::ivec3 &prevChunkPos);
+
+    /**
+     * Loads all chunks that are within `RENDER_DISTANCE` chunks' worth of distance from the camera's position,
+     * assuming that all chunks within that distance from `prevChunkPos` are already loaded.
      */
-    void unloadFarChunks();
+    void loadEnteringChunks(const glm::ivec3 &prevChunkPos);
 
     /**
      * Loads all chunks that are within `RENDER_DISTANCE` chunks' worth of distance from the camera's position.
+     * Unlike `loadEnteringChunks`, this doesn't assume anything and checks every position.
      */
     void loadNearChunks();
 
+    /**
+     * Creates a number of new, free chunk slots.
+     */
+    void addChunkSlots(size_t count);
+
+    /**
+     * Binds a free slot with a new chunk at a given position.
+     *
+     * @return The bound slot.
+     */
+    ChunkSlotPtr bindSlot(const glm::ivec3 &chunkPos);
+
+    /**
+     * Unloads the chunk bound to a given slot, freeing the slot and the chunk's mesh.
+     * The chunk is saved first if it was edited.
+     */
+    void unbindSlot(const ChunkSlotPtr &slot);
+
+    [[nodiscard]]
+    static float getSquaredDistance(const glm::vec3 &cameraPos, const ChunkSlot &slot);
+
     /**
      * Sorts a given list of chunks with respect to distance to the camera.
      */
     void sortChunkSlots(std::vector<ChunkSlotPtr> &chunks) const;
 
     /**
-     * Takes up to `MAX_CHUNKS_SERVE_PER_PRAME` chunks from the `loadableChunks` list and loads them.
+     * Hands the closest chunks from the `loadableChunks` list over to the worker threads,
+     * keeping at most `maxJobsInFlight` jobs running at once.
      */
     void updateLoadList();
 
+    /**
+     * Dispatches a job loading the chunk bound to a given slot from the chunk store, or generating it
+     * if it was never saved.
+     */
+    void dispatchLoadJob(const ChunkSlotPtr &slot);
+
+    /**
+     * Hands the closest chunks from `dirtyChunks` which can be meshed over to the worker threads,
+     * sharing the `maxJobsInFlight` limit with load jobs.
+     */
+    void dispatchMeshJobs();
+
+    /**
+     * Dispatches a job meshing a copy of the chunk bound to a given slot.
+     */
+    void dispatchMeshJob(const ChunkSlotPtr &slot);
+
+    /**
+     * Processes results of jobs finished by the worker threads, uploading meshes until
+     * the `uploadBudgetMs` is exhausted.
+     */
+    void uploadFinishedJobs();
+
+    /**
+     * Recalculates which of the ready chunks are occluded by their neighbours, for chunks around the ones
+     * which changed since the last time this was done.
+     */
+    void updateOcclusion();
+
+    /**
+     * Recalculates whether the chunk at a given position is occluded by its neighbours, if it's ready.
+     */
+    void updateChunkOcclusion(const glm::ivec3 &chunkPos);
+
     /**
      * Updates which chunks are actually visible and renderrable.
      */
     void updateRenderList();
+
+    /**
+     * Marks all loaded chunks as needing a new mesh if the renderer changed the layout of chunk meshes
+     * since the last check. The meshes are then remade before the chunks are rendered next time.
+     */
+    void checkChunkMeshLayout();
 };
 
 #endif //MYGE_CHUNK_MANAGER_H
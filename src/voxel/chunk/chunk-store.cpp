@@ -0,0 +1,219 @@
+#include "chunk-store.h"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+
+#include "chunk.h"
+
+ChunkStore::ChunkStore(std::filesystem::path dir, const ESyncPolicy policy)
+    : directory(std::move(dir)), syncPolicy(policy) {
+    std::filesystem::create_directories(directory);
+
+    // edits which the chunks' snapshots already include aren't replayed on top of them
+    journal = std::make_unique<EditJournal>(directory / "edits.log", journaledEdits, [&](const glm::ivec3 &chunkPos) {
+        const RegionFile *region = getRegion(RegionFile::getRegionPos(chunkPos), false);
+        return region ? region->getJournalSequence(chunkPos) : 0u;
+    });
+    journalSize = journal->getSize();
+
+    flusher = std::thread(&ChunkStore::flusherLoop, this);
+}
+
+ChunkStore::~ChunkStore() {
+    {
+        std::lock_guard lock(pendingMutex);
+        isStopping = true;
+    }
+
+    pendingCondition.notify_all();
+    flusher.join();
+}
+
+bool ChunkStore::load(Chunk &chunk) {
+    const glm::ivec3 chunkPos = chunk.getPos();
+    Record record;
+
+    {
+        std::lock_guard lock(pendingMutex);
+
+        if (const auto it = pendingRecords.find(chunkPos); it != pendingRecords.end()) {
+            record = it->second;
+        }
+    }
+
+    if (record) {
+        return chunk.deserialize(*record);
+    }
+
+    const RegionFile *region = getRegion(RegionFile::getRegionPos(chunkPos), false);
+    if (!region) return false;
+
+    // the chunk is decoded straight from the mapped file
+    return region->read(chunkPos, [&](const std::span<const std::uint8_t> data) {
+        return chunk.deserialize(data);
+    });
+}
+
+void ChunkStore::replayEdits(Chunk &chunk) {
+    BlockEdits edits;
+
+    {
+        std::lock_guard lock(pendingMutex);
+
+        if (const auto it = journaledEdits.find(chunk.getPos()); it != journaledEdits.end()) {
+            edits = it->second;
+        }
+
+        // edits which weren't journaled yet are newer, so they take precedence
+        if (const auto it = pendingEdits.find(chunk.getPos()); it != pendingEdits.end()) {
+            for (const auto &[index, type]: it->second) {
+                edits[index] = type;
+            }
+        }
+    }
+
+    for (const auto &[index, type]: edits) {
+        chunk.updateBlock(EditJournal::getBlockPos(index), type);
+    }
+}
+
+void ChunkStore::save(const Chunk &chunk) {
+    auto data = std::make_shared<std::vector<std::uint8_t>>();
+    chunk.serialize(*data);
+
+    {
+        std::lock_guard lock(pendingMutex);
+        pendingRecords[chunk.getPos()] = std::move(data);
+
+        // the snapshot includes all edits of the chunk made so far
+        pendingEdits.erase(chunk.getPos());
+        journaledEdits.erase(chunk.getPos());
+    }
+
+    pendingCondition.notify_one();
+}
+
+void ChunkStore::recordEdit(const glm::ivec3 &chunkPos, const glm::ivec3 &block, const EBlockType type) {
+    {
+        std::lock_guard lock(pendingMutex);
+        pendingEdits[chunkPos][EditJournal::getBlockIndex(block)] = type;
+    }
+
+    pendingCondition.notify_one();
+}
+
+size_t ChunkStore::getPendingCount() const {
+    std::lock_guard lock(pendingMutex);
+    return pendingRecords.size();
+}
+
+size_t ChunkStore::getPendingEditCount() const {
+    std::lock_guard lock(pendingMutex);
+
+    size_t count = 0;
+    for (const auto &[chunkPos, edits]: pendingEdits) {
+        count += edits.size();
+    }
+
+    return count;
+}
+
+void ChunkStore::flusherLoop() {
+    while (true) {
+        std::vector<std::pair<glm::ivec3, Record>> records;
+        ChunkEditMap edits;
+        std::optional<ChunkEditMap> compactedEdits;
+        bool shouldStop;
+
+        {
+            std::unique_lock lock(pendingMutex);
+            pendingCondition.wait(lock, [&] {
+                return isStopping || !pendingRecords.empty() || !pendingEdits.empty();
+            });
+            pendingCondition.wait_for(lock, flushDelay, [&] { return isStopping; });
+
+            shouldStop = isStopping;
+
+            // records stay pending while they're being written, so that loads can still find them
+            records.assign(pendingRecords.begin(), pendingRecords.end());
+
+            // edits, on the other hand, are found among the journaled ones from now on
+            edits = std::move(pendingEdits);
+            pendingEdits.clear();
+
+            for (const auto &[chunkPos, chunkEdits]: edits) {
+                for (const auto &[index, type]: chunkEdits) {
+                    journaledEdits[chunkPos][index] = type;
+                }
+            }
+
+            if (journal->getSize() > journalCompactionSize) {
+                compactedEdits = journaledEdits;
+            }
+        }
+
+        const bool shouldSync = syncPolicy == SyncPolicy_Batch;
+
+        // the records include all edits of their chunks from earlier batches, while the edits collected above
+        // were made after the records were saved. this batch's sequence number tells these apart on replay
+        const std::uint32_t sequence = journal->getNextSequence();
+
+        // compaction drops edits of chunks whose snapshots were saved, so these have to be written first
+        flush(records, sequence, shouldSync);
+        journal->append(edits, shouldSync);
+
+        if (compactedEdits) {
+            journal->rewrite(*compactedEdits, sequence, shouldSync);
+        }
+
+        journalSize = journal->getSize();
+
+        {
+            std::lock_guard lock(pendingMutex);
+
+            // a chunk could've been saved again in the meantime, in which case its newer record has to stay
+            for (const auto &[chunkPos, record]: records) {
+                if (const auto it = pendingRecords.find(chunkPos); it != pendingRecords.end() && it->second == record) {
+                    pendingRecords.erase(it);
+                }
+            }
+        }
+
+        if (shouldStop) return;
+    }
+}
+
+void ChunkStore::flush(const std::vector<std::pair<glm::ivec3, Record>> &records,
+                       const std::uint32_t journalSequence, const bool shouldSync) {
+    std::unordered_map<glm::ivec3, std::vector<RegionFile::Record>, VecUtils::VecHash> recordsByRegion;
+
+    for (const auto &[chunkPos, record]: records) {
+        recordsByRegion[RegionFile::getRegionPos(chunkPos)].emplace_back(chunkPos, *record);
+    }
+
+    for (const auto &[regionPos, regionRecords]: recordsByRegion) {
+        getRegion(regionPos, true)->write(regionRecords, journalSequence, shouldSync);
+    }
+}
+
+RegionFile *ChunkStore::getRegion(const glm::ivec3 &regionPos, const bool shouldCreate) {
+    std::lock_guard lock(regionsMutex);
+
+    if (const auto it = regions.find(regionPos); it != regions.end()) {
+        return it->second.get();
+    }
+
+    const std::string fileName = "r." + std::to_string(regionPos.x) + "." + std::to_string(regionPos.y) + "."
+                                 + std::to_string(regionPos.z) + ".vxr";
+    const std::filesystem::path path = directory / fileName;
+
+    if (!shouldCreate && !std::filesystem::exists(path)) {
+        return nullptr;
+    }
+
+    auto region = std::make_unique<RegionFile>(path);
+    RegionFile *regionPtr = region.get();
+    regions.emplace(regionPos, std::move(region));
+    return regionPtr;
+}
@@ -0,0 +1,170 @@
+#ifndef VOXEL_CHUNK_STORE_H
+#define VOXEL_CHUNK_STORE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "glm/vec3.hpp"
+#include "region-file.h"
+#include "edit-journal.h"
+#include "src/utils/vec.h"
+
+class Chunk;
+
+/**
+ * Describes when the chunk store waits for the data it writes to actually reach the disk.
+ */
+enum ESyncPolicy {
+    // never -- this is left up to the OS, so a crash of the whole system may lose recently written data
+    SyncPolicy_Never,
+
+    // after each batch of writes, before anything relying on the batch is written
+    SyncPolicy_Batch,
+};
+
+/**
+ * Persistent storage of chunks, kept within a given directory.
+ *
+ * There are two ways in which chunks are stored. Whole chunks are saved as snapshots into region files
+ * (see `RegionFile`), while single block edits are recorded in an edit journal (see `EditJournal`), without
+ * needing to save their whole chunk after each one. Edits are replayed on top of a chunk when it's loaded.
+ * A snapshot of a chunk includes all of its edits made so far. Each snapshot records the journal's sequence number
+ * at the time it's written, so that older edits of its chunk are skipped when the journal is replayed, and these
+ * are then dropped from the journal once it's compacted.
+ *
+ * Both snapshots and edits are kept in memory at first, with repeated edits of the same block overwriting
+ * each other, and are later written to disk by a background flusher thread in batches. Until then, loads
+ * of the affected chunks are served from memory. All methods may be called concurrently from multiple threads.
+ */
+class ChunkStore {
+    using Record = std::shared_ptr<const std::vector<std::uint8_t>>;
+
+    std::filesystem::path directory;
+
+    // regions opened so far, guarded by `regionsMutex`
+    std::unordered_map<glm::ivec3, std::unique_ptr<RegionFile>, VecUtils::VecHash> regions;
+    std::mutex regionsMutex;
+
+    // records of saved chunks which weren't written yet, guarded by `pendingMutex`
+    std::unordered_map<glm::ivec3, Record, VecUtils::VecHash> pendingRecords;
+
+    // edits which weren't appended to the journal yet, guarded by `pendingMutex`
+    ChunkEditMap pendingEdits;
+
+    // edits which were appended to the journal and aren't included in any snapshot, guarded by `pendingMutex`
+    ChunkEditMap journaledEdits;
+
+    mutable std::mutex pendingMutex;
+    std::condition_variable pendingCondition;
+    bool isStopping = false;
+
+    // used only by the flusher, apart from opening it
+    std::unique_ptr<EditJournal> journal;
+
+    // copy of the journal's size, so that it can be shown without touching the journal
+    std::atomic<size_t> journalSize = 0;
+
+    // the journal is compacted once it grows past this many bytes
+    size_t journalCompactionSize = 4 * 1024 * 1024;
+
+    std::atomic<ESyncPolicy> syncPolicy;
+
+    // how long the flusher waits after being woken up, so that chunks saved and blocks edited in quick succession
+    // (like when the camera moves away from an edited area, or when the player builds something) end up
+    // in the same batch
+    std::chrono::milliseconds flushDelay{500};
+
+    std::thread flusher;
+
+public:
+    /**
+     * @param dir Directory holding the region files and the journal. It's created if it doesn't exist yet.
+     * @param policy Initial sync policy.
+     */
+    explicit ChunkStore(std::filesystem::path dir, ESyncPolicy policy = SyncPolicy_Batch);
+
+    /**
+     * Writes all chunks and edits which are still waiting to be written before returning.
+     */
+    ~ChunkStore();
+
+    ChunkStore(const ChunkStore&) = delete;
+
+    ChunkStore& operator=(const ChunkStore&) = delete;
+
+    /**
+     * Loads the contents of a chunk from its last snapshot, if the chunk at its position was ever saved.
+     * Edits made since then still have to be replayed using `replayEdits`.
+     *
+     * @return Whether the chunk was loaded.
+     */
+    bool load(Chunk &chunk);
+
+    /**
+     * Applies all recorded edits of a chunk which aren't included in its last snapshot. The chunk's contents
+     * should be either loaded by `load` or generated beforehand.
+     */
+    void replayEdits(Chunk &chunk);
+
+    /**
+     * Saves a snapshot of a chunk, replacing whatever was saved at its position before.
+     */
+    void save(const Chunk &chunk);
+
+    /**
+     * Records an edit of a single block.
+     *
+     * @param chunkPos Position of the block's chunk.
+     * @param block The block's coordinates relative to its chunk.
+     * @param type Type of which the block now is.
+     */
+    void recordEdit(const glm::ivec3 &chunkPos, const glm::ivec3 &block, EBlockType type);
+
+    [[nodiscard]]
+    ESyncPolicy getSyncPolicy() const { return syncPolicy; }
+
+    void setSyncPolicy(const ESyncPolicy policy) { syncPolicy = policy; }
+
+    /**
+     * @return Number of saved chunks which weren't written to disk yet.
+     */
+    [[nodiscard]]
+    size_t getPendingCount() const;
+
+    /**
+     * @return Number of recorded block edits which weren't written to disk yet.
+     */
+    [[nodiscard]]
+    size_t getPendingEditCount() const;
+
+    /**
+     * @return Size of the edit journal in bytes, as of the last time the flusher wrote to it.
+     */
+    [[nodiscard]]
+    size_t getJournalSize() const { return journalSize; }
+
+private:
+    void flusherLoop();
+
+    /**
+     * Writes given records to their region files.
+     *
+     * @param journalSequence Sequence number of the journal batch appended along with the records.
+     */
+    void flush(const std::vector<std::pair<glm::ivec3, Record>> &records, std::uint32_t journalSequence,
+               bool shouldSync);
+
+    /**
+     * @return The region file of a given region, or null if it doesn't exist and `shouldCreate` isn't set.
+     */
+    RegionFile *getRegion(const glm::ivec3 &regionPos, bool shouldCreate);
+};
+
+#endif //VOXEL_CHUNK_STORE_H
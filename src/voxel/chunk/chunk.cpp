@@ -1,20 +1,132 @@
 #include "chunk.h"
 
-#include "src/render/renderer.h"
 #include "src/render/mesh-context.h"
+#include "src/render/binary-mesher.h"
 #include "src/voxel/world-gen.h"
+#include "src/utils/profiler.h"
 
 void Chunk::generate(WorldGen &worldGen) {
-    worldGen.fillChunk(pos, blocks);
+    // chunks entirely above or below the surface are stored as a single block type, without filling them
+    switch (worldGen.classifyChunk(pos)) {
+        case ChunkContents_Empty:
+            blocks.fill(BlockType_None);
+            activeBlockCount = 0;
+            break;
 
-    blocks.forEach([&](const int x, const int y, const int z, Block &b) {
-        (void) (x + y + z); // warning silencer
-        if (!b.isNone()) {
-            activeBlockCount++;
+        case ChunkContents_Solid:
+            blocks.fill(WorldGen::UNDERGROUND_BLOCK_TYPE);
+            activeBlockCount = CHUNK_VOLUME;
+            break;
+
+        default: {
+            CubeArray<Block, CHUNK_SIZE> blockArray;
+            worldGen.fillChunk(pos, blockArray);
+
+            activeBlockCount = 0;
+            blockArray.forEach([&](const int x, const int y, const int z, const Block &b) {
+                (void) (x + y + z); // warning silencer
+                if (!b.isNone()) {
+                    activeBlockCount++;
+                }
+            });
+
+            blocks.assign(blockArray);
         }
-    });
+    }
+
+    updateSolidFaces();
+    _isLoaded = true;
+}
+
+/*
+ * chunks are encoded as runs of blocks of the same type, in the order in which `BlockStorage` lays them out.
+ * each run is a block type followed by the run's length as a base-128 varint, so that chunks above or below
+ * the surface take up only a couple of bytes.
+ */
+
+static void writeRun(std::vector<std::uint8_t> &out, const EBlockType type, size_t length) {
+    out.push_back(type);
+
+    while (length >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(length & 0x7f) | 0x80);
+        length >>= 7;
+    }
+
+    out.push_back(static_cast<std::uint8_t>(length));
+}
+
+void Chunk::serialize(std::vector<std::uint8_t> &out) const {
+    out.clear();
+
+    EBlockType runType = blocks.get(0, 0, 0);
+    size_t runLength = 0;
+
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                const EBlockType type = blocks.get(x, y, z);
+
+                if (type != runType) {
+                    writeRun(out, runType, runLength);
+                    runType = type;
+                    runLength = 0;
+                }
+
+                runLength++;
+            }
+        }
+    }
+
+    writeRun(out, runType, runLength);
+}
+
+bool Chunk::deserialize(const std::span<const std::uint8_t> data) {
+    CubeArray<Block, CHUNK_SIZE> blockArray;
+    size_t block = 0, offset = 0, newActiveBlockCount = 0;
+
+    while (offset < data.size()) {
+        const auto type = static_cast<EBlockType>(data[offset++]);
+        if (type >= BlockType_NumTypes) return false;
+
+        size_t length = 0;
+        for (int shift = 0; ; shift += 7) {
+            if (offset == data.size() || shift > 14) return false;
+
+            const std::uint8_t byte = data[offset++];
+            length |= static_cast<size_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) break;
+        }
+
+        if (length == 0 || block + length > CHUNK_VOLUME) return false;
+
+        // a single run spanning the whole chunk doesn't need to be unpacked
+        if (length == CHUNK_VOLUME) {
+            if (offset != data.size()) return false;
 
+            blocks.fill(type);
+            activeBlockCount = type == BlockType_None ? 0 : CHUNK_VOLUME;
+            updateSolidFaces();
+            _isLoaded = true;
+            return true;
+        }
+
+        if (type != BlockType_None) {
+            newActiveBlockCount += length;
+        }
+
+        for (const size_t end = block + length; block < end; block++) {
+            blockArray[block / (CHUNK_SIZE * CHUNK_SIZE)][block / CHUNK_SIZE % CHUNK_SIZE][block % CHUNK_SIZE]
+                    .blockType = type;
+        }
+    }
+
+    if (block != CHUNK_VOLUME) return false;
+
+    blocks.assign(blockArray);
+    activeBlockCount = newActiveBlockCount;
+    updateSolidFaces();
     _isLoaded = true;
+    return true;
 }
 
 void Chunk::unload() {
@@ -26,77 +138,188 @@ void Chunk::updateBlock(const glm::ivec3 &block, const EBlockType type) {
 }
 
 void Chunk::updateBlock(const int x, const int y, const int z, const EBlockType type) {
-    if (!blocks[x][y][z].isNone() && type == BlockType_None) {
+    const EBlockType oldType = blocks.get(x, y, z);
+
+    if (oldType != BlockType_None && type == BlockType_None) {
         activeBlockCount--;
 
-    } else if (blocks[x][y][z].isNone() && type != BlockType_None) {
+    } else if (oldType == BlockType_None && type != BlockType_None) {
         activeBlockCount++;
     }
 
-    blocks[x][y][z].blockType = type;
+    blocks.set(x, y, z, type);
+    _isModified = true;
+
+    // edits only ever grow the palette, so shrink it back once the chunk is all air or all solid again
+    if (activeBlockCount == 0 || activeBlockCount == CHUNK_VOLUME) {
+        blocks.compact();
+    }
+
+    const bool isOnBoundary = VecUtils::any<int>(glm::ivec3(x, y, z), [](const int coord) {
+        return coord == 0 || coord == CHUNK_SIZE - 1;
+    });
+
+    if (isOnBoundary) {
+        updateSolidFaces();
+    }
+
     _isDirty = true;
 }
 
+void Chunk::updateSolidFaces() {
+    if (blocks.isUniform()) {
+        solidFaces = blocks.getUniformType() == BlockType_None ? 0 : ALL_FACES;
+        return;
+    }
+
+    solidFaces = 0;
+
+    for (const EBlockFace face: blockFaces) {
+        const glm::ivec3 normal = getNormalFromFace(face);
+        bool isSolid = true;
+
+        // walk the layer of blocks lying on the face, keeping the coordinate along the normal fixed
+        for (int u = 0; u < CHUNK_SIZE && isSolid; u++) {
+            for (int v = 0; v < CHUNK_SIZE && isSolid; v++) {
+                glm::ivec3 block;
+
+                if (normal.x != 0) {
+                    block = {normal.x > 0 ? CHUNK_SIZE - 1 : 0, u, v};
+                } else if (normal.y != 0) {
+                    block = {u, normal.y > 0 ? CHUNK_SIZE - 1 : 0, v};
+                } else {
+                    block = {u, v, normal.z > 0 ? CHUNK_SIZE - 1 : 0};
+                }
+
+                isSolid = getBlock(block) != BlockType_None;
+            }
+        }
+
+        if (isSolid) {
+            solidFaces |= face;
+        }
+    }
+}
+
 bool Chunk::shouldRender() const {
     return activeBlockCount != 0 && _isLoaded;
 }
 
-void Chunk::createMesh(ChunkMeshContext &meshContext, const TextureManager &textureManager) {
+void Chunk::copyBlocks(PaddedBlockArray &neighbourhood) const {
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_SIZE; y++) {
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                neighbourhood[x + 1][y + 1][z + 1].blockType = blocks.get(x, y, z);
+            }
+        }
+    }
+}
+
+void Chunk::copyBoundary(const EBlockFace face, PaddedBlockArray &neighbourhood) const {
+    const glm::ivec3 normal = getNormalFromFace(face);
+
+    // the layer on a positive face ends up in the neighbour's padding at coordinate 0 and vice versa
+    const int srcDepth = VecUtils::sum(normal) > 0 ? CHUNK_SIZE - 1 : 0;
+    const int dstDepth = VecUtils::sum(normal) > 0 ? 0 : PADDED_SIZE - 1;
+
+    for (int u = 0; u < CHUNK_SIZE; u++) {
+        for (int v = 0; v < CHUNK_SIZE; v++) {
+            glm::ivec3 src, dst;
+
+            if (normal.x != 0) {
+                src = {srcDepth, u, v};
+                dst = {dstDepth, u + 1, v + 1};
+            } else if (normal.y != 0) {
+                src = {u, srcDepth, v};
+                dst = {u + 1, dstDepth, v + 1};
+            } else {
+                src = {u, v, srcDepth};
+                dst = {u + 1, v + 1, dstDepth};
+            }
+
+            neighbourhood[dst].blockType = getBlock(src);
+        }
+    }
+}
+
+void Chunk::createMesh(ChunkMeshContext &meshContext, const BlockSamplerTable &samplers) {
+    if (!_isDirty) return;
+
+    if (blocks.isUniform() && blocks.getUniformType() == BlockType_None) {
+        meshContext.resetIndexedData().origin = pos * CHUNK_SIZE;
+    } else {
+        PaddedBlockArray neighbourhood;
+        copyBlocks(neighbourhood);
+        createMesh(meshContext, samplers, neighbourhood);
+    }
+
+    markClean();
+}
+
+void Chunk::createMesh(ChunkMeshContext &meshContext, const BlockSamplerTable &samplers,
+                       const PaddedBlockArray &neighbourhood) const {
+    VOXEL_PROFILE_SCOPE("Chunk::createMesh");
+    BinaryMesher::createMesh(neighbourhood, pos * CHUNK_SIZE, samplers, meshContext.resetIndexedData());
+}
+
+void Chunk::createReferenceMesh(ChunkMeshContext &meshContext, const BlockSamplerTable &samplers) {
     if (!_isDirty) return;
 
     meshContext.modelTranslate = pos * CHUNK_SIZE;
 
+    CubeArray<Block, CHUNK_SIZE> blockArray;
+    blocks.unpack(blockArray);
+
     // mesh context is already empty so we can just start adding cubes
-    blocks.forEach([&](const int x, const int y, const int z, const Block &b) {
+    blockArray.forEach([&](const int x, const int y, const int z, const Block &b) {
         if (b.isNone()) return;
-        createCube(x, y, z, meshContext, textureManager);
+        createCube(x, y, z, blockArray, meshContext, samplers);
     });
 
     meshContext.mergeQuads();
-    meshContext.triangulateQuads();
     meshContext.makeIndexed();
     _isDirty = false;
     isMesh = true;
 }
 
-void Chunk::createCube(const int x, const int y, const int z, ChunkMeshContext &meshContext,
-                       const TextureManager &textureManager) {
+void Chunk::createCube(const int x, const int y, const int z, const CubeArray<Block, CHUNK_SIZE> &blockArray,
+                       ChunkMeshContext &meshContext, const BlockSamplerTable &samplers) {
     const glm::ivec3 cubePos = {x, y, z};
-    const EBlockType blockType = blocks[x][y][z].blockType;
+    const EBlockType blockType = blockArray[x][y][z].blockType;
 
-    if (z == CHUNK_SIZE - 1 || blocks[x][y][z + 1].isNone()) {
-        createFace(cubePos, Front, blockType, meshContext, textureManager);
+    if (z == CHUNK_SIZE - 1 || blockArray[x][y][z + 1].isNone()) {
+        createFace(cubePos, Front, blockType, meshContext, samplers);
     }
 
-    if (z == 0 || blocks[x][y][z - 1].isNone()) {
-        createFace(cubePos, Back, blockType, meshContext, textureManager);
+    if (z == 0 || blockArray[x][y][z - 1].isNone()) {
+        createFace(cubePos, Back, blockType, meshContext, samplers);
     }
 
-    if (x == CHUNK_SIZE - 1 || blocks[x + 1][y][z].isNone()) {
-        createFace(cubePos, Right, blockType, meshContext, textureManager);
+    if (x == CHUNK_SIZE - 1 || blockArray[x + 1][y][z].isNone()) {
+        createFace(cubePos, Right, blockType, meshContext, samplers);
     }
 
-    if (x == 0 || blocks[x - 1][y][z].isNone()) {
-        createFace(cubePos, Left, blockType, meshContext, textureManager);
+    if (x == 0 || blockArray[x - 1][y][z].isNone()) {
+        createFace(cubePos, Left, blockType, meshContext, samplers);
     }
 
-    if (y == CHUNK_SIZE - 1 || blocks[x][y + 1][z].isNone()) {
-        createFace(cubePos, Top, blockType, meshContext, textureManager);
+    if (y == CHUNK_SIZE - 1 || blockArray[x][y + 1][z].isNone()) {
+        createFace(cubePos, Top, blockType, meshContext, samplers);
     }
 
-    if (y == 0 || blocks[x][y - 1][z].isNone()) {
-        createFace(cubePos, Bottom, blockType, meshContext, textureManager);
+    if (y == 0 || blockArray[x][y - 1][z].isNone()) {
+        createFace(cubePos, Bottom, blockType, meshContext, samplers);
     }
 }
 
 void Chunk::createFace(const glm::ivec3 &cubePos, const EBlockFace face, const EBlockType blockType,
-                       ChunkMeshContext& meshContext, const TextureManager &textureManager) const {
+                       ChunkMeshContext& meshContext, const BlockSamplerTable &samplers) const {
     const auto [bottomLeft, topRight] = Block::getFaceCorners(face);
     const glm::ivec3 minPos = CHUNK_SIZE * pos + cubePos + bottomLeft;
     const glm::ivec3 maxPos = CHUNK_SIZE * pos + cubePos + topRight;
 
     const glm::vec3 normal = getNormalFromFace(face);
-    const int samplerID = textureManager.getBlockSamplerID(blockType, face);
+    const int samplerID = samplers[blockType][getFaceIndex(face)];
 
     const Vertex min{minPos, {0, 1}, normal, samplerID};
     const Vertex max{maxPos, {1, 0}, normal, samplerID};
@@ -2,11 +2,15 @@
 #define MYGE_CHUNK_H
 
 #include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
 #include "src/voxel/block/block.h"
 #include "glm/vec3.hpp"
 #include "glm/vec2.hpp"
 #include "src/utils/vec.h"
 #include "src/utils/cube-array.h"
+#include "block-storage.h"
 
 /**
  * A chunk groups up nearby blocks into cubes of `CHUNK_SIZE` width.
@@ -17,6 +21,14 @@ public:
     using ChunkID = unsigned int;
 
     static constexpr int CHUNK_SIZE = 16;
+    static constexpr int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+    static constexpr int PADDED_SIZE = CHUNK_SIZE + 2;
+
+    /*
+     * blocks of a chunk surrounded by a one block thick layer of blocks of its neighbours.
+     * coordinates are shifted by one, so that the chunk's own blocks start at [1, 1, 1].
+     */
+    using PaddedBlockArray = CubeArray<Block, PADDED_SIZE>;
 
 private:
     ChunkID id;
@@ -29,9 +41,15 @@ private:
     bool _isLoaded = false;
     bool _isDirty = true;
 
-    CubeArray<Block, CHUNK_SIZE> blocks;
+    // set once any block of this chunk is updated, meaning it differs from what it was when it was loaded
+    bool _isModified = false;
+
+    BlockStorage<CHUNK_SIZE> blocks;
     size_t activeBlockCount = 0;
 
+    // mask of faces (see `EBlockFace`) whose whole boundary layer of blocks is solid
+    std::uint8_t solidFaces = 0;
+
 public:
     explicit Chunk(const ChunkID i, const glm::ivec3 &p) : id(i), pos(p) {}
 
@@ -42,10 +60,35 @@ public:
     glm::ivec3 getPos() const { return pos; }
 
     [[nodiscard]]
-    EBlockType getBlock(const int x, const int y, const int z) const { return blocks[x][y][z].blockType; }
+    EBlockType getBlock(const int x, const int y, const int z) const { return blocks.get(x, y, z); }
 
     [[nodiscard]]
-    EBlockType getBlock(const glm::ivec3 &v) const { return blocks[v.x][v.y][v.z].blockType; }
+    EBlockType getBlock(const glm::ivec3 &v) const { return blocks.get(v.x, v.y, v.z); }
+
+    /**
+     * @return Number of bytes used to store the blocks of this chunk.
+     */
+    [[nodiscard]]
+    size_t getBlockMemoryUsage() const { return blocks.getMemoryUsage(); }
+
+    /**
+     * @return Whether all blocks of this chunk are of the same type.
+     */
+    [[nodiscard]]
+    bool isUniform() const { return blocks.isUniform(); }
+
+    /**
+     * @return Whether this chunk is filled with solid blocks only, meaning its mesh consists only of its boundary.
+     */
+    [[nodiscard]]
+    bool isSolid() const { return blocks.isUniform() && blocks.getUniformType() != BlockType_None; }
+
+    /**
+     * @return Whether all blocks lying on the given face of this chunk are solid, so that nothing behind it
+     *         can be seen through it.
+     */
+    [[nodiscard]]
+    bool isFaceSolid(const EBlockFace face) const { return solidFaces & face; }
 
     [[nodiscard]]
     bool isLoaded() const { return _isLoaded; }
@@ -58,6 +101,18 @@ public:
 
     void markDirty() { _isDirty = true; }
 
+    [[nodiscard]]
+    bool isModified() const { return _isModified; }
+
+    /**
+     * Marks this chunk as no longer needing a new mesh. This should be called once a copy of its blocks
+     * is taken to be meshed elsewhere.
+     */
+    void markClean() {
+        _isDirty = false;
+        isMesh = true;
+    }
+
     void updateBlock(const glm::ivec3 &block, EBlockType type);
 
     void updateBlock(int x, int y, int z, EBlockType type);
@@ -67,31 +122,82 @@ public:
      */
     void generate(class WorldGen &worldGen);
 
+    /**
+     * Encodes the blocks of this chunk into a compact form, suitable for storing it on disk.
+     */
+    void serialize(std::vector<std::uint8_t> &out) const;
+
+    /**
+     * Replaces the contents of this chunk with blocks encoded by `serialize`, which loads the chunk
+     * just like `generate` does. Nothing is changed if the data is malformed.
+     *
+     * @return Whether the data was valid.
+     */
+    bool deserialize(std::span<const std::uint8_t> data);
+
     /**
      * Unloads this chunk from memory, letting the ChunkManager free a ChunkSlot in which this chunk resides.
      */
     void unload();
 
+    /**
+     * Writes blocks of this chunk into the interior of a padded array.
+     */
+    void copyBlocks(PaddedBlockArray &neighbourhood) const;
+
+    /**
+     * Writes the layer of blocks lying on a given face of this chunk into the padding of a neighbouring chunk's
+     * padded array, i.e. the neighbour lying in the direction of `face`, on the neighbour's opposite side.
+     */
+    void copyBoundary(EBlockFace face, PaddedBlockArray &neighbourhood) const;
+
     /**
      * Creates a new mesh for this chunk and writes the data to the given mesh context.
      * This does nothing if there weren't any changes to this chunk since it was last loaded.
+     * All neighbouring blocks are assumed to be empty, so every face on the chunk's boundary is kept.
+     *
+     * @param meshContext Mesh context to which data should be written.
+     * @param samplers Table of samplers, so that we can deduce which texture each block uses.
+     */
+    void createMesh(class ChunkMeshContext& meshContext, const BlockSamplerTable &samplers);
+
+    /**
+     * Creates a new mesh for this chunk out of a copy of its blocks, culling faces on its boundary against
+     * the blocks of neighbouring chunks. This doesn't touch the chunk's blocks nor its state, so it can be
+     * done by a worker thread while the chunk is in use elsewhere.
      *
      * @param meshContext Mesh context to which data should be written.
-     * @param textureManager Reference to the texture manager, so that we can deduce which texture each block uses.
+     * @param samplers Table of samplers, so that we can deduce which texture each block uses.
+     * @param neighbourhood Blocks of this chunk and the neighbouring layer of blocks, see `copyBlocks`
+     *                      and `copyBoundary`.
      */
-    void createMesh(class ChunkMeshContext& meshContext, const class TextureManager &textureManager);
+    void createMesh(ChunkMeshContext& meshContext, const BlockSamplerTable &samplers,
+                    const PaddedBlockArray &neighbourhood) const;
+
+    /**
+     * Does the same as `createMesh`, but using the original mesher which creates a quad for every visible face
+     * and merges them afterwards. This is much slower and is only kept as a reference to validate
+     * the output of `createMesh` against.
+     */
+    void createReferenceMesh(ChunkMeshContext& meshContext, const BlockSamplerTable &samplers);
 
 private:
+    /**
+     * Recalculates which of this chunk's faces are solid.
+     */
+    void updateSolidFaces();
+
     /**
      * Adds a specific cube at coordinates [x, y, z] relative to the chunk's `pos` coordinates.
      */
-    void createCube(int x, int y, int z, ChunkMeshContext& meshContext, const TextureManager &textureManager);
+    void createCube(int x, int y, int z, const CubeArray<Block, CHUNK_SIZE> &blockArray,
+                    ChunkMeshContext& meshContext, const BlockSamplerTable &samplers);
 
     /**
      * Adds a specific cube's face to this mesh.
      */
     void createFace(const glm::ivec3 &cubePos, EBlockFace face, EBlockType blockType,
-                    ChunkMeshContext& meshContext, const TextureManager &textureManager) const;
+                    ChunkMeshContext& meshContext, const BlockSamplerTable &samplers) const;
 };
 
 #endif //MYGE_CHUNK_H
@@ -0,0 +1,239 @@
+#include "edit-journal.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "chunk.h"
+#include "src/utils/file.h"
+#include "src/utils/mapped-file.h"
+
+// the log starts with magic bytes, a format version and the sequence number from which its batches start,
+// followed by batches of edits. each batch is its payload's size and checksum followed by the payload itself,
+// which is the batch's sequence number and a list of chunks, each being its position and number of edits,
+// followed by the edits as pairs of a block index and a block type.
+// all integers are stored in the machine's native byte order
+static constexpr std::array<char, 4> JOURNAL_MAGIC = {'V', 'X', 'E', 'J'};
+static constexpr std::uint32_t JOURNAL_VERSION = 2;
+
+static constexpr size_t HEADER_SIZE = JOURNAL_MAGIC.size() + 2 * sizeof(std::uint32_t);
+static constexpr size_t BATCH_HEADER_SIZE = 2 * sizeof(std::uint32_t);
+
+template<typename T>
+static void put(std::vector<std::uint8_t> &out, const T value) {
+    const size_t offset = out.size();
+    out.resize(offset + sizeof(T));
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+/**
+ * Reads a value of a given type from the data at a given offset, advancing the offset past it.
+ *
+ * @return Whether there was enough data left to read the value.
+ */
+template<typename T>
+static bool get(const std::uint8_t *data, const size_t size, size_t &offset, T &value) {
+    if (size - offset < sizeof(T)) return false;
+
+    std::memcpy(&value, data + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+EditJournal::EditJournal(std::filesystem::path p, ChunkEditMap &edits,
+                         const SnapshotSequenceGetter &getSnapshotSequence) : path(std::move(p)) {
+    if (std::filesystem::exists(path)) {
+        replay(edits, getSnapshotSequence);
+    }
+
+    // a log whose header wasn't even written completely has nothing worth keeping
+    if (size < HEADER_SIZE) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        writeHeader(out, nextSequence);
+        size = HEADER_SIZE;
+    }
+
+    stream.open(path, std::ios::binary | std::ios::app);
+    if (!stream) {
+        throw std::runtime_error("failed to open edit journal " + path.string() + " in EditJournal::EditJournal()");
+    }
+}
+
+void EditJournal::append(const ChunkEditMap &edits, const bool shouldSync) {
+    if (edits.empty()) return;
+
+    size += writeBatch(stream, edits, nextSequence);
+    stream.flush();
+
+    if (!stream) {
+        throw std::runtime_error("failed to write edit journal " + path.string() + " in EditJournal::append()");
+    }
+
+    nextSequence++;
+
+    if (shouldSync) FileUtils::sync(path);
+}
+
+void EditJournal::rewrite(const ChunkEditMap &edits, const std::uint32_t sequence, const bool shouldSync) {
+    // the new log is written next to the old one and then renamed over it, so that a crash in the middle
+    // leaves either of them whole
+    std::filesystem::path newPath = path;
+    newPath += ".tmp";
+
+    size_t newSize = HEADER_SIZE;
+
+    {
+        std::ofstream out(newPath, std::ios::binary | std::ios::trunc);
+        // the header keeps the next sequence number, so that it isn't lost even if there are no edits left
+        writeHeader(out, nextSequence);
+        if (!edits.empty()) newSize += writeBatch(out, edits, sequence);
+        out.flush();
+
+        if (!out) {
+            throw std::runtime_error("failed to write edit journal " + newPath.string()
+                                     + " in EditJournal::rewrite()");
+        }
+    }
+
+    if (shouldSync) FileUtils::sync(newPath);
+
+    stream.close();
+    std::filesystem::rename(newPath, path);
+    stream.open(path, std::ios::binary | std::ios::app);
+    size = newSize;
+
+    if (!stream) {
+        throw std::runtime_error("failed to open edit journal " + path.string() + " in EditJournal::rewrite()");
+    }
+}
+
+std::uint16_t EditJournal::getBlockIndex(const glm::ivec3 &block) {
+    return static_cast<std::uint16_t>((block.x * Chunk::CHUNK_SIZE + block.y) * Chunk::CHUNK_SIZE + block.z);
+}
+
+glm::ivec3 EditJournal::getBlockPos(const std::uint16_t index) {
+    constexpr int size = Chunk::CHUNK_SIZE;
+    return {index / (size * size), index / size % size, index % size};
+}
+
+void EditJournal::replay(ChunkEditMap &edits, const SnapshotSequenceGetter &getSnapshotSequence) {
+    size_t validSize = 0;
+
+    {
+        const MappedFile file(path);
+        const std::uint8_t *data = file.data();
+        const size_t fileSize = file.size();
+
+        if (fileSize < HEADER_SIZE || std::memcmp(data, JOURNAL_MAGIC.data(), JOURNAL_MAGIC.size()) != 0) {
+            return;
+        }
+
+        std::uint32_t version;
+        std::memcpy(&version, data + JOURNAL_MAGIC.size(), sizeof(version));
+
+        if (version != JOURNAL_VERSION) {
+            throw std::runtime_error("unsupported version of edit journal " + path.string()
+                                     + " in EditJournal::replay()");
+        }
+
+        std::memcpy(&nextSequence, data + JOURNAL_MAGIC.size() + sizeof(version), sizeof(nextSequence));
+        validSize = HEADER_SIZE;
+
+        // sequence numbers of chunks' snapshots, looked up once per chunk
+        std::unordered_map<glm::ivec3, std::uint32_t, VecUtils::VecHash> snapshotSequences;
+
+        // the first batch which wasn't written completely ends the log
+        while (true) {
+            size_t offset = validSize;
+            std::uint32_t payloadSize, checksum;
+
+            if (!get(data, fileSize, offset, payloadSize) || !get(data, fileSize, offset, checksum)) break;
+            if (fileSize - offset < payloadSize) break;
+            if (FileUtils::crc32({data + offset, payloadSize}) != checksum) break;
+
+            const size_t payloadEnd = offset + payloadSize;
+
+            std::uint32_t sequence;
+            if (!get(data, payloadEnd, offset, sequence)) {
+                throw std::runtime_error("malformed batch in edit journal " + path.string()
+                                         + " in EditJournal::replay()");
+            }
+
+            while (offset < payloadEnd) {
+                glm::ivec3 chunkPos;
+                std::uint16_t count;
+
+                if (!get(data, payloadEnd, offset, chunkPos.x) || !get(data, payloadEnd, offset, chunkPos.y)
+                    || !get(data, payloadEnd, offset, chunkPos.z) || !get(data, payloadEnd, offset, count)) {
+                    throw std::runtime_error("malformed batch in edit journal " + path.string()
+                                             + " in EditJournal::replay()");
+                }
+
+                auto [it, isNew] = snapshotSequences.try_emplace(chunkPos, 0);
+                if (isNew) it->second = getSnapshotSequence(chunkPos);
+
+                // the chunk's snapshot already includes edits from batches before the one it recorded
+                const bool isSuperseded = sequence < it->second;
+                BlockEdits *chunkEdits = isSuperseded ? nullptr : &edits[chunkPos];
+
+                for (std::uint16_t i = 0; i < count; i++) {
+                    std::uint16_t index;
+                    std::uint8_t type;
+
+                    if (!get(data, payloadEnd, offset, index) || !get(data, payloadEnd, offset, type)
+                        || type >= BlockType_NumTypes) {
+                        throw std::runtime_error("malformed batch in edit journal " + path.string()
+                                                 + " in EditJournal::replay()");
+                    }
+
+                    if (chunkEdits) (*chunkEdits)[index] = static_cast<EBlockType>(type);
+                }
+            }
+
+            nextSequence = std::max(nextSequence, sequence + 1);
+            validSize = payloadEnd;
+        }
+
+        size = validSize;
+
+        if (validSize == fileSize) return;
+    }
+
+    // cut off the torn batch, so that new batches are appended right after the last intact one.
+    // this has to wait for the file to be unmapped, as mapped files can't be truncated on some platforms
+    std::filesystem::resize_file(path, validSize);
+}
+
+void EditJournal::writeHeader(std::ofstream &out, const std::uint32_t sequence) {
+    out.write(JOURNAL_MAGIC.data(), JOURNAL_MAGIC.size());
+    out.write(reinterpret_cast<const char *>(&JOURNAL_VERSION), sizeof(JOURNAL_VERSION));
+    out.write(reinterpret_cast<const char *>(&sequence), sizeof(sequence));
+}
+
+size_t EditJournal::writeBatch(std::ofstream &out, const ChunkEditMap &edits, const std::uint32_t sequence) {
+    std::vector<std::uint8_t> payload;
+    put(payload, sequence);
+
+    for (const auto &[chunkPos, chunkEdits]: edits) {
+        put(payload, chunkPos.x);
+        put(payload, chunkPos.y);
+        put(payload, chunkPos.z);
+        put(payload, static_cast<std::uint16_t>(chunkEdits.size()));
+
+        for (const auto &[index, type]: chunkEdits) {
+            put(payload, index);
+            put(payload, static_cast<std::uint8_t>(type));
+        }
+    }
+
+    const auto payloadSize = static_cast<std::uint32_t>(payload.size());
+    const std::uint32_t checksum = FileUtils::crc32(payload);
+
+    out.write(reinterpret_cast<const char *>(&payloadSize), sizeof(payloadSize));
+    out.write(reinterpret_cast<const char *>(&checksum), sizeof(checksum));
+    out.write(reinterpret_cast<const char *>(payload.data()), static_cast<std::streamsize>(payload.size()));
+
+    return BATCH_HEADER_SIZE + payload.size();
+}
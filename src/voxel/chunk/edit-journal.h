@@ -0,0 +1,119 @@
+#ifndef VOXEL_EDIT_JOURNAL_H
+#define VOXEL_EDIT_JOURNAL_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include "glm/vec3.hpp"
+#include "src/voxel/block/block.h"
+#include "src/utils/vec.h"
+
+/**
+ * Edits of blocks of a single chunk, mapping the blocks' indices (see `EditJournal::getBlockIndex`)
+ * to their new types. Repeated edits of the same block overwrite each other.
+ */
+using BlockEdits = std::map<std::uint16_t, EBlockType>;
+
+/**
+ * Block edits of a number of chunks, indexed by their chunk positions.
+ */
+using ChunkEditMap = std::unordered_map<glm::ivec3, BlockEdits, VecUtils::VecHash>;
+
+/**
+ * Append-only log of block edits, used to persist edits as they're made without saving whole chunks.
+ *
+ * Edits are appended in batches, each of which is prefixed by its size and checksum. A batch torn by a crash
+ * is detected when the log is opened and is dropped along with everything after it, so that it never affects
+ * edits of other batches. As the log only ever grows, it's compacted from time to time by rewriting it with
+ * the latest edit of each block, which replaces the old log atomically.
+ *
+ * Each batch has a sequence number, which only ever grows, even across compactions. A chunk's snapshot records
+ * the sequence number of the batch that was next when it was written (see `RegionFile::getJournalSequence`),
+ * as it includes all edits of the chunk from earlier batches. Those are skipped when the log is replayed.
+ *
+ * This class isn't thread-safe.
+ */
+class EditJournal {
+    std::filesystem::path path;
+    std::ofstream stream;
+
+    // size of the log in bytes
+    size_t size = 0;
+
+    // sequence number of the next appended batch
+    std::uint32_t nextSequence = 0;
+
+public:
+    /**
+     * Returns the sequence number recorded by the latest snapshot of the chunk at a given position,
+     * or 0 if the chunk has none.
+     */
+    using SnapshotSequenceGetter = std::function<std::uint32_t(const glm::ivec3 &chunkPos)>;
+
+    /**
+     * Opens the log at a given path, creating an empty one if it doesn't exist yet.
+     *
+     * @param edits Map to which the edits already stored in the log are added, apart from the ones which
+     *              are already included in their chunks' snapshots.
+     */
+    EditJournal(std::filesystem::path p, ChunkEditMap &edits, const SnapshotSequenceGetter &getSnapshotSequence);
+
+    [[nodiscard]]
+    size_t getSize() const { return size; }
+
+    [[nodiscard]]
+    std::uint32_t getNextSequence() const { return nextSequence; }
+
+    /**
+     * Appends a batch of edits to the log, with the next sequence number.
+     *
+     * @param shouldSync Whether to wait for the batch to reach the disk before returning.
+     */
+    void append(const ChunkEditMap &edits, bool shouldSync);
+
+    /**
+     * Replaces the whole log with one containing only the given edits.
+     *
+     * @param sequence Sequence number of the batch holding the edits. It must not be newer than the snapshots
+     *                 written after the edits were collected, so that the snapshots keep superseding them.
+     * @param shouldSync Whether to wait for the new log to reach the disk before it replaces the old one.
+     */
+    void rewrite(const ChunkEditMap &edits, std::uint32_t sequence, bool shouldSync);
+
+    /**
+     * @return Index of a block at given coordinates relative to its chunk.
+     */
+    [[nodiscard]]
+    static std::uint16_t getBlockIndex(const glm::ivec3 &block);
+
+    /**
+     * @return Coordinates of a block with a given index, relative to its chunk.
+     */
+    [[nodiscard]]
+    static glm::ivec3 getBlockPos(std::uint16_t index);
+
+private:
+    /**
+     * Reads all intact batches of the log, truncating it right after the last one.
+     */
+    void replay(ChunkEditMap &edits, const SnapshotSequenceGetter &getSnapshotSequence);
+
+    /**
+     * Writes the header of an empty log to a given stream.
+     *
+     * @param sequence Sequence number from which the log's batches start.
+     */
+    static void writeHeader(std::ofstream &out, std::uint32_t sequence);
+
+    /**
+     * Writes a batch of edits with a given sequence number to a given stream.
+     *
+     * @return Number of bytes written.
+     */
+    static size_t writeBatch(std::ofstream &out, const ChunkEditMap &edits, std::uint32_t sequence);
+};
+
+#endif //VOXEL_EDIT_JOURNAL_H
@@ -0,0 +1,245 @@
+#include "region-file.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+#include "src/utils/file.h"
+
+// header layout: magic bytes and format version, padded to the size of a table entry, followed by the offset table.
+// all integers are stored in the machine's native byte order
+static constexpr std::array<char, 4> REGION_MAGIC = {'V', 'X', 'R', 'G'};
+static constexpr std::uint32_t REGION_VERSION = 4;
+
+static constexpr size_t TABLE_ENTRY_SIZE = 4 * sizeof(std::uint32_t);
+
+// the table is aligned to its entries' size, so that no entry straddles a page boundary. otherwise, a crash while
+// writing an entry could persist only part of it, and the chunk's previous record would be lost along with it
+static constexpr size_t TABLE_OFFSET = TABLE_ENTRY_SIZE;
+static_assert(TABLE_OFFSET >= REGION_MAGIC.size() + sizeof(std::uint32_t));
+static_assert(4096 % TABLE_ENTRY_SIZE == 0);
+static constexpr size_t HEADER_SIZE = TABLE_OFFSET + RegionFile::REGION_VOLUME * TABLE_ENTRY_SIZE;
+
+RegionFile::RegionFile(std::filesystem::path p) : path(std::move(p)), table(REGION_VOLUME) {
+    const bool isNew = !std::filesystem::exists(path);
+
+    if (isNew) {
+        // fstream can't open a file for both reading and writing without it existing beforehand
+        std::ofstream(path, std::ios::binary);
+    }
+
+    stream.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!stream) {
+        throw std::runtime_error("failed to open region file " + path.string() + " in RegionFile::RegionFile()");
+    }
+
+    if (isNew) {
+        writeHeader();
+    }
+
+    mapping = MappedFile(path);
+    readHeader();
+}
+
+glm::ivec3 RegionFile::getRegionPos(const glm::ivec3 &chunkPos) {
+    // shifting a negative integer right rounds it down, which is exactly the division we want here
+    constexpr int shift = std::countr_zero(static_cast<unsigned>(REGION_SIZE));
+    return {chunkPos.x >> shift, chunkPos.y >> shift, chunkPos.z >> shift};
+}
+
+bool RegionFile::read(const glm::ivec3 &chunkPos, const std::function<bool(std::span<const std::uint8_t>)> &f) const {
+    std::shared_lock lock(mutex);
+
+    const TableEntry &entry = table[getTableIndex(chunkPos)];
+    if (entry.sector == 0) return false;
+
+    const size_t offset = static_cast<size_t>(entry.sector) * SECTOR_SIZE;
+    // an entry can point past the end of the file if a crash kept it but not its record, treat it like a corrupt one
+    if (offset + entry.size > mapping.size()) return false;
+
+    const std::span record(mapping.data() + offset, entry.size);
+    if (FileUtils::crc32(record) != entry.checksum) return false;
+
+    return f(record);
+}
+
+std::uint32_t RegionFile::getJournalSequence(const glm::ivec3 &chunkPos) const {
+    std::shared_lock lock(mutex);
+
+    const TableEntry &entry = table[getTableIndex(chunkPos)];
+    return entry.sector == 0 ? 0 : entry.journalSequence;
+}
+
+void RegionFile::write(const std::vector<Record> &records, const std::uint32_t journalSequence,
+                       const bool shouldSync) {
+    std::unique_lock lock(mutex);
+
+    static constexpr std::array<char, SECTOR_SIZE> padding{};
+
+    std::vector<std::pair<size_t, TableEntry>> newEntries;
+
+    for (const auto &[chunkPos, data]: records) {
+        // the sectors of the chunk's current record aren't free yet, so they can't be overwritten here
+        const std::uint32_t sectors = getSectorsFor(data.size());
+
+        const TableEntry entry{
+            .sector = allocateSectors(sectors),
+            .size = static_cast<std::uint32_t>(data.size()),
+            .checksum = FileUtils::crc32(data),
+            .journalSequence = journalSequence,
+        };
+
+        // records are padded to whole sectors, so that one appended after them starts right at the end of the file
+        stream.seekp(static_cast<std::streamoff>(entry.sector) * SECTOR_SIZE);
+        stream.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        stream.write(padding.data(), static_cast<std::streamsize>(sectors * SECTOR_SIZE - data.size()));
+
+        newEntries.emplace_back(getTableIndex(chunkPos), entry);
+    }
+
+    stream.flush();
+    if (shouldSync) FileUtils::sync(path);
+
+    // entries are written only once their records are in place, so a crash in between loses only the new records
+    for (const auto &[index, entry]: newEntries) {
+        stream.seekp(static_cast<std::streamoff>(TABLE_OFFSET + index * TABLE_ENTRY_SIZE));
+        stream.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+    }
+
+    stream.flush();
+    if (!stream) {
+        throw std::runtime_error("failed to write region file " + path.string() + " in RegionFile::write()");
+    }
+
+    if (shouldSync) FileUtils::sync(path);
+
+    // the previous records can only be overwritten once nothing points at them anymore
+    for (const auto &[index, entry]: newEntries) {
+        const TableEntry previous = table[index];
+        table[index] = entry;
+
+        if (previous.sector != 0) {
+            releaseSectors(previous.sector, getSectorsFor(previous.size));
+        }
+    }
+
+    // the file might have grown, which the old mapping doesn't cover
+    mapping = MappedFile(path);
+}
+
+size_t RegionFile::getTableIndex(const glm::ivec3 &chunkPos) {
+    constexpr int mask = REGION_SIZE - 1;
+    const auto x = static_cast<size_t>(chunkPos.x & mask);
+    const auto y = static_cast<size_t>(chunkPos.y & mask);
+    const auto z = static_cast<size_t>(chunkPos.z & mask);
+    return (x * REGION_SIZE + y) * REGION_SIZE + z;
+}
+
+std::uint32_t RegionFile::getSectorsFor(const size_t size) {
+    return static_cast<std::uint32_t>((size + SECTOR_SIZE - 1) / SECTOR_SIZE);
+}
+
+std::uint32_t RegionFile::allocateSectors(const std::uint32_t count) {
+    for (auto it = freeSectors.begin(); it != freeSectors.end(); ++it) {
+        const auto [first, length] = *it;
+        if (length < count) continue;
+
+        freeSectors.erase(it);
+        if (length > count) {
+            freeSectors.emplace(first + count, length - count);
+        }
+
+        return first;
+    }
+
+    const std::uint32_t first = sectorCount;
+    sectorCount += count;
+    return first;
+}
+
+void RegionFile::releaseSectors(std::uint32_t sector, std::uint32_t count) {
+    // merge with the runs right after and right before, if there are any
+    if (const auto next = freeSectors.find(sector + count); next != freeSectors.end()) {
+        count += next->second;
+        freeSectors.erase(next);
+    }
+
+    if (auto it = freeSectors.lower_bound(sector); it != freeSectors.begin()) {
+        --it;
+        if (it->first + it->second == sector) {
+            sector = it->first;
+            count += it->second;
+            freeSectors.erase(it);
+        }
+    }
+
+    freeSectors.emplace(sector, count);
+}
+
+void RegionFile::rebuildFreeSectors() {
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> takenSectors;
+
+    for (const TableEntry &entry: table) {
+        if (entry.sector != 0) {
+            takenSectors.emplace_back(entry.sector, getSectorsFor(entry.size));
+        }
+    }
+
+    std::ranges::sort(takenSectors);
+
+    freeSectors.clear();
+    std::uint32_t nextFree = getSectorsFor(HEADER_SIZE);
+
+    for (const auto &[sector, count]: takenSectors) {
+        if (sector > nextFree) {
+            freeSectors.emplace(nextFree, sector - nextFree);
+        }
+
+        nextFree = std::max(nextFree, sector + count);
+    }
+
+    if (sectorCount > nextFree) {
+        freeSectors.emplace(nextFree, sectorCount - nextFree);
+    }
+
+    // without syncing, a crash could leave an entry pointing past the end of the file. its sectors stay taken
+    sectorCount = std::max(sectorCount, nextFree);
+}
+
+void RegionFile::writeHeader() {
+    // the header is padded to whole sectors as well, with the table zeroed out
+    std::vector<char> header(getSectorsFor(HEADER_SIZE) * SECTOR_SIZE, 0);
+    std::memcpy(header.data(), REGION_MAGIC.data(), REGION_MAGIC.size());
+    std::memcpy(header.data() + REGION_MAGIC.size(), &REGION_VERSION, sizeof(REGION_VERSION));
+
+    stream.seekp(0);
+    stream.write(header.data(), static_cast<std::streamsize>(header.size()));
+    stream.flush();
+
+    if (!stream) {
+        throw std::runtime_error("failed to write header of region file " + path.string()
+                                 + " in RegionFile::writeHeader()");
+    }
+}
+
+void RegionFile::readHeader() {
+    const std::uint8_t *data = mapping.data();
+
+    std::uint32_t version = 0;
+    if (data && mapping.size() >= HEADER_SIZE) {
+        std::memcpy(&version, data + REGION_MAGIC.size(), sizeof(version));
+    }
+
+    if (!data || mapping.size() < HEADER_SIZE || std::memcmp(data, REGION_MAGIC.data(), REGION_MAGIC.size()) != 0
+        || version != REGION_VERSION) {
+        throw std::runtime_error("invalid header of region file " + path.string() + " in RegionFile::readHeader()");
+    }
+
+    static_assert(sizeof(TableEntry) == TABLE_ENTRY_SIZE);
+    std::memcpy(table.data(), data + TABLE_OFFSET, REGION_VOLUME * TABLE_ENTRY_SIZE);
+    sectorCount = getSectorsFor(mapping.size());
+    rebuildFreeSectors();
+}
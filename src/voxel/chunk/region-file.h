@@ -0,0 +1,139 @@
+#ifndef VOXEL_REGION_FILE_H
+#define VOXEL_REGION_FILE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <shared_mutex>
+#include <span>
+#include <utility>
+#include <vector>
+#include "glm/vec3.hpp"
+#include "src/utils/mapped-file.h"
+
+/**
+ * File storing encoded chunks (see `Chunk::serialize`) from a cube of `REGION_SIZE` chunks along each axis.
+ *
+ * The file starts with a header holding an offset table with an entry for each chunk position in the region,
+ * followed by the chunks' records, each starting at a `SECTOR_SIZE` boundary. Records are never overwritten
+ * in place: a chunk which is written again gets its new record written into free sectors, and only then its table
+ * entry is pointed at it. This way a write torn by a crash leaves the chunk's previous record intact, and
+ * a torn record itself is detected by its checksum. Once the table entry is written, the previous record's sectors
+ * are free to be reused by later writes, so that the file doesn't keep growing as chunks are saved again.
+ *
+ * Along with each record, its table entry keeps the edit journal's sequence number at the time the record was
+ * written, which tells which journaled edits of the chunk the record already includes (see `EditJournal`).
+ *
+ * Records are read straight from a memory mapping of the file, while writes go through a regular file stream,
+ * after which the mapping is recreated to cover the file's new size. All methods may be called concurrently
+ * from multiple threads.
+ */
+class RegionFile {
+public:
+    static constexpr int REGION_SIZE = 32;
+    static constexpr size_t REGION_VOLUME = REGION_SIZE * REGION_SIZE * REGION_SIZE;
+    static constexpr size_t SECTOR_SIZE = 256;
+
+    /**
+     * Encoded chunk to be written, along with its chunk position.
+     */
+    using Record = std::pair<glm::ivec3, std::span<const std::uint8_t>>;
+
+private:
+    struct TableEntry {
+        // sector at which the record starts. records never start within the header, so 0 means there's no record
+        std::uint32_t sector = 0;
+        std::uint32_t size = 0;
+        std::uint32_t checksum = 0;
+
+        // sequence number of the first edit journal batch whose edits aren't included in the record
+        std::uint32_t journalSequence = 0;
+    };
+
+    std::filesystem::path path;
+    std::fstream stream;
+    MappedFile mapping;
+
+    // copy of the file's offset table
+    std::vector<TableEntry> table;
+
+    // size of the file in sectors, i.e. the sector at which the next appended record starts
+    std::uint32_t sectorCount = 0;
+
+    // runs of sectors within the file which no table entry points at, mapping their first sector to their length.
+    // adjacent runs are always merged. it isn't stored, but rebuilt from the table when the file is opened
+    std::map<std::uint32_t, std::uint32_t> freeSectors;
+
+    // reads of records share the lock, while writes take it exclusively, as they may reuse sectors within
+    // the mapping and recreate it
+    mutable std::shared_mutex mutex;
+
+public:
+    /**
+     * Opens the region file at a given path, creating an empty one if it doesn't exist yet.
+     */
+    explicit RegionFile(std::filesystem::path p);
+
+    /**
+     * @return Position of the region to which the chunk at a given chunk position belongs.
+     */
+    [[nodiscard]]
+    static glm::ivec3 getRegionPos(const glm::ivec3 &chunkPos);
+
+    /**
+     * Calls `f` with the record of the chunk at a given chunk position, if this region holds one.
+     * The record points into the file's memory mapping and is valid only for the duration of the call.
+     *
+     * @return Result of `f`, or false if there's no valid record of the chunk.
+     */
+    bool read(const glm::ivec3 &chunkPos, const std::function<bool(std::span<const std::uint8_t>)> &f) const;
+
+    /**
+     * @return Edit journal sequence number recorded along with the record of the chunk at a given chunk position,
+     *         or 0 if this region holds no record of it.
+     */
+    [[nodiscard]]
+    std::uint32_t getJournalSequence(const glm::ivec3 &chunkPos) const;
+
+    /**
+     * Writes records of a number of chunks lying in this region, replacing any records they had before.
+     *
+     * @param journalSequence Sequence number of the first edit journal batch whose edits the records don't include.
+     * @param shouldSync Whether to wait for the records to reach the disk before their table entries are updated,
+     *                   and for the entries as well before returning.
+     */
+    void write(const std::vector<Record> &records, std::uint32_t journalSequence, bool shouldSync);
+
+private:
+    [[nodiscard]]
+    static size_t getTableIndex(const glm::ivec3 &chunkPos);
+
+    [[nodiscard]]
+    static std::uint32_t getSectorsFor(size_t size);
+
+    /**
+     * Finds a place for a record taking a given number of sectors, reusing the first run of free sectors
+     * that's long enough, or growing the file if there's none.
+     *
+     * @return First sector of the record.
+     */
+    std::uint32_t allocateSectors(std::uint32_t count);
+
+    /**
+     * Marks sectors of a record which no table entry points at anymore as free.
+     */
+    void releaseSectors(std::uint32_t sector, std::uint32_t count);
+
+    /**
+     * Finds all sectors past the header not taken by any record in the table.
+     */
+    void rebuildFreeSectors();
+
+    void writeHeader();
+
+    void readHeader();
+};
+
+#endif //VOXEL_REGION_FILE_H
@@ -0,0 +1,9 @@
+#include "noise-graph.h"
+
+// libnoise's table of gradients, which its library doesn't necessarily export. the header defines the table
+// instead of declaring it, so it's wrapped in a namespace of our own to avoid clashing with libnoise's copy
+namespace NoiseGraphTables {
+#include "libnoise/vectortable.h"
+}
+
+const double *const NoiseGraph::detail::GRADIENTS = NoiseGraphTables::noise::g_randomVectors;
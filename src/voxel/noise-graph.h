@@ -0,0 +1,512 @@
+#ifndef VOXEL_NOISE_GRAPH_H
+#define VOXEL_NOISE_GRAPH_H
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#include "libnoise/interp.h"
+#include "libnoise/noise.h"
+
+/**
+ * Noise modules composed at compile time.
+ *
+ * These are counterparts of libnoise's modules, following their algorithms operation by operation, so that a graph
+ * built out of them produces the same values as the equivalent graph of libnoise modules. Instead of holding
+ * pointers to their sources and calling their virtual `GetValue`, nodes hold their sources by value, and each
+ * source's type is a template parameter. A whole graph is therefore a single type, whose `getValue` the compiler
+ * can inline into one function, without any dispatch between the nodes.
+ *
+ * Graphs are best built with the factory functions below, e.g.:
+ *
+ *     const auto mountains = scaleBias(turbulence(RidgedMulti{.frequency = 0.5}, {.power = 0.1}), 0.5, 0.5);
+ */
+namespace NoiseGraph {
+    /**
+     * Anything that can be sampled at a point in 3-dimensional space.
+     */
+    template<typename T>
+    concept Node = requires(const T &node, double x, double y, double z) {
+        { node.getValue(x, y, z) } -> std::convertible_to<double>;
+    };
+
+    namespace detail {
+        // libnoise's table of 256 normalized gradients, each padded to 4 doubles
+        extern const double *const GRADIENTS;
+
+        // constants of libnoise's hash of lattice points
+        inline constexpr std::uint32_t X_NOISE_GEN = 1619;
+        inline constexpr std::uint32_t Y_NOISE_GEN = 31337;
+        inline constexpr std::uint32_t Z_NOISE_GEN = 6971;
+        inline constexpr std::uint32_t SEED_NOISE_GEN = 1013;
+        inline constexpr int SHIFT_NOISE_GEN = 8;
+
+        inline int lowerLatticeCoord(const double coord) {
+            // this is how libnoise does it, which isn't quite floor() for non-positive integers
+            return coord > 0.0 ? static_cast<int>(coord) : static_cast<int>(coord) - 1;
+        }
+
+        inline double sCurve(const double a, const noise::NoiseQuality quality) {
+            switch (quality) {
+                case noise::QUALITY_FAST:
+                    return a;
+                case noise::QUALITY_STD:
+                    return noise::SCurve3(a);
+                default:
+                    return noise::SCurve5(a);
+            }
+        }
+
+        inline double gradientNoise(const double fx, const double fy, const double fz, const int ix, const int iy,
+                                    const int iz, const int seed) {
+            // libnoise relies on signed overflow here, so the same wrapping arithmetic is done on unsigned integers
+            const std::uint32_t hash = X_NOISE_GEN * static_cast<std::uint32_t>(ix)
+                                       + Y_NOISE_GEN * static_cast<std::uint32_t>(iy)
+                                       + Z_NOISE_GEN * static_cast<std::uint32_t>(iz)
+                                       + SEED_NOISE_GEN * static_cast<std::uint32_t>(seed);
+
+            int vectorIndex = static_cast<int>(hash);
+            vectorIndex ^= vectorIndex >> SHIFT_NOISE_GEN;
+            vectorIndex &= 0xff;
+
+            const double *gradient = &GRADIENTS[vectorIndex << 2];
+
+            return (gradient[0] * (fx - static_cast<double>(ix))
+                    + gradient[1] * (fy - static_cast<double>(iy))
+                    + gradient[2] * (fz - static_cast<double>(iz))) * 2.12;
+        }
+
+        /**
+         * Counterpart of `noise::GradientCoherentNoise3D`.
+         */
+        inline double coherentNoise(const double x, const double y, const double z, const int seed,
+                                    const noise::NoiseQuality quality) {
+            const int x0 = lowerLatticeCoord(x);
+            const int y0 = lowerLatticeCoord(y);
+            const int z0 = lowerLatticeCoord(z);
+            const int x1 = x0 + 1;
+            const int y1 = y0 + 1;
+            const int z1 = z0 + 1;
+
+            const double xs = sCurve(x - static_cast<double>(x0), quality);
+            const double ys = sCurve(y - static_cast<double>(y0), quality);
+            const double zs = sCurve(z - static_cast<double>(z0), quality);
+
+            const auto interpX = [&](const int iy, const int iz) {
+                return noise::LinearInterp(gradientNoise(x, y, z, x0, iy, iz, seed),
+                                           gradientNoise(x, y, z, x1, iy, iz, seed), xs);
+            };
+
+            const double iy0 = noise::LinearInterp(interpX(y0, z0), interpX(y1, z0), ys);
+            const double iy1 = noise::LinearInterp(interpX(y0, z1), interpX(y1, z1), ys);
+
+            return noise::LinearInterp(iy0, iy1, zs);
+        }
+
+        /**
+         * Seed of a given octave of fractal noise, which libnoise computes with wrapping arithmetic.
+         */
+        inline int octaveSeed(const int seed, const int octave) {
+            return static_cast<int>(static_cast<std::uint32_t>(seed) + static_cast<std::uint32_t>(octave));
+        }
+    }
+
+    /**
+     * Counterpart of `noise::module::Const`.
+     */
+    struct Constant {
+        double value = 0.0;
+
+        [[nodiscard]]
+        double getValue(double, double, double) const { return value; }
+    };
+
+    /**
+     * Counterpart of `noise::module::Perlin`, with the same defaults.
+     */
+    struct Perlin {
+        double frequency = noise::module::DEFAULT_PERLIN_FREQUENCY;
+        double lacunarity = noise::module::DEFAULT_PERLIN_LACUNARITY;
+        double persistence = noise::module::DEFAULT_PERLIN_PERSISTENCE;
+        int octaveCount = noise::module::DEFAULT_PERLIN_OCTAVE_COUNT;
+        int seed = noise::module::DEFAULT_PERLIN_SEED;
+        noise::NoiseQuality quality = noise::module::DEFAULT_PERLIN_QUALITY;
+
+        [[nodiscard]]
+        double getValue(double x, double y, double z) const {
+            double value = 0.0;
+            double curPersistence = 1.0;
+
+            x *= frequency;
+            y *= frequency;
+            z *= frequency;
+
+            for (int octave = 0; octave < octaveCount; octave++) {
+                const double signal = detail::coherentNoise(noise::MakeInt32Range(x), noise::MakeInt32Range(y),
+                                                            noise::MakeInt32Range(z),
+                                                            detail::octaveSeed(seed, octave), quality);
+                value += signal * curPersistence;
+
+                x *= lacunarity;
+                y *= lacunarity;
+                z *= lacunarity;
+                curPersistence *= persistence;
+            }
+
+            return value;
+        }
+    };
+
+    /**
+     * Counterpart of `noise::module::Billow`, with the same defaults.
+     */
+    struct Billow {
+        double frequency = noise::module::DEFAULT_BILLOW_FREQUENCY;
+        double lacunarity = noise::module::DEFAULT_BILLOW_LACUNARITY;
+        double persistence = noise::module::DEFAULT_BILLOW_PERSISTENCE;
+        int octaveCount = noise::module::DEFAULT_BILLOW_OCTAVE_COUNT;
+        int seed = noise::module::DEFAULT_BILLOW_SEED;
+        noise::NoiseQuality quality = noise::module::DEFAULT_BILLOW_QUALITY;
+
+        [[nodiscard]]
+        double getValue(double x, double y, double z) const {
+            double value = 0.0;
+            double curPersistence = 1.0;
+
+            x *= frequency;
+            y *= frequency;
+            z *= frequency;
+
+            for (int octave = 0; octave < octaveCount; octave++) {
+                double signal = detail::coherentNoise(noise::MakeInt32Range(x), noise::MakeInt32Range(y),
+                                                      noise::MakeInt32Range(z),
+                                                      detail::octaveSeed(seed, octave), quality);
+                signal = 2.0 * std::fabs(signal) - 1.0;
+                value += signal * curPersistence;
+
+                x *= lacunarity;
+                y *= lacunarity;
+                z *= lacunarity;
+                curPersistence *= persistence;
+            }
+
+            return value + 0.5;
+        }
+    };
+
+    /**
+     * Counterpart of `noise::module::RidgedMulti`, with the same defaults.
+     */
+    struct RidgedMulti {
+        double frequency = noise::module::DEFAULT_RIDGED_FREQUENCY;
+        double lacunarity = noise::module::DEFAULT_RIDGED_LACUNARITY;
+        int octaveCount = noise::module::DEFAULT_RIDGED_OCTAVE_COUNT;
+        int seed = noise::module::DEFAULT_RIDGED_SEED;
+        noise::NoiseQuality quality = noise::module::DEFAULT_RIDGED_QUALITY;
+
+        [[nodiscard]]
+        double getValue(double x, double y, double z) const {
+            constexpr double offset = 1.0;
+            constexpr double gain = 2.0;
+
+            double value = 0.0;
+            double weight = 1.0;
+
+            // libnoise precomputes these spectral weights as `pow(lacunarity ^ octave, -1)`
+            double spectralFrequency = 1.0;
+
+            x *= frequency;
+            y *= frequency;
+            z *= frequency;
+
+            for (int octave = 0; octave < octaveCount; octave++) {
+                // unlike the other modules, this one keeps octave seeds non-negative
+                const int curSeed = detail::octaveSeed(seed, octave) & 0x7fffffff;
+
+                double signal = detail::coherentNoise(noise::MakeInt32Range(x), noise::MakeInt32Range(y),
+                                                      noise::MakeInt32Range(z), curSeed, quality);
+                signal = offset - std::fabs(signal);
+                signal *= signal;
+                signal *= weight;
+
+                weight = std::clamp(signal * gain, 0.0, 1.0);
+
+                value += signal * std::pow(spectralFrequency, -1.0);
+
+                x *= lacunarity;
+                y *= lacunarity;
+                z *= lacunarity;
+                spectralFrequency *= lacunarity;
+            }
+
+            return value * 1.25 - 1.0;
+        }
+    };
+
+    /**
+     * Counterpart of `noise::module::ScaleBias`.
+     */
+    template<Node Source>
+    struct ScaleBias {
+        Source source;
+        double scale = noise::module::DEFAULT_SCALE;
+        double bias = noise::module::DEFAULT_BIAS;
+
+        [[nodiscard]]
+        double getValue(const double x, const double y, const double z) const {
+            return source.getValue(x, y, z) * scale + bias;
+        }
+    };
+
+    /**
+     * Counterpart of `noise::module::ScalePoint`.
+     */
+    template<Node Source>
+    struct ScalePoint {
+        Source source;
+        double xScale = noise::module::DEFAULT_SCALE_POINT_X;
+        double yScale = noise::module::DEFAULT_SCALE_POINT_Y;
+        double zScale = noise::module::DEFAULT_SCALE_POINT_Z;
+
+        [[nodiscard]]
+        double getValue(const double x, const double y, const double z) const {
+            return source.getValue(x * xScale, y * yScale, z * zScale);
+        }
+    };
+
+    /**
+     * Counterpart of `noise::module::Clamp`.
+     */
+    template<Node Source>
+    struct Clamp {
+        Source source;
+        double lowerBound = noise::module::DEFAULT_CLAMP_LOWER_BOUND;
+        double upperBound = noise::module::DEFAULT_CLAMP_UPPER_BOUND;
+
+        [[nodiscard]]
+        double getValue(const double x, const double y, const double z) const {
+            return std::clamp(source.getValue(x, y, z), lowerBound, upperBound);
+        }
+    };
+
+    /**
+     * Counterparts of `noise::module::Add`, `Multiply`, `Min` and `Max`.
+     */
+    template<Node Source0, Node Source1>
+    struct Add {
+        Source0 source0;
+        Source1 source1;
+
+        [[nodiscard]]
+        double getValue(const double x, const double y, const double z) const {
+            return source0.getValue(x, y, z) + source1.getValue(x, y, z);
+        }
+    };
+
+    template<Node Source0, Node Source1>
+    struct Multiply {
+        Source0 source0;
+        Source1 source1;
+
+        [[nodiscard]]
+        double getValue(const double x, const double y, const double z) const {
+            return source0.getValue(x, y, z) * source1.getValue(x, y, z);
+        }
+    };
+
+    template<Node Source0, Node Source1>
+    struct Min {
+        Source0 source0;
+        Source1 source1;
+
+        [[nodiscard]]
+        double getValue(const double x, const double y, const double z) const {
+            return std::min(source0.getValue(x, y, z), source1.getValue(x, y, z));
+        }
+    };
+
+    template<Node Source0, Node Source1>
+    struct Max {
+        Source0 source0;
+        Source1 source1;
+
+        [[nodiscard]]
+        double getValue(const double x, const double y, const double z) const {
+            return std::max(source0.getValue(x, y, z), source1.getValue(x, y, z));
+        }
+    };
+
+    /**
+     * Settings of a `Select` node.
+     */
+    struct SelectParams {
+        double lowerBound = noise::module::DEFAULT_SELECT_LOWER_BOUND;
+        double upperBound = noise::module::DEFAULT_SELECT_UPPER_BOUND;
+        double edgeFalloff = noise::module::DEFAULT_SELECT_EDGE_FALLOFF;
+    };
+
+    /**
+     * Counterpart of `noise::module::Select`: outputs `inside` where the control value lies within the bounds and
+     * `outside` elsewhere, blending the two near the bounds if there's an edge falloff.
+     *
+     * Just like in libnoise, the falloff has to be at most half the distance between the bounds. Only the sources
+     * which contribute to the output at a given point are evaluated.
+     */
+    template<Node Control, Node Outside, Node Inside>
+    struct Select {
+        Control control;
+        Outside outside;
+        Inside inside;
+        SelectParams params;
+
+        [[nodiscard]]
+        double getValue(const double x, const double y, const double z) const {
+            const double controlValue = control.getValue(x, y, z);
+            const auto &[lowerBound, upperBound, edgeFalloff] = params;
+
+            if (edgeFalloff <= 0.0) {
+                return controlValue < lowerBound || controlValue > upperBound
+                           ? outside.getValue(x, y, z)
+                           : inside.getValue(x, y, z);
+            }
+
+            if (controlValue < lowerBound - edgeFalloff) {
+                return outside.getValue(x, y, z);
+            }
+
+            if (controlValue < lowerBound + edgeFalloff) {
+                const double lowerCurve = lowerBound - edgeFalloff;
+                const double upperCurve = lowerBound + edgeFalloff;
+                const double alpha = noise::SCurve3((controlValue - lowerCurve) / (upperCurve - lowerCurve));
+                return noise::LinearInterp(outside.getValue(x, y, z), inside.getValue(x, y, z), alpha);
+            }
+
+            if (controlValue < upperBound - edgeFalloff) {
+                return inside.getValue(x, y, z);
+            }
+
+            if (controlValue < upperBound + edgeFalloff) {
+                const double lowerCurve = upperBound - edgeFalloff;
+                const double upperCurve = upperBound + edgeFalloff;
+                const double alpha = noise::SCurve3((controlValue - lowerCurve) / (upperCurve - lowerCurve));
+                return noise::LinearInterp(inside.getValue(x, y, z), outside.getValue(x, y, z), alpha);
+            }
+
+            return outside.getValue(x, y, z);
+        }
+    };
+
+    /**
+     * Settings of a `Turbulence` node.
+     */
+    struct TurbulenceParams {
+        double frequency = noise::module::DEFAULT_TURBULENCE_FREQUENCY;
+        double power = noise::module::DEFAULT_TURBULENCE_POWER;
+        int roughness = noise::module::DEFAULT_TURBULENCE_ROUGHNESS;
+        int seed = noise::module::DEFAULT_TURBULENCE_SEED;
+    };
+
+    /**
+     * Counterpart of `noise::module::Turbulence`: randomly displaces the points at which its source is sampled.
+     */
+    template<Node Source>
+    struct Turbulence {
+        Source source;
+        Perlin xDistort;
+        Perlin yDistort;
+        Perlin zDistort;
+        double power;
+
+        Turbulence(Source s, const TurbulenceParams &params)
+            : source(std::move(s)),
+              xDistort(makeDistort(params, params.seed)),
+              yDistort(makeDistort(params, params.seed + 1)),
+              zDistort(makeDistort(params, params.seed + 2)),
+              power(params.power) {}
+
+        [[nodiscard]]
+        double getValue(const double x, const double y, const double z) const {
+            // offsets used by libnoise, so that the three distortions don't sample the same noise
+            const double xDisplaced = x + xDistort.getValue(x + 12414.0 / 65536.0, y + 65124.0 / 65536.0,
+                                                            z + 31337.0 / 65536.0) * power;
+            const double yDisplaced = y + yDistort.getValue(x + 26519.0 / 65536.0, y + 18128.0 / 65536.0,
+                                                            z + 60493.0 / 65536.0) * power;
+            const double zDisplaced = z + zDistort.getValue(x + 53820.0 / 65536.0, y + 11213.0 / 65536.0,
+                                                            z + 44845.0 / 65536.0) * power;
+
+            return source.getValue(xDisplaced, yDisplaced, zDisplaced);
+        }
+
+    private:
+        static Perlin makeDistort(const TurbulenceParams &params, const int seed) {
+            return Perlin{.frequency = params.frequency, .octaveCount = params.roughness, .seed = seed};
+        }
+    };
+
+    template<Node Source>
+    ScaleBias<Source> scaleBias(Source source, const double scale, const double bias) {
+        return {std::move(source), scale, bias};
+    }
+
+    template<Node Source>
+    ScalePoint<Source> scalePoint(Source source, const double xScale, const double yScale, const double zScale) {
+        return {std::move(source), xScale, yScale, zScale};
+    }
+
+    template<Node Source>
+    Clamp<Source> clamp(Source source, const double lowerBound, const double upperBound) {
+        return {std::move(source), lowerBound, upperBound};
+    }
+
+    template<Node Source0, Node Source1>
+    Add<Source0, Source1> add(Source0 source0, Source1 source1) {
+        return {std::move(source0), std::move(source1)};
+    }
+
+    template<Node Source0, Node Source1>
+    Multiply<Source0, Source1> multiply(Source0 source0, Source1 source1) {
+        return {std::move(source0), std::move(source1)};
+    }
+
+    template<Node Source0, Node Source1>
+    Min<Source0, Source1> min(Source0 source0, Source1 source1) {
+        return {std::move(source0), std::move(source1)};
+    }
+
+    template<Node Source0, Node Source1>
+    Max<Source0, Source1> max(Source0 source0, Source1 source1) {
+        return {std::move(source0), std::move(source1)};
+    }
+
+    template<Node Control, Node Outside, Node Inside>
+    Select<Control, Outside, Inside> select(Control control, Outside outside, Inside inside,
+                                            const SelectParams &params = {}) {
+        return {std::move(control), std::move(outside), std::move(inside), params};
+    }
+
+    template<Node Source>
+    Turbulence<Source> turbulence(Source source, const TurbulenceParams &params = {}) {
+        return {std::move(source), params};
+    }
+
+    /**
+     * Evaluates a graph at given points, writing the results to `out`. All spans need to be of the same size.
+     */
+    template<Node Graph>
+    void evaluate(const Graph &graph, const std::span<const double> xs, const std::span<const double> ys,
+                  const std::span<const double> zs, const std::span<double> out) {
+        if (xs.size() != out.size() || ys.size() != out.size() || zs.size() != out.size()) {
+            throw std::runtime_error("mismatched sizes of coordinate and output spans in NoiseGraph::evaluate");
+        }
+
+        for (size_t i = 0; i < out.size(); i++) {
+            out[i] = graph.getValue(xs[i], ys[i], zs[i]);
+        }
+    }
+}
+
+#endif //VOXEL_NOISE_GRAPH_H
@@ -1,23 +1,53 @@
 #include "world-gen.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+
 #include "src/voxel/chunk/chunk.h"
+#include "src/utils/profiler.h"
+
+// how many blocks of dirt lie between the grass on the surface and the stone below
+static constexpr int DIRT_HEIGHT = 5;
+
+// distance in noise coordinates between neighbouring chunks
+static constexpr double NOISE_STRETCH = 0.1;
+
+EChunkContents WorldGen::classifyChunk(const glm::ivec3 &chunkPos) {
+    const auto &[heights, minHeight, maxHeight] = *getColumn(chunkPos);
+
+    const int chunkBottomY = chunkPos.y * Chunk::CHUNK_SIZE;
+    const int chunkTopY = chunkBottomY + Chunk::CHUNK_SIZE - 1;
+
+    if (maxHeight < chunkBottomY) {
+        return ChunkContents_Empty;
+    }
+
+    // caves may carve out blocks anywhere between the surface and their bottom
+    if (chunkTopY + DIRT_HEIGHT < minHeight && (!generateCaves || chunkTopY < CAVE_MIN_Y)) {
+        return ChunkContents_Solid;
+    }
+
+    return ChunkContents_Mixed;
+}
 
 void WorldGen::fillChunk(const glm::ivec3 &chunkPos, CubeArray<Block, Chunk::CHUNK_SIZE> &blockArr) {
-    setChunkGenCtx(chunkPos);
+    VOXEL_PROFILE_SCOPE("WorldGen::fillChunk");
+
+    const std::shared_ptr<const HeightMapColumn> column = getColumn(chunkPos);
 
     const int chunkAbsY = chunkPos.y * Chunk::CHUNK_SIZE;
 
     for (int x = 0; x < Chunk::CHUNK_SIZE; x++) {
         for (int z = 0; z < Chunk::CHUNK_SIZE; z++) {
-            constexpr float stretch = 2.5f;
-            const float height = heightMap.GetValue(x, z) * Chunk::CHUNK_SIZE * stretch;
-            const int threshold = static_cast<int>(height);
+            const int threshold = column->heights[x][z];
 
             for (int y = 0; y < Chunk::CHUNK_SIZE; y++) {
-                constexpr int dirtHeight = 5;
                 const int absY = chunkAbsY + y;
 
-                if (absY + dirtHeight < threshold) {
-                    blockArr[x][y][z].blockType = BlockType_Stone;
+                if (absY + DIRT_HEIGHT < threshold) {
+                    blockArr[x][y][z].blockType = UNDERGROUND_BLOCK_TYPE;
 
                 } else if (absY < threshold) {
                     blockArr[x][y][z].blockType = BlockType_Dirt;
@@ -31,22 +61,174 @@ void WorldGen::fillChunk(const glm::ivec3 &chunkPos, CubeArray<Block, Chunk::CHU
             }
         }
     }
+
+    const int chunkTopY = chunkAbsY + Chunk::CHUNK_SIZE - 1;
+
+    if (generateCaves && chunkTopY >= CAVE_MIN_Y && chunkAbsY <= column->maxHeight) {
+        carveCaves(chunkPos, *column, blockArr);
+    }
+}
+
+void WorldGen::carveCaves(const glm::ivec3 &chunkPos, const HeightMapColumn &column,
+                          CubeArray<Block, Chunk::CHUNK_SIZE> &blockArr) {
+    constexpr int step = CAVE_LATTICE_STEP;
+    constexpr int latticeSize = Chunk::CHUNK_SIZE / step + 1;
+    constexpr int latticeVolume = latticeSize * latticeSize * latticeSize;
+    static_assert(Chunk::CHUNK_SIZE % step == 0);
+
+    const glm::ivec3 chunkAbsPos = chunkPos * Chunk::CHUNK_SIZE;
+
+    const auto latticeIndex = [](const int lx, const int ly, const int lz) {
+        return (lx * latticeSize + ly) * latticeSize + lz;
+    };
+
+    // a lattice point is only needed if any of the cells around it contains blocks between the surface
+    // and the bottom of the caves, as no other cells are ever interpolated. the cells around a column
+    // of lattice points span `step` blocks on either side of it, clipped to the chunk
+    std::array<double, latticeVolume> xs, ys, zs;
+    std::array<int, latticeVolume> neededPoints;
+    int neededCount = 0;
+
+    for (int lx = 0; lx < latticeSize; lx++) {
+        for (int lz = 0; lz < latticeSize; lz++) {
+            int maxSurface = std::numeric_limits<int>::min();
+
+            for (int x = std::max(0, (lx - 1) * step); x < std::min(Chunk::CHUNK_SIZE, (lx + 1) * step); x++) {
+                for (int z = std::max(0, (lz - 1) * step); z < std::min(Chunk::CHUNK_SIZE, (lz + 1) * step); z++) {
+                    maxSurface = std::max(maxSurface, column.heights[x][z]);
+                }
+            }
+
+            for (int ly = 0; ly < latticeSize; ly++) {
+                const int absY = chunkAbsPos.y + ly * step;
+                if (absY - step > maxSurface || absY + step - 1 < CAVE_MIN_Y) continue;
+
+                xs[neededCount] = NOISE_STRETCH * (chunkAbsPos.x + lx * step) / Chunk::CHUNK_SIZE;
+                ys[neededCount] = NOISE_STRETCH * absY / Chunk::CHUNK_SIZE;
+                zs[neededCount] = NOISE_STRETCH * (chunkAbsPos.z + lz * step) / Chunk::CHUNK_SIZE;
+                neededPoints[neededCount] = latticeIndex(lx, ly, lz);
+                neededCount++;
+            }
+        }
+    }
+
+    caveChunks.fetch_add(1, std::memory_order_relaxed);
+    caveLatticePoints.fetch_add(neededCount, std::memory_order_relaxed);
+
+    std::array<double, latticeVolume> neededDensities;
+    NoiseGraph::evaluate(caveNoise, std::span(xs).first(neededCount), std::span(ys).first(neededCount),
+                         std::span(zs).first(neededCount), std::span(neededDensities).first(neededCount));
+
+    // points which weren't needed are left at an arbitrary value, as they're never interpolated
+    std::array<double, latticeVolume> density{};
+
+    for (int i = 0; i < neededCount; i++) {
+        density[neededPoints[i]] = neededDensities[i];
+    }
+
+    for (int x = 0; x < Chunk::CHUNK_SIZE; x++) {
+        const int lx = x / step;
+        const double tx = static_cast<double>(x % step) / step;
+
+        for (int z = 0; z < Chunk::CHUNK_SIZE; z++) {
+            const int lz = z / step;
+            const double tz = static_cast<double>(z % step) / step;
+
+            const int minY = std::max(0, CAVE_MIN_Y - chunkAbsPos.y);
+            const int maxY = std::min(Chunk::CHUNK_SIZE - 1, column.heights[x][z] - chunkAbsPos.y);
+
+            for (int y = minY; y <= maxY; y++) {
+                const int ly = y / step;
+                const double ty = static_cast<double>(y % step) / step;
+
+                const auto interpY = [&](const int cx, const int cz) {
+                    return std::lerp(density[latticeIndex(cx, ly, cz)], density[latticeIndex(cx, ly + 1, cz)], ty);
+                };
+
+                const double value = std::lerp(std::lerp(interpY(lx, lz), interpY(lx + 1, lz), tx),
+                                               std::lerp(interpY(lx, lz + 1), interpY(lx + 1, lz + 1), tx),
+                                               tz);
+
+                if (value > CAVE_THRESHOLD) {
+                    blockArr[x][y][z].blockType = BlockType_None;
+                }
+            }
+        }
+    }
 }
 
-void WorldGen::setChunkGenCtx(const glm::ivec3 &chunkPos) {
-    heightMap = {};
+std::shared_ptr<const WorldGen::HeightMapColumn> WorldGen::getColumn(const glm::ivec3 &chunkPos) {
+    // the height map only depends on the chunk's column, so it's shared by all chunks stacked in the column,
+    // and by classifying a chunk and then filling it
+    const glm::ivec2 column = {chunkPos.x, chunkPos.z};
+
+    {
+        std::lock_guard lock(columnCacheMutex);
+
+        if (const auto *cached = columnCache.find(column)) {
+            columnCacheHits.fetch_add(1, std::memory_order_relaxed);
+            return *cached;
+        }
+    }
+
+    columnCacheMisses.fetch_add(1, std::memory_order_relaxed);
 
-    noiseutils::NoiseMapBuilderPlane heightMapBuilder;
+    // the noise is evaluated without holding the lock, so other threads can use the cache in the meantime
+    auto newColumn = std::make_shared<HeightMapColumn>();
+    buildColumn(column, *newColumn);
 
-    heightMapBuilder.SetSourceModule(noiseModule);
-    heightMapBuilder.SetDestNoiseMap(heightMap);
-    heightMapBuilder.SetDestSize(Chunk::CHUNK_SIZE, Chunk::CHUNK_SIZE);
-    constexpr double stretch = 0.1;
-    heightMapBuilder.SetBounds(
-        stretch * static_cast<double>(chunkPos.x),
-        stretch * static_cast<double>(chunkPos.x + 1),
-        stretch * static_cast<double>(chunkPos.z),
-        stretch * static_cast<double>(chunkPos.z + 1)
+    std::lock_guard lock(columnCacheMutex);
+
+    // another thread might've built the same column in the meantime. both are identical, so either is fine
+    if (const auto *cached = columnCache.find(column)) {
+        return *cached;
+    }
+
+    return columnCache.insert(column, std::move(newColumn));
+}
+
+void WorldGen::buildColumn(const glm::ivec2 &column, HeightMapColumn &out) const {
+    // laid out like `noiseutils::NoiseMap`, i.e. indexed by `[z * CHUNK_SIZE + x]`
+    std::array<float, Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE> heightMap;
+
+    constexpr double stretch = NOISE_STRETCH;
+    heightNoise.evaluatePlane(
+        stretch * static_cast<double>(column.x),
+        stretch * static_cast<double>(column.y),
+        stretch * static_cast<double>(column.x + 1),
+        stretch * static_cast<double>(column.y + 1),
+        Chunk::CHUNK_SIZE,
+        Chunk::CHUNK_SIZE,
+        heightMap
     );
-    heightMapBuilder.Build();
+
+    // the mountains are sampled at the same points, up to rounding of their coordinates. outside of mountain
+    // ranges they're exactly zero, leaving the base terrain as it was
+    std::array<double, Chunk::CHUNK_SIZE * Chunk::CHUNK_SIZE> xs, ys, zs, mountainMap;
+    ys.fill(0.0);
+
+    for (int z = 0; z < Chunk::CHUNK_SIZE; z++) {
+        for (int x = 0; x < Chunk::CHUNK_SIZE; x++) {
+            xs[z * Chunk::CHUNK_SIZE + x] = stretch * (column.x + static_cast<double>(x) / Chunk::CHUNK_SIZE);
+            zs[z * Chunk::CHUNK_SIZE + x] = stretch * (column.y + static_cast<double>(z) / Chunk::CHUNK_SIZE);
+        }
+    }
+
+    NoiseGraph::evaluate(mountainNoise, xs, ys, zs, mountainMap);
+
+    out.minHeight = std::numeric_limits<int>::max();
+    out.maxHeight = std::numeric_limits<int>::min();
+
+    for (int x = 0; x < Chunk::CHUNK_SIZE; x++) {
+        for (int z = 0; z < Chunk::CHUNK_SIZE; z++) {
+            constexpr float heightStretch = 2.5f;
+            const size_t i = z * Chunk::CHUNK_SIZE + x;
+            const float noiseHeight = heightMap[i] + static_cast<float>(mountainMap[i]);
+            const float height = noiseHeight * Chunk::CHUNK_SIZE * heightStretch;
+
+            out.heights[x][z] = static_cast<int>(height);
+            out.minHeight = std::min(out.minHeight, out.heights[x][z]);
+            out.maxHeight = std::max(out.maxHeight, out.heights[x][z]);
+        }
+    }
 }
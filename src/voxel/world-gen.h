@@ -1,20 +1,208 @@
 #ifndef VOXEL_WORLD_GEN_H
 #define VOXEL_WORLD_GEN_H
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "batch-perlin.h"
 #include "block/block.h"
 #include "chunk/chunk.h"
-#include "deps/noiseutils/noiseutils.h"
+#include "libnoise/noise.h"
+#include "noise-graph.h"
 #include "src/utils/cube-array.h"
+#include "src/utils/lru-cache.h"
+#include "src/utils/vec.h"
+
+/**
+ * Rough classification of a chunk's contents, made before any blocks are generated.
+ */
+enum EChunkContents {
+    ChunkContents_Empty, // the chunk consists only of air
+    ChunkContents_Solid, // the chunk consists only of `WorldGen::UNDERGROUND_BLOCK_TYPE` blocks
+    ChunkContents_Mixed,
+};
+
+/**
+ * Noise graphs describing the terrain, in the same units as the base height noise.
+ *
+ * Each noise is seeded differently, deriving its seed from the world's seed, so that they don't share their features.
+ */
+namespace TerrainNoise {
+    /**
+     * @return Seed of a single noise, mixed from the world's seed and a given offset using splitmix64.
+     *         libnoise seeds the octaves of a noise with consecutive seeds, so seeds merely offset from the world's
+     *         seed would make octaves of different noises coincide.
+     */
+    inline int deriveSeed(const int worldSeed, const int offset) {
+        std::uint64_t h = static_cast<std::uint64_t>(static_cast<std::uint32_t>(worldSeed)) << 32
+                          | static_cast<std::uint32_t>(offset);
+        h += 0x9e3779b97f4a7c15ULL;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        return static_cast<int>(static_cast<std::uint32_t>(h ^ (h >> 31)));
+    }
+
+    /**
+     * Height of mountains added on top of the base terrain. Mountain ranges rise wherever a low-frequency control
+     * noise is high enough, fading in towards their borders, and are flat ground elsewhere.
+     */
+    inline auto makeMountains(const int worldSeed) {
+        using namespace NoiseGraph;
+
+        const auto ridges = turbulence(
+            RidgedMulti{.frequency = 1.5, .octaveCount = 5, .seed = deriveSeed(worldSeed, 2)},
+            {.frequency = 2.0, .power = 0.1, .roughness = 2, .seed = deriveSeed(worldSeed, 3)}
+        );
+
+        return select(Perlin{.frequency = 0.2, .octaveCount = 3, .seed = deriveSeed(worldSeed, 1)},
+                      Constant{0.0},
+                      scaleBias(ridges, 0.75, 0.75),
+                      {.lowerBound = 0.3, .upperBound = 1000.0, .edgeFalloff = 0.2});
+    }
+
+    /**
+     * Density of caves, which are carved out underground wherever it exceeds `WorldGen::CAVE_THRESHOLD`.
+     * The noise is squashed vertically, so that caves are wider than they are tall.
+     */
+    inline auto makeCaves(const int worldSeed) {
+        using namespace NoiseGraph;
 
+        return scalePoint(Perlin{.frequency = 6.0, .octaveCount = 3, .seed = deriveSeed(worldSeed, 4)},
+                          1.0, 2.0, 1.0);
+    }
+}
+
+/**
+ * Generator of the world's terrain.
+ *
+ * The surface comes from a height map, below which caves are carved out of a 3-dimensional density field.
+ * The density is only evaluated on a coarse lattice and interpolated in between, and only around the parts of
+ * a chunk which lie between the surface and the bottom of the caves.
+ *
+ * Generation doesn't depend on anything but the world's seed and the generated chunk's position, so all methods
+ * may be called concurrently from multiple threads, always producing the same blocks for the same chunk.
+ * The only state shared between calls is the cache of height maps, which is guarded by a mutex held only
+ * for the duration of a lookup.
+ */
 class WorldGen {
-    const noise::module::Perlin noiseModule;
-    noiseutils::NoiseMap heightMap;
+public:
+    static constexpr EBlockType UNDERGROUND_BLOCK_TYPE = BlockType_Stone;
+
+    // lowest absolute y coordinate of blocks which may be carved out by caves
+    static constexpr int CAVE_MIN_Y = -6 * Chunk::CHUNK_SIZE;
+
+    // distance in blocks between points of the lattice on which the cave density is evaluated
+    static constexpr int CAVE_LATTICE_STEP = 4;
+
+    // density above which blocks are carved out
+    static constexpr double CAVE_THRESHOLD = 0.35;
+
+    /**
+     * Hit and miss counts of the column cache, i.e. how many times a column's height map could be reused
+     * and how many times it had to be built.
+     */
+    struct ColumnCacheStats {
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    /**
+     * Amount of work spent on caves, i.e. how many chunks had their cave density evaluated, and at how many
+     * lattice points in total.
+     */
+    struct CaveStats {
+        size_t chunks = 0;
+        size_t latticePoints = 0;
+    };
+
+private:
+    /**
+     * Surface heights of a single column of chunks, which are shared by all chunks stacked in the column.
+     */
+    struct HeightMapColumn {
+        // absolute surface heights, indexed by `[x][z]` relative to the column
+        std::array<std::array<int, Chunk::CHUNK_SIZE>, Chunk::CHUNK_SIZE> heights;
+
+        // range of the above heights, used to classify chunks without looking at every height
+        int minHeight;
+        int maxHeight;
+    };
+
+    const int seed;
+
+    // base height noise, evaluated a whole height map at a time
+    const BatchPerlin heightNoise;
+
+    const decltype(TerrainNoise::makeMountains(0)) mountainNoise;
+
+    const bool generateCaves;
+    const decltype(TerrainNoise::makeCaves(0)) caveNoise;
+
+    // height maps of recently generated columns, indexed by their x and z chunk coordinates.
+    // they're shared, so that a column can be evicted while other threads still use it
+    LruCache<glm::ivec2, std::shared_ptr<const HeightMapColumn>, VecUtils::VecHash> columnCache;
+    std::mutex columnCacheMutex;
+
+    std::atomic<size_t> columnCacheHits = 0;
+    std::atomic<size_t> columnCacheMisses = 0;
+
+    std::atomic<size_t> caveChunks = 0;
+    std::atomic<size_t> caveLatticePoints = 0;
 
 public:
+    /**
+     * @param worldSeed Seed of all noise the world is generated from. The same seed always yields the same world.
+     * @param caves Whether caves should be generated, or only the height map.
+     * @param columnCacheCapacity Number of columns whose height maps are kept around. This should be larger than
+     *                            the number of columns within render distance, so that a column stays cached
+     *                            while all of its chunks are generated.
+     */
+    explicit WorldGen(int worldSeed = 0, bool caves = true, size_t columnCacheCapacity = 4096)
+        : seed(worldSeed),
+          heightNoise(NoiseGraph::Perlin{.seed = worldSeed}),
+          mountainNoise(TerrainNoise::makeMountains(worldSeed)),
+          generateCaves(caves),
+          caveNoise(TerrainNoise::makeCaves(worldSeed)),
+          columnCache(columnCacheCapacity) {}
+
+    [[nodiscard]]
+    int getSeed() const { return seed; }
+
+    [[nodiscard]]
+    ColumnCacheStats getColumnCacheStats() const { return {columnCacheHits, columnCacheMisses}; }
+
+    [[nodiscard]]
+    CaveStats getCaveStats() const { return {caveChunks, caveLatticePoints}; }
+
+    /**
+     * Classifies a chunk using only the range of surface heights in its column,
+     * so that chunks entirely above the surface or below the caves don't need to be filled block by block.
+     */
+    [[nodiscard]]
+    EChunkContents classifyChunk(const glm::ivec3 &chunkPos);
+
     void fillChunk(const glm::ivec3& chunkPos, CubeArray<Block, Chunk::CHUNK_SIZE>& blockArr);
 
 private:
-    void setChunkGenCtx(const glm::ivec3 &chunkPos);
+    /**
+     * @return Height map of the column containing a given chunk, taken from the cache if possible.
+     */
+    [[nodiscard]]
+    std::shared_ptr<const HeightMapColumn> getColumn(const glm::ivec3 &chunkPos);
+
+    /**
+     * Builds the height map of a given column out of the base noise module and the mountain noise.
+     */
+    void buildColumn(const glm::ivec2 &column, HeightMapColumn &out) const;
+
+    /**
+     * Carves caves out of a chunk which has already been filled according to its column's height map.
+     */
+    void carveCaves(const glm::ivec3 &chunkPos, const HeightMapColumn &column,
+                    CubeArray<Block, Chunk::CHUNK_SIZE> &blockArr);
 };
 
 #endif //VOXEL_WORLD_GEN_H
@@ -0,0 +1,195 @@
+/*
+ * Tests of `ChunkStore` and its region files persisting chunks and block edits across reopening them, like across
+ * restarts of the game. Each test works in its own temporary directory, which is removed afterwards.
+ *
+ * Usage: voxel-test-chunk-store
+ */
+
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/voxel/chunk/chunk.h"
+#include "src/voxel/chunk/chunk-store.h"
+#include "src/voxel/chunk/region-file.h"
+
+static int failureCount = 0;
+
+static void check(const bool condition, const std::string &message) {
+    if (condition) return;
+
+    std::cerr << "FAILED: " << message << "\n";
+    failureCount++;
+}
+
+static std::filesystem::path makeTestDirectory(const std::string &name) {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "voxel-test-chunk-store" / name;
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+/**
+ * @return The chunk at a given position as the store has it, i.e. its snapshot with the journaled edits on top.
+ */
+static std::unique_ptr<Chunk> loadChunk(ChunkStore &store, const glm::ivec3 &chunkPos) {
+    auto chunk = std::make_unique<Chunk>(0, chunkPos);
+    store.load(*chunk);
+    store.replayEdits(*chunk);
+    return chunk;
+}
+
+/**
+ * A block is edited once and the edit gets journaled. Then it's edited again, and its chunk is saved before
+ * the second edit is journaled, so that only the snapshot holds it. The older journaled edit mustn't be
+ * replayed over the snapshot after the store is reopened.
+ */
+static void testSnapshotSupersedesJournaledEdits() {
+    const std::filesystem::path directory = makeTestDirectory("snapshot-supersedes-edits");
+    const glm::ivec3 chunkPos = {1, -2, 3};
+    const glm::ivec3 block = {4, 5, 6};
+
+    {
+        // destroying the store waits for the edit to be journaled
+        ChunkStore store(directory);
+        store.recordEdit(chunkPos, block, BlockType_Stone);
+    }
+
+    {
+        ChunkStore store(directory);
+        const std::unique_ptr<Chunk> chunk = loadChunk(store, chunkPos);
+        check(chunk->getBlock(block) == BlockType_Stone, "the first edit is replayed from the journal");
+
+        chunk->updateBlock(block, BlockType_None);
+        store.recordEdit(chunkPos, block, BlockType_None);
+        store.save(*chunk);
+    }
+
+    {
+        ChunkStore store(directory);
+        const std::unique_ptr<Chunk> chunk = loadChunk(store, chunkPos);
+        check(chunk->getBlock(block) == BlockType_None, "the snapshot supersedes the older journaled edit");
+    }
+
+    // edits made after the snapshot still have to be replayed on top of it
+    {
+        ChunkStore store(directory);
+        store.recordEdit(chunkPos, block, BlockType_Dirt);
+    }
+
+    {
+        ChunkStore store(directory);
+        const std::unique_ptr<Chunk> chunk = loadChunk(store, chunkPos);
+        check(chunk->getBlock(block) == BlockType_Dirt, "edits newer than the snapshot are replayed");
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+/**
+ * A chunk is written into a region file over and over, like an edited chunk saved on every unload.
+ * Sectors of its previous records have to be reused, also after the file is reopened, instead of the file
+ * growing with every write.
+ */
+static void testRegionReusesSectors() {
+    const std::filesystem::path directory = makeTestDirectory("region-reuses-sectors");
+    const std::filesystem::path path = directory / "region.vxr";
+    const glm::ivec3 chunkPos = {1, 2, 3};
+
+    Chunk chunk(0, chunkPos);
+    std::vector<std::uint8_t> data;
+
+    const auto writeVersion = [&](RegionFile &region, const int version) {
+        chunk.updateBlock({version % Chunk::CHUNK_SIZE, 0, 0}, version % 2 ? BlockType_Stone : BlockType_Dirt);
+        chunk.serialize(data);
+        region.write({{chunkPos, data}}, 0, false);
+    };
+
+    std::uintmax_t sizeAfterTwoWrites = 0;
+
+    {
+        RegionFile region(path);
+
+        for (int version = 0; version < 100; version++) {
+            writeVersion(region, version);
+            if (version == 1) sizeAfterTwoWrites = std::filesystem::file_size(path);
+        }
+    }
+
+    // the record only ever alternates between two places, as the current one can't be overwritten
+    check(std::filesystem::file_size(path) == sizeAfterTwoWrites, "rewritten records reuse free sectors");
+
+    {
+        RegionFile region(path);
+
+        for (int version = 100; version < 110; version++) {
+            writeVersion(region, version);
+        }
+
+        check(std::filesystem::file_size(path) == sizeAfterTwoWrites, "free sectors are found after reopening");
+
+        std::vector<std::uint8_t> readData;
+        region.read(chunkPos, [&](const std::span<const std::uint8_t> record) {
+            readData.assign(record.begin(), record.end());
+            return true;
+        });
+
+        check(readData == data, "the latest record is read back");
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+/**
+ * A crash can persist a table entry but not its record, leaving the entry pointing past the end of the file.
+ * Reading such a chunk must fail like reading a corrupt record does, instead of throwing.
+ */
+static void testRegionRecordPastEndOfFile() {
+    const std::filesystem::path directory = makeTestDirectory("region-record-past-end-of-file");
+    const std::filesystem::path path = directory / "region.vxr";
+    const glm::ivec3 chunkPos = {1, 2, 3};
+
+    std::uintmax_t sizeBeforeWrite = 0;
+
+    {
+        RegionFile region(path);
+        sizeBeforeWrite = std::filesystem::file_size(path);
+
+        Chunk chunk(0, chunkPos);
+        std::vector<std::uint8_t> data;
+        chunk.updateBlock({0, 0, 0}, BlockType_Stone);
+        chunk.serialize(data);
+        region.write({{chunkPos, data}}, 0, false);
+    }
+
+    std::filesystem::resize_file(path, sizeBeforeWrite);
+
+    RegionFile region(path);
+    bool wasCalled = false;
+    const bool wasRead = region.read(chunkPos, [&](std::span<const std::uint8_t>) {
+        wasCalled = true;
+        return true;
+    });
+
+    check(!wasRead && !wasCalled, "a record past the end of the file isn't read");
+
+    std::filesystem::remove_all(directory);
+}
+
+int main() {
+    testSnapshotSupersedesJournaledEdits();
+    testRegionReusesSectors();
+    testRegionRecordPastEndOfFile();
+
+    std::filesystem::remove_all(std::filesystem::temp_directory_path() / "voxel-test-chunk-store");
+
+    if (failureCount > 0) {
+        std::cerr << failureCount << " checks failed\n";
+        return 1;
+    }
+
+    std::cout << "all checks passed\n";
+    return 0;
+}